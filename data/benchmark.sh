@@ -0,0 +1,76 @@
+#!/bin/sh -e
+# Benchmark workflow script
+fail() {
+    echo "Error: $1"
+    exit 1
+}
+
+notExists() {
+	[ ! -f "$1" ]
+}
+
+#pre processing
+[ -z "$MMSEQS" ] && echo "Please set the environment variable \$MMSEQS to your MMSEQS binary." && exit 1;
+# check amount of input variables
+[ "$#" -ne 2 ] && echo "Please provide <outDir> <tmp>" && exit 1;
+[ ! -d "$1" ] && mkdir -p "$1";
+[ ! -d "$2" ] &&  echo "tmp directory $2 not found!" && mkdir -p "$2";
+
+OUT_PATH="$1"
+TMP_PATH="$2"
+REPORT="${OUT_PATH}/benchmark.tsv"
+
+printf "scale\tworkflow\tstage\twallTime\tuserTime\tsystemTime\tmaxRssKb\texitStatus\tinputMb\tinputMbPerSecond\n" > "${REPORT}"
+SUMMARY="${OUT_PATH}/benchmark_detection.tsv"
+printf "scale\tworkflow\tplanted\tdetected\n" > "${SUMMARY}"
+
+for SCALE in ${SCALES}; do
+    DATA_PATH="${TMP_PATH}/scale_${SCALE}"
+    if notExists "${DATA_PATH}/prots_contaminants.tsv"; then
+        # shellcheck disable=SC2086
+        "$MMSEQS" createsyntheticbenchmark "${DATA_PATH}" --genomes-per-kingdom $((GENOMES_PER_KINGDOM * SCALE)) ${GENERATE_PAR} \
+            || fail "createsyntheticbenchmark died"
+    fi
+
+    for WORKFLOW in dna protein; do
+        if [ "${WORKFLOW}" = "dna" ]; then
+            INPUT="dna"
+            RESULT_SUFFIX="_conterm_prediction"
+        else
+            INPUT="prots"
+            RESULT_SUFFIX="_all"
+        fi
+        STAGES="${DATA_PATH}/${WORKFLOW}_stages.tsv"
+        rm -rf "${DATA_PATH}/${WORKFLOW}_tmp" "${DATA_PATH}/${WORKFLOW}_result"*
+        rm -f "${STAGES}"
+        # the whole workflow is measured as the stage "total", each $RUNNER stage of it through --mpi-runner
+        # shellcheck disable=SC2086
+        "$MMSEQS" benchmarkstage "${STAGES}" "$MMSEQS" "${WORKFLOW}" "${DATA_PATH}/${INPUT}.fas" "${DATA_PATH}/${INPUT}.mapping" \
+            "${DATA_PATH}/${WORKFLOW}_result" "${DATA_PATH}/${WORKFLOW}_tmp" --ncbi-tax-dump "${DATA_PATH}/taxdump" \
+            --mpi-runner "$MMSEQS benchmarkstage ${STAGES}" ${THREADS_PAR} \
+            || fail "${WORKFLOW} workflow died"
+
+        INPUT_BYTES=$(wc -c < "${DATA_PATH}/${INPUT}.fas")
+        awk -v scale="${SCALE}" -v workflow="${WORKFLOW}" -v bytes="${INPUT_BYTES}" 'BEGIN { FS = OFS = "\t"; mb = bytes / 1048576 }
+            { stage = ($1 == workflow) ? "total" : $1;
+              print scale, workflow, stage, $2, $3, $4, $5, $6, sprintf("%.2f", mb), ($2 > 0) ? sprintf("%.2f", mb / $2) : "NA" }' \
+            "${STAGES}" >> "${REPORT}"
+        # a planted contaminant is detected if its entry shows up in the result, prefixid put the key in front
+        awk -v scale="${SCALE}" -v workflow="${WORKFLOW}" 'BEGIN { FS = OFS = "\t" }
+            FNR == NR { planted[$1] = 1; plantedCount++; next }
+            ($2 in planted) && !($2 in detected) { detected[$2] = 1; detectedCount++ }
+            END { print scale, workflow, plantedCount + 0, detectedCount + 0 }' \
+            "${DATA_PATH}/${INPUT}_contaminants.tsv" "${DATA_PATH}/${WORKFLOW}_result${RESULT_SUFFIX}" >> "${SUMMARY}"
+    done
+done
+
+cat "${REPORT}"
+cat "${SUMMARY}"
+
+if [ -n "$REMOVE_TMP" ]; then
+  echo "Remove temporary files"
+  for SCALE in ${SCALES}; do
+      rm -rf "${TMP_PATH}/scale_${SCALE}"
+  done
+  rm -f "${TMP_PATH}/benchmark.sh"
+fi
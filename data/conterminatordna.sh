@@ -13,9 +13,9 @@ notExists() {
 [ -z "$MMSEQS" ] && echo "Please set the environment variable \$MMSEQS to your MMSEQS binary." && exit 1;
 # check amount of input variables
 [ "$#" -ne 4 ] && echo "Please provide <sequence.fasta> <mappingFile> <result> <tmp>" && exit 1;
-# check if files exists
-[ ! -f "$1" ] &&  echo "$1 not found!" && exit 1;
-[ ! -f "$2" ] &&  echo "$2 not found!" && exit 1;
+# check if files exists, the inputs can also be pipes or stdin
+[ "$1" != "stdin" ] && [ ! -e "$1" ] &&  echo "$1 not found!" && exit 1;
+[ "$2" != "stdin" ] && [ ! -e "$2" ] &&  echo "$2 not found!" && exit 1;
 [   -f "$3" ] &&  echo "$3 exists already!" && exit 1;
 [ ! -d "$4" ] &&  echo "tmp directory $4 not found!" && mkdir -p "$4";
 
@@ -24,50 +24,98 @@ TMP_PATH="$4"
 
 if notExists "$TMP_PATH/sequencedb"; then
     # shellcheck disable=SC2086
-    "$MMSEQS" createdb "$1" "$TMP_PATH/sequencedb" ${CREATEDB} \
+    "$MMSEQS" createdb "$1" "$TMP_PATH/sequencedb" ${CREATEDB_PAR} \
         || fail "createdb step died"
 fi
 
+# multi-threaded join of the mapping file against the lookup, createtaxdb skips its awk join if the _mapping exists
 if notExists "$TMP_PATH/sequencedb_mapping"; then
+    # shellcheck disable=SC2086
+    "$MMSEQS" createtaxmapping "$TMP_PATH/sequencedb" "${TAXMAPPINGFILE}" ${CREATETAXMAPPING_PAR} \
+        || fail "createtaxmapping step died"
+fi
+
+# the binary taxonomy (_taxonomy) and the dense mapping are memory mapped by all later stages
+if notExists "$TMP_PATH/sequencedb_mapping" || [ ! -f "$TMP_PATH/sequencedb_taxonomy" ]; then
 if [ "$DOWNLOAD_NCBITAXDUMP" -eq "0" ]; then
     # shellcheck disable=SC2086
-    "$MMSEQS" createtaxdb "$TMP_PATH/sequencedb" "${TMP_PATH}/createtaxdb" --tax-mapping-file "${TAXMAPPINGFILE}" --ncbi-tax-dump "${NCBITAXINFO}" ${ONLYVERBOSITY} \
+    "$MMSEQS" createtaxdb "$TMP_PATH/sequencedb" "${TMP_PATH}/createtaxdb" --tax-mapping-file "${TAXMAPPINGFILE}" --ncbi-tax-dump "${NCBITAXINFO}" --tax-db-mode 1 ${ONLYVERBOSITY} \
         || fail "createtaxdb step died"
 else
     # shellcheck disable=SC2086
-    "$MMSEQS" createtaxdb "$TMP_PATH/sequencedb" "${TMP_PATH}/createtaxdb" --tax-mapping-file "${TAXMAPPINGFILE}" ${ONLYVERBOSITY} \
+    "$MMSEQS" createtaxdb "$TMP_PATH/sequencedb" "${TMP_PATH}/createtaxdb" --tax-mapping-file "${TAXMAPPINGFILE}" --tax-db-mode 1 ${ONLYVERBOSITY} \
         || fail "createtaxdb step died"
 fi
 fi
 
+# a rerun can rebuild the _mapping, the dense mapping is rebuilt with it
+if notExists "$TMP_PATH/sequencedb_mapping_dense" || [ "$TMP_PATH/sequencedb_mapping" -nt "$TMP_PATH/sequencedb_mapping_dense" ]; then
+    # shellcheck disable=SC2086
+    "$MMSEQS" createdensetaxmapping "$TMP_PATH/sequencedb" ${ONLYVERBOSITY} \
+        || fail "createdensetaxmapping step died"
+fi
+
+# the N-run index belongs to the sequencedb it was built from, packing rewrites sequencedb but not its headers
+if notExists "$TMP_PATH/sequencedb_nruns" || [ "$TMP_PATH/sequencedb_h.dbtype" -nt "$TMP_PATH/sequencedb_nruns" ]; then
+    # shellcheck disable=SC2086
+    "$MMSEQS" createnrunindex "$TMP_PATH/sequencedb" ${THREADS_PAR} \
+        || fail "createnrunindex step died"
+fi
+
 if notExists "$TMP_PATH/db_rev_split"; then
     # shellcheck disable=SC2086
     "$MMSEQS" splitsequence "$TMP_PATH/sequencedb" "$TMP_PATH/db_rev_split" ${SPLITSEQ_PAR} \
         || fail "splitsequence step died"
 fi
 
-if notExists "$TMP_PATH/pref.dbtype"; then
+# --pack-sequences: 2 bits per base, db_rev_split is packed first since it can link to the data of sequencedb
+if [ -n "$PACK_SEQUENCES" ] && notExists "$TMP_PATH/sequencedb_packed.done"; then
+    # shellcheck disable=SC2086
+    "$MMSEQS" packnucleotidedb "$TMP_PATH/db_rev_split" "$TMP_PATH/db_rev_split_packed" ${THREADS_PAR} \
+        || fail "packnucleotidedb step died"
+    # shellcheck disable=SC2086
+    "$MMSEQS" mvdb "$TMP_PATH/db_rev_split_packed" "$TMP_PATH/db_rev_split" ${ONLYVERBOSITY} \
+        || fail "mvdb step died"
     # shellcheck disable=SC2086
-    $RUNNER "$MMSEQS" kmermatcher "$TMP_PATH/db_rev_split" "$TMP_PATH/pref" ${KMERMATCHER_PAR} \
-        || fail "kmermatcher step died"
+    "$MMSEQS" packnucleotidedb "$TMP_PATH/sequencedb" "$TMP_PATH/sequencedb_packed" ${THREADS_PAR} \
+        || fail "packnucleotidedb step died"
+    # shellcheck disable=SC2086
+    "$MMSEQS" mvdb "$TMP_PATH/sequencedb_packed" "$TMP_PATH/sequencedb" ${ONLYVERBOSITY} \
+        || fail "mvdb step died"
+    touch "$TMP_PATH/sequencedb_packed.done"
 fi
 
-if notExists "$TMP_PATH/pref_cross.dbtype"; then
+# --update: only pairs with a new or changed sequence are searched, see createupdatemapping
+if [ -n "$UPDATE_TMP" ] && notExists "$TMP_PATH/update_mapping"; then
     # shellcheck disable=SC2086
-    $RUNNER "$MMSEQS" crosstaxonfilterorf "$TMP_PATH/sequencedb" "$TMP_PATH/db_rev_split_h" "$TMP_PATH/pref" "$TMP_PATH/pref_cross" ${CROSSTAXONFILTERORF_PAR} \
-        || fail "crosstaxonfilterorf step died"
+    "$MMSEQS" createupdatemapping "$UPDATE_TMP/sequencedb" "$TMP_PATH/sequencedb" "$TMP_PATH/update_mapping" ${THREADS_PAR} \
+        || fail "createupdatemapping step died"
 fi
 
-if notExists "$TMP_PATH/aln.dbtype"; then
+if notExists "$TMP_PATH/pref_cross.dbtype"; then
     # shellcheck disable=SC2086
-    $RUNNER "$MMSEQS" rescorediagonal "$TMP_PATH/db_rev_split" "$TMP_PATH/db_rev_split" "$TMP_PATH/pref_cross" "$TMP_PATH/aln" ${RESCORE_DIAGONAL1_PAR} \
-        || fail "rescorediagonal step died"
+    $RUNNER "$MMSEQS" crosstaxonkmermatcher "$TMP_PATH/sequencedb" "$TMP_PATH/db_rev_split" "$TMP_PATH/pref_cross" ${KMERMATCHER_PAR} \
+        || fail "crosstaxonkmermatcher step died"
+fi
+
+# windowrescorediagonal writes the alignments of the windows in contig coordinates
+if [ -n "$UPDATE_TMP" ]; then
+    if notExists "$TMP_PATH/aln_offset_update.dbtype"; then
+        # shellcheck disable=SC2086
+        $RUNNER "$MMSEQS" windowrescorediagonal "$TMP_PATH/sequencedb" "$TMP_PATH/db_rev_split" "$TMP_PATH/pref_cross" "$TMP_PATH/aln_offset_update" ${RESCORE_DIAGONAL1_PAR} \
+            || fail "windowrescorediagonal step died"
+    fi
+    if notExists "$TMP_PATH/aln_offset.dbtype"; then
+        # shellcheck disable=SC2086
+        "$MMSEQS" mergeupdatealignments "$UPDATE_TMP/aln_offset" "$TMP_PATH/aln_offset_update" "$TMP_PATH/update_mapping" "$TMP_PATH/aln_offset" ${THREADS_COMP_PAR} \
+            || fail "mergeupdatealignments step died"
+    fi
 fi
 
 if notExists "$TMP_PATH/aln_offset.dbtype"; then
     # shellcheck disable=SC2086
-    "$MMSEQS" offsetalignment "$TMP_PATH/sequencedb" "$TMP_PATH/db_rev_split" "$TMP_PATH/sequencedb" "$TMP_PATH/db_rev_split"  "$TMP_PATH/aln" "$TMP_PATH/aln_offset" ${OFFSETALIGNMENT_PAR} \
-        || fail "rescorediagonal step died"
+    $RUNNER "$MMSEQS" windowrescorediagonal "$TMP_PATH/sequencedb" "$TMP_PATH/db_rev_split" "$TMP_PATH/pref_cross" "$TMP_PATH/aln_offset" ${RESCORE_DIAGONAL1_PAR} \
+        || fail "windowrescorediagonal step died"
 fi
 
 if notExists "$TMP_PATH/contam_aln.dbtype"; then
@@ -78,7 +126,7 @@ fi
 
 if notExists "$TMP_PATH/contam_region.dbtype"; then
     # shellcheck disable=SC2086
-    $RUNNER "$MMSEQS" extractalignedregion "$TMP_PATH/sequencedb" "$TMP_PATH/sequencedb" "$TMP_PATH/contam_aln" "$TMP_PATH/contam_region" ${THREADS_PAR} \
+    "$MMSEQS" extractalignedregion "$TMP_PATH/sequencedb" "$TMP_PATH/sequencedb" "$TMP_PATH/contam_aln" "$TMP_PATH/contam_region" ${THREADS_PAR} \
         || fail "extractalignedregion step died"
 fi
 
@@ -92,23 +140,41 @@ if notExists "$TMP_PATH/contam_region_rev.dbtype"; then
         || fail "Extractframes died"
 fi
 
-#TODO
-if notExists "$TMP_PATH/contam_region_pref.dbtype"; then
-    # shellcheck disable=SC2086
-    $RUNNER "$MMSEQS" prefilter "$TMP_PATH/db_rev_split" "$TMP_PATH/contam_region_rev" "$TMP_PATH/contam_region_pref" ${PREFILTER_PAR} \
-        || fail "createdb step died"
-fi
-
-if notExists "$TMP_PATH/contam_region_aln.dbtype"; then
-    # shellcheck disable=SC2086
-    $RUNNER "$MMSEQS" rescorediagonal "$TMP_PATH/db_rev_split" "$TMP_PATH/contam_region_rev" "$TMP_PATH/contam_region_pref" "$TMP_PATH/contam_region_aln" ${RESCORE_DIAGONAL2_PAR} \
-        || fail "rescorediagonal2 step died"
-fi
+# --index-cache: the contaminated regions are searched against a cached index of db_rev_split,
+# otherwise db_rev_split is searched against an index of the contaminated regions built by the prefilter
+if [ -n "$INDEX_CACHE" ]; then
+    if notExists "$TMP_PATH/db_rev_split.idx.dbtype"; then
+        # shellcheck disable=SC2086
+        "$MMSEQS" cachedindexdb "$TMP_PATH/db_rev_split" "$INDEX_CACHE" "$TMP_PATH/db_rev_split.idx" ${INDEXDB_PAR} \
+            || fail "cachedindexdb step died"
+    fi
+
+    if notExists "$TMP_PATH/contam_region_pref.dbtype"; then
+        # shellcheck disable=SC2086
+        $RUNNER "$MMSEQS" prefilter "$TMP_PATH/contam_region_rev" "$TMP_PATH/db_rev_split.idx" "$TMP_PATH/contam_region_pref" ${PREFILTER_PAR} \
+            || fail "prefilter step died"
+    fi
+
+    # the alignments are already in the orientation of swapresults
+    if notExists "${TMP_PATH}/contam_region_aln_swap.dbtype"; then
+        # shellcheck disable=SC2086
+        $RUNNER "$MMSEQS" rescorediagonal "$TMP_PATH/contam_region_rev" "$TMP_PATH/db_rev_split" "$TMP_PATH/contam_region_pref" "$TMP_PATH/contam_region_aln_swap" ${RESCORE_DIAGONAL2_PAR} \
+            || fail "rescorediagonal2 step died"
+    fi
+else
+    #TODO
+    if notExists "$TMP_PATH/contam_region_pref.dbtype"; then
+        # shellcheck disable=SC2086
+        $RUNNER "$MMSEQS" prefilter "$TMP_PATH/db_rev_split" "$TMP_PATH/contam_region_rev" "$TMP_PATH/contam_region_pref" ${PREFILTER_PAR} \
+            || fail "createdb step died"
+    fi
 
-if notExists "${TMP_PATH}/contam_region_aln_swap.dbtype"; then
-     # shellcheck disable=SC2086
-    "$MMSEQS" swapresults "$TMP_PATH/db_rev_split" "$TMP_PATH/contam_region_rev" "${TMP_PATH}/contam_region_aln" "${TMP_PATH}/contam_region_aln_swap" ${SWAP_PAR} \
-        || fail "Swapresults pref died"
+    # rescorediagonal writes the alignments keyed by the regions, no swapresults pass
+    if notExists "${TMP_PATH}/contam_region_aln_swap.dbtype"; then
+        # shellcheck disable=SC2086
+        $RUNNER "$MMSEQS" rescorediagonal "$TMP_PATH/db_rev_split" "$TMP_PATH/contam_region_rev" "$TMP_PATH/contam_region_pref" "$TMP_PATH/contam_region_aln_swap" ${RESCORE_DIAGONAL2_SWAP_PAR} \
+            || fail "rescorediagonal2 step died"
+    fi
 fi
 
 if notExists "$TMP_PATH/contam_region_aln_swap_offset.dbtype"; then
@@ -125,22 +191,28 @@ fi
 
 if notExists "${3}_all"; then
     # shellcheck disable=SC2086
-    $RUNNER "$MMSEQS" prefixid "$TMP_PATH/contam_region_aln_swap_offset_all" "${3}_all" --threads 1 --tsv \
-        || fail "prefixid step 2 died"
+    "$MMSEQS" convertallreport "$TMP_PATH/sequencedb" "$TMP_PATH/contam_region_aln_swap_offset_all" "${3}_all" ${CREATESTATS_PAR} \
+        || fail "convertallreport step died"
 fi
 
 if notExists  "$TMP_PATH/contam_region_aln_swap_offset_predconterm.dbtype"; then
     # shellcheck disable=SC2086
-    $RUNNER "$MMSEQS" predictcontamination "$TMP_PATH/contam_region_aln_swap_offset_all" "$TMP_PATH/contam_region_aln_swap_offset_predconterm" ${CREATESTATS_PAR} \
+    $RUNNER "$MMSEQS" predictcontamination "$TMP_PATH/sequencedb" "$TMP_PATH/contam_region_aln_swap_offset_all" "$TMP_PATH/contam_region_aln_swap_offset_predconterm" ${CREATESTATS_PAR} \
         || fail "createtsv step died"
 fi
 
 if notExists "${3}_conterm_prediction"; then
     # shellcheck disable=SC2086
-    $RUNNER "$MMSEQS" prefixid "$TMP_PATH/contam_region_aln_swap_offset_predconterm" "${3}_conterm_prediction" --threads 1 --tsv \
+    "$MMSEQS" prefixid "$TMP_PATH/contam_region_aln_swap_offset_predconterm" "${3}_conterm_prediction" ${THREADS_PAR} --tsv \
         || fail "prefixid step 1  died"
 fi
 
+if [ -f "$MMSEQS_TELEMETRY" ]; then
+    # shellcheck disable=SC2086
+    "$MMSEQS" telemetryreport "$MMSEQS_TELEMETRY" "${3}_run_report.json" ${ONLYVERBOSITY} \
+        || fail "telemetryreport step died"
+fi
+
 if [ -n "$REMOVE_TMP" ]; then
   echo "Remove temporary files"
   $MMSEQS rmdb "$TMP_PATH/contam_region_aln_swap_offset_predconterm"
@@ -152,12 +224,19 @@ if [ -n "$REMOVE_TMP" ]; then
   $MMSEQS rmdb "$TMP_PATH/contam_region_rev"
   $MMSEQS rmdb "$TMP_PATH/contam_region"
   $MMSEQS rmdb "$TMP_PATH/db_rev_split"
+  if [ -n "$INDEX_CACHE" ]; then
+    $MMSEQS rmdb "$TMP_PATH/db_rev_split.idx"
+  fi
   $MMSEQS rmdb "$TMP_PATH/contam_aln"
   $MMSEQS rmdb "$TMP_PATH/aln_offset"
   $MMSEQS rmdb "$TMP_PATH/sequencedb"
   $MMSEQS rmdb "$TMP_PATH/sequencedb_h"
+  rm -f "$TMP_PATH/sequencedb_mapping" "$TMP_PATH/sequencedb_mapping_dense" "$TMP_PATH/sequencedb_nruns"
   $MMSEQS rmdb "$TMP_PATH/pref_cross"
-  $MMSEQS rmdb "$TMP_PATH/pref"
-  $MMSEQS rmdb "$TMP_PATH/aln"
+  if [ -n "$UPDATE_TMP" ]; then
+    $MMSEQS rmdb "$TMP_PATH/aln_offset_update"
+    rm -f "$TMP_PATH/update_mapping"
+  fi
+  rm -f "$TMP_PATH/sequencedb_packed.done"
 fi
 
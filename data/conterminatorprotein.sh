@@ -24,31 +24,53 @@ TMP_PATH="$4"
 
 if notExists "$TMP_PATH/sequencedb"; then
     # shellcheck disable=SC2086
-    "$MMSEQS" createdb "$1" "$TMP_PATH/sequencedb" ${CREATEDB} \
+    "$MMSEQS" createdb "$1" "$TMP_PATH/sequencedb" ${CREATEDB_PAR} \
         || fail "createdb step died"
 fi
 
+# multi-threaded join of the mapping file against the lookup, createtaxdb skips its awk join if the _mapping exists
 if notExists "$TMP_PATH/sequencedb_mapping"; then
+    # shellcheck disable=SC2086
+    "$MMSEQS" createtaxmapping "$TMP_PATH/sequencedb" "${TAXMAPPINGFILE}" ${THREADS_PAR} \
+        || fail "createtaxmapping step died"
+fi
+
+# the binary taxonomy (_taxonomy) and the dense mapping are memory mapped by all later stages
+if notExists "$TMP_PATH/sequencedb_mapping" || [ ! -f "$TMP_PATH/sequencedb_taxonomy" ]; then
 if [ "$DOWNLOAD_NCBITAXDUMP" -eq "0" ]; then
     # shellcheck disable=SC2086
-    "$MMSEQS" createtaxdb "$TMP_PATH/sequencedb" "${TMP_PATH}/createtaxdb" --tax-mapping-file "${TAXMAPPINGFILE}" --ncbi-tax-dump "${NCBITAXINFO}" ${ONLYVERBOSITY} \
+    "$MMSEQS" createtaxdb "$TMP_PATH/sequencedb" "${TMP_PATH}/createtaxdb" --tax-mapping-file "${TAXMAPPINGFILE}" --ncbi-tax-dump "${NCBITAXINFO}" --tax-db-mode 1 ${ONLYVERBOSITY} \
         || fail "createtaxdb step died"
 else
     # shellcheck disable=SC2086
-    "$MMSEQS" createtaxdb "$TMP_PATH/sequencedb" "${TMP_PATH}/createtaxdb" --tax-mapping-file "${TAXMAPPINGFILE}" ${ONLYVERBOSITY} \
+    "$MMSEQS" createtaxdb "$TMP_PATH/sequencedb" "${TMP_PATH}/createtaxdb" --tax-mapping-file "${TAXMAPPINGFILE}" --tax-db-mode 1 ${ONLYVERBOSITY} \
         || fail "createtaxdb step died"
 fi
 fi
 
+# a rerun can rebuild the _mapping, the dense mapping is rebuilt with it
+if notExists "$TMP_PATH/sequencedb_mapping_dense" || [ "$TMP_PATH/sequencedb_mapping" -nt "$TMP_PATH/sequencedb_mapping_dense" ]; then
+    # shellcheck disable=SC2086
+    "$MMSEQS" createdensetaxmapping "$TMP_PATH/sequencedb" ${ONLYVERBOSITY} \
+        || fail "createdensetaxmapping step died"
+fi
+
 if notExists "$TMP_PATH/clu.dbtype"; then
     # shellcheck disable=SC2086
     $RUNNER "$MMSEQS" linclust "$TMP_PATH/sequencedb" "$TMP_PATH/clu" "$TMP_PATH/linclust" ${LINCLUST_PAR} \
         || fail "kmermatcher step died"
 fi
 
+# only clusters with members of more than one kingdom can contain contamination, the others are not aligned
+if notExists "$TMP_PATH/clu_cross.dbtype"; then
+    # shellcheck disable=SC2086
+    $RUNNER "$MMSEQS" crosstaxonfilter "$TMP_PATH/sequencedb" "$TMP_PATH/clu" "$TMP_PATH/clu_cross" ${CROSSTAXA_PAR} \
+        || fail "crosstaxonfilter step died"
+fi
+
 if notExists "$TMP_PATH/aln.dbtype"; then
     # shellcheck disable=SC2086
-    $RUNNER "$MMSEQS" align "$TMP_PATH/sequencedb" "$TMP_PATH/sequencedb" "$TMP_PATH/clu" "$TMP_PATH/aln" ${ALN_PAR} \
+    $RUNNER "$MMSEQS" align "$TMP_PATH/sequencedb" "$TMP_PATH/sequencedb" "$TMP_PATH/clu_cross" "$TMP_PATH/aln" ${ALN_PAR} \
         || fail "kmermatcher step died"
 fi
 
@@ -66,7 +88,7 @@ fi
 
 if notExists "${2}_stats"; then
     # shellcheck disable=SC2086
-    $RUNNER "$MMSEQS" prefixid "$TMP_PATH/conterm_aln_stats" "${3}_stats" --threads 1 --tsv \
+    "$MMSEQS" prefixid "$TMP_PATH/conterm_aln_stats" "${3}_stats" ${THREADS_PAR} --tsv \
         || fail "prefixid step 1  died"
 fi
 
@@ -78,8 +100,14 @@ fi
 
 if notExists "${2}_all"; then
     # shellcheck disable=SC2086
-    $RUNNER "$MMSEQS" prefixid "$TMP_PATH/conterm_aln_all" "${3}_all" --threads 1 --tsv \
-        || fail "prefixid step 2 died"
+    "$MMSEQS" convertallreport "$TMP_PATH/sequencedb" "$TMP_PATH/conterm_aln_all" "${3}_all" ${CREATESTATS_PAR} \
+        || fail "convertallreport step died"
+fi
+
+if [ -f "$MMSEQS_TELEMETRY" ]; then
+    # shellcheck disable=SC2086
+    "$MMSEQS" telemetryreport "$MMSEQS_TELEMETRY" "${3}_run_report.json" ${ONLYVERBOSITY} \
+        || fail "telemetryreport step died"
 fi
 
 if [ -n "$REMOVE_TMP" ]; then
@@ -89,8 +117,10 @@ if [ -n "$REMOVE_TMP" ]; then
   $MMSEQS rmdb "$TMP_PATH/conterm_aln_stats"
   $MMSEQS rmdb "$TMP_PATH/sequencedb"
   $MMSEQS rmdb "$TMP_PATH/sequencedb_h"
+  rm -f "$TMP_PATH/sequencedb_mapping" "$TMP_PATH/sequencedb_mapping_dense"
   $MMSEQS rmdb "$TMP_PATH/conterm_aln"
   $MMSEQS rmdb "$TMP_PATH/aln"
+  $MMSEQS rmdb "$TMP_PATH/clu_cross"
   $MMSEQS rmdb "$TMP_PATH/clu"
 fi
 
@@ -4,6 +4,8 @@
 #include <sstream>
 #include <cstring>
 #include <vector>
+#include <climits>
+#include <stdint.h>
 
 #include "simd.h"
 #include "MathUtil.h"
@@ -54,6 +56,52 @@ public:
 
     };
 
+    // match/mismatch scoring of a nucleotide matrix (e.g. nucleotide.out)
+    // the ungapped alignment then works on mismatch bit masks instead of a matrix lookup per column
+    struct NucleotideScoring {
+        static const unsigned char NO_MATCH_CLASS = UCHAR_MAX;
+        int matchScore;
+        int mismatchScore;
+        // letters with the same class match, letters of NO_MATCH_CLASS (e.g. N) never match
+        unsigned char letterClass[256];
+    };
+
+    // returns false if the matrix scores more than one match and one mismatch value
+    static bool initNucleotideScoring(NucleotideScoring &scoring, const BaseMatrix &subMat) {
+        int matchScore = INT_MIN;
+        int mismatchScore = INT_MIN;
+        for (int i = 0; i < subMat.alphabetSize; i++) {
+            for (int j = 0; j < subMat.alphabetSize; j++) {
+                const int score = subMat.subMatrix[i][j];
+                int &expected = (i == j && score > 0) ? matchScore : mismatchScore;
+                if (expected == INT_MIN) {
+                    expected = score;
+                } else if (expected != score) {
+                    return false;
+                }
+            }
+        }
+        if (matchScore <= 0 || mismatchScore >= 0 || mismatchScore == INT_MIN) {
+            return false;
+        }
+        scoring.matchScore = matchScore;
+        scoring.mismatchScore = mismatchScore;
+        // the ASCII matrix used by rescorediagonal ends at 'z'
+        // aa2num has UCHAR_MAX entries, the last letter is never a base
+        scoring.letterClass[UCHAR_MAX] = NucleotideScoring::NO_MATCH_CLASS;
+        for (int letter = 0; letter < UCHAR_MAX; letter++) {
+            const int num = subMat.aa2num[letter];
+            const bool canMatch = letter <= 'z' && num < subMat.alphabetSize && subMat.subMatrix[num][num] == matchScore;
+            scoring.letterClass[letter] = canMatch ? static_cast<unsigned char>(num) : NucleotideScoring::NO_MATCH_CLASS;
+        }
+        // the SIMD path compares the upper case bases byte-wise
+        const unsigned char a = scoring.letterClass['A'], c = scoring.letterClass['C'];
+        const unsigned char g = scoring.letterClass['G'], t = scoring.letterClass['T'];
+        return a != NucleotideScoring::NO_MATCH_CLASS && c != NucleotideScoring::NO_MATCH_CLASS
+               && g != NucleotideScoring::NO_MATCH_CLASS && t != NucleotideScoring::NO_MATCH_CLASS
+               && a != c && a != g && a != t && c != g && c != t && g != t;
+    }
+
     template<typename T>
     static LocalAlignment computeUngappedWrappedAlignment(const T *querySeq, unsigned int querySeqLen,
                                                    const T *dbSeq, unsigned int dbSeqLen,
@@ -93,18 +141,19 @@ public:
     template<typename T>
     static LocalAlignment computeUngappedAlignment(const T *querySeq, unsigned int querySeqLen,
                                                    const T *dbSeq, unsigned int dbSeqLen,
-                                                   const unsigned short diagonal, const char **subMat, int alnMode){
+                                                   const unsigned short diagonal, const char **subMat, int alnMode,
+                                                   const NucleotideScoring *nuclScoring = NULL){
         LocalAlignment max;
         for(unsigned int devisions = 1; devisions <= 1 + dbSeqLen / 32768; devisions++) {
             int realDiagonal = (-devisions * 65536  + diagonal);
-            LocalAlignment tmp = ungappedAlignmentByDiagonal(querySeq, querySeqLen, dbSeq, dbSeqLen, realDiagonal, subMat, alnMode);
+            LocalAlignment tmp = ungappedAlignmentByDiagonal(querySeq, querySeqLen, dbSeq, dbSeqLen, realDiagonal, subMat, alnMode, nuclScoring);
             if(tmp.score > max.score){
                 max = tmp;
             }
         }
         for(unsigned int devisions = 0; devisions <= querySeqLen / 65536; devisions++) {
             int realDiagonal = (devisions * 65536 + diagonal);
-            LocalAlignment tmp = ungappedAlignmentByDiagonal(querySeq, querySeqLen, dbSeq, dbSeqLen, realDiagonal, subMat, alnMode);
+            LocalAlignment tmp = ungappedAlignmentByDiagonal(querySeq, querySeqLen, dbSeq, dbSeqLen, realDiagonal, subMat, alnMode, nuclScoring);
             if(tmp.score > max.score){
                 max = tmp;
             }
@@ -115,7 +164,8 @@ public:
     template<typename T>
     static LocalAlignment ungappedAlignmentByDiagonal(const T * querySeq, unsigned int querySeqLen,
                                                       const T * dbSeq,  unsigned int dbSeqLen,
-                                                      int diagonal, const char **subMat, int alnMode) {
+                                                      int diagonal, const char **subMat, int alnMode,
+                                                      const NucleotideScoring *nuclScoring = NULL) {
         unsigned int minDistToDiagonal = abs(diagonal);
         LocalAlignment res;
         res.distToDiagonal = minDistToDiagonal;
@@ -130,7 +180,9 @@ public:
                 res.score = DistanceCalculator::computeSubstitutionDistance(
                         querySeq + minDistToDiagonal, dbSeq, minSeqLen, subMat, false);
             } else if (alnMode == Parameters::RESCORE_MODE_ALIGNMENT) {
-                LocalAlignment tmp = computeSubstitutionStartEndDistance(querySeq + minDistToDiagonal, dbSeq, minSeqLen, subMat);
+                LocalAlignment tmp = (nuclScoring != NULL)
+                                     ? computeNucleotideStartEndDistance(querySeq + minDistToDiagonal, dbSeq, minSeqLen, *nuclScoring)
+                                     : computeSubstitutionStartEndDistance(querySeq + minDistToDiagonal, dbSeq, minSeqLen, subMat);
                 res.score = tmp.score;
                 res.startPos = tmp.startPos;
                 res.endPos = tmp.endPos;
@@ -155,7 +207,9 @@ public:
                 res.score = DistanceCalculator::computeSubstitutionDistance(
                         querySeq, dbSeq + minDistToDiagonal, minSeqLen, subMat, false);
             } else if (alnMode == Parameters::RESCORE_MODE_ALIGNMENT) {
-                LocalAlignment tmp = computeSubstitutionStartEndDistance(querySeq, dbSeq + minDistToDiagonal, minSeqLen, subMat);
+                LocalAlignment tmp = (nuclScoring != NULL)
+                                     ? computeNucleotideStartEndDistance(querySeq, dbSeq + minDistToDiagonal, minSeqLen, *nuclScoring)
+                                     : computeSubstitutionStartEndDistance(querySeq, dbSeq + minDistToDiagonal, minSeqLen, subMat);
                 res.score = tmp.score;
                 res.startPos = tmp.startPos;
                 res.endPos = tmp.endPos;
@@ -201,6 +255,102 @@ public:
     }
 
 
+    // mismatch bit mask of up to 64 columns, bit i is set if column i is a mismatch
+    template<typename T>
+    static uint64_t nucleotideMismatchMask(const T *seq1, const T *seq2, const unsigned int length,
+                                           const NucleotideScoring &scoring) {
+        const unsigned int vecBytes = VECSIZE_INT * 4;
+        uint64_t mismatches = 0;
+        unsigned int pos = 0;
+        if (length == 64) {
+            const simd_int a = simdi8_set('A');
+            const simd_int c = simdi8_set('C');
+            const simd_int g = simdi8_set('G');
+            const simd_int t = simdi8_set('T');
+            for (; pos < 64; pos += vecBytes) {
+                const simd_int seq1vec = simdi_loadu((const simd_int *) (seq1 + pos));
+                const simd_int seq2vec = simdi_loadu((const simd_int *) (seq2 + pos));
+                const simd_int seq1Base = simdi_or(simdi_or(simdi8_eq(seq1vec, a), simdi8_eq(seq1vec, c)),
+                                                   simdi_or(simdi8_eq(seq1vec, g), simdi8_eq(seq1vec, t)));
+                const simd_int seq2Base = simdi_or(simdi_or(simdi8_eq(seq2vec, a), simdi8_eq(seq2vec, c)),
+                                                   simdi_or(simdi8_eq(seq2vec, g), simdi8_eq(seq2vec, t)));
+                const uint64_t bothBase = static_cast<unsigned int>(simdi8_movemask(simdi_and(seq1Base, seq2Base)));
+                const uint64_t fullMask = (vecBytes == 64) ? UINT64_MAX : ((static_cast<uint64_t>(1) << vecBytes) - 1);
+                if (bothBase != fullMask) {
+                    // IUPAC codes, lower case letters or N, use the letter classes
+                    break;
+                }
+                const uint64_t equal = static_cast<unsigned int>(simdi8_movemask(simdi8_eq(seq1vec, seq2vec)));
+                mismatches |= ((~equal) & fullMask) << pos;
+            }
+        }
+        for (; pos < length; pos++) {
+            const unsigned char class1 = scoring.letterClass[static_cast<unsigned char>(seq1[pos])];
+            const unsigned char class2 = scoring.letterClass[static_cast<unsigned char>(seq2[pos])];
+            const bool isMatch = (class1 == class2 && class1 != NucleotideScoring::NO_MATCH_CLASS);
+            mismatches |= static_cast<uint64_t>(isMatch == false) << pos;
+        }
+        return mismatches;
+    }
+
+    // same result as computeSubstitutionStartEndDistance for a match/mismatch matrix, but the local alignment
+    // is extended over whole runs of matches between two mismatches instead of column by column
+    template<typename T>
+    static LocalAlignment computeNucleotideStartEndDistance(const T *seq1, const T *seq2, const unsigned int length,
+                                                            const NucleotideScoring &scoring) {
+        int maxScore = 0;
+        int maxEndPos = 0;
+        int maxStartPos = 0;
+        int minPos = -1;
+        int score = 0;
+        for (unsigned int blockStart = 0; blockStart < length; blockStart += 64) {
+            const unsigned int blockLen = std::min(length - blockStart, 64u);
+            uint64_t mismatches = nucleotideMismatchMask(seq1 + blockStart, seq2 + blockStart, blockLen, scoring);
+            unsigned int runStart = 0;
+            while (runStart < blockLen) {
+                const unsigned int mismatchPos = (mismatches != 0) ? __builtin_ctzll(mismatches) : blockLen;
+                if (mismatchPos > runStart) {
+                    score += static_cast<int>(mismatchPos - runStart) * scoring.matchScore;
+                    if (score > maxScore) {
+                        maxScore = score;
+                        maxEndPos = blockStart + mismatchPos - 1;
+                        maxStartPos = minPos + 1;
+                    }
+                }
+                if (mismatchPos < blockLen) {
+                    score += scoring.mismatchScore;
+                    if (score <= 0) {
+                        score = 0;
+                        minPos = blockStart + mismatchPos;
+                    }
+                    mismatches &= mismatches - 1;
+                }
+                runStart = mismatchPos + 1;
+            }
+        }
+        return LocalAlignment(maxStartPos, maxEndPos, maxScore);
+    }
+
+    // number of equal columns, ignoring the case of the letters
+    template<typename T>
+    static unsigned int countIdentities(const T *seq1, const T *seq2, unsigned int length) {
+        unsigned int identities = 0;
+        const unsigned int vecBytes = VECSIZE_INT * 4;
+        const unsigned int simdBlock = length / vecBytes;
+        const simd_int caseMask = simdi8_set(static_cast<char>(~0x20));
+        for (unsigned int block = 0; block < simdBlock; block++) {
+            const simd_int seq1vec = simdi_and(simdi_loadu((const simd_int *) (seq1 + block * vecBytes)), caseMask);
+            const simd_int seq2vec = simdi_and(simdi_loadu((const simd_int *) (seq2 + block * vecBytes)), caseMask);
+            identities += __builtin_popcount(static_cast<unsigned int>(simdi8_movemask(simdi8_eq(seq1vec, seq2vec))));
+        }
+        for (unsigned int pos = simdBlock * vecBytes; pos < length; pos++) {
+            const char letter1 = seq1[pos] & static_cast<unsigned char>(~0x20);
+            const char letter2 = seq2[pos] & static_cast<unsigned char>(~0x20);
+            identities += (letter1 == letter2) ? 1 : 0;
+        }
+        return identities;
+    }
+
     template<typename T>
     static LocalAlignment computeGlobalSubstitutionStartEndDistance(const T *seq1, const T *seq2,
                                                                     const unsigned int length,
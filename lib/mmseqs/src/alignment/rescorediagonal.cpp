@@ -1,3 +1,4 @@
+#include "rescorediagonal.h"
 #include "DistanceCalculator.h"
 #include "Util.h"
 #include "Parameters.h"
@@ -42,10 +43,241 @@ float parsePrecisionLib(const std::string &scoreFile, double targetSeqid, double
     return 0;
 }
 
+static bool compareSwappedHits(const std::pair<unsigned int, Matcher::result_t> &first,
+                               const std::pair<unsigned int, Matcher::result_t> &second) {
+    if (first.first != second.first) {
+        return first.first < second.first;
+    }
+    return Matcher::compareHits(first.second, second.second);
+}
+
+// state shared by all threads of a rescorediagonal run
+struct RescoreContext {
+    Parameters &par;
+    DBReader<unsigned int> *qdbr;
+    DBReader<unsigned int> *tdbr;
+    BaseMatrix *subMat;
+    const SubstitutionMatrix::FastMatrix &fastMatrix;
+    const DistanceCalculator::NucleotideScoring *nuclScoringPtr;
+    EvalueComputation &evaluer;
+    float scorePerColThr;
+    bool reversePrefilterResult;
+    bool sameQTDB;
+    bool swapOutput;
+    size_t targetFrom;
+    size_t targetSize;
+};
+
+// rescores the prefilter hits of the result entry id and appends the accepted hits to alnResults or shortResults
+static void rescoreEntry(const RescoreContext &context, DBReader<unsigned int> &resultReader, size_t id, unsigned int thread_idx,
+                         char *buffer, std::string &queryBuffer, char *&queryRevSeq, int &queryRevSeqLen,
+                         std::vector<Matcher::result_t> &alnResults, std::vector<hit_t> &shortResults) {
+    Parameters &par = context.par;
+    DBReader<unsigned int> *qdbr = context.qdbr;
+    DBReader<unsigned int> *tdbr = context.tdbr;
+    BaseMatrix *subMat = context.subMat;
+    const SubstitutionMatrix::FastMatrix &fastMatrix = context.fastMatrix;
+    const DistanceCalculator::NucleotideScoring *nuclScoringPtr = context.nuclScoringPtr;
+    EvalueComputation &evaluer = context.evaluer;
+    const float scorePerColThr = context.scorePerColThr;
+    const bool reversePrefilterResult = context.reversePrefilterResult;
+    const bool sameQTDB = context.sameQTDB;
+    const bool swapOutput = context.swapOutput;
+    const size_t targetFrom = context.targetFrom;
+    const size_t targetSize = context.targetSize;
+
+
+    char *data = resultReader.getData(id, thread_idx);
+    size_t queryKey = resultReader.getDbKey(id);
+
+    char *querySeq = NULL;
+    std::string queryToWrap; // needed only for wrapped end-start scoring
+    unsigned int queryId = UINT_MAX;
+    int queryLen = -1, origQueryLen = -1;
+    if(*data !=  '\0'){
+        queryId = qdbr->getId(queryKey);
+        querySeq = qdbr->getData(queryId, thread_idx);
+        queryLen = static_cast<int>(qdbr->getSeqLen(queryId));
+        origQueryLen = queryLen;
+
+        if (par.wrappedScoring){
+            queryToWrap = std::string(querySeq,queryLen);
+            queryToWrap = queryToWrap + queryToWrap;
+            querySeq = (char*)(queryToWrap).c_str();
+            queryLen = origQueryLen*2;
+        }
+
+        if(reversePrefilterResult == true && queryLen > queryRevSeqLen){
+            queryRevSeq = static_cast<char*>(realloc(queryRevSeq, queryLen+1));
+            queryRevSeqLen = queryLen+1;
+        }
+        if (reversePrefilterResult == true) {
+            NucleotideMatrix *nuclMatrix = (NucleotideMatrix *) subMat;
+            for (int pos = queryLen - 1; pos > -1; pos--) {
+                unsigned char res = subMat->aa2num[static_cast<int>(querySeq[pos])];
+                queryRevSeq[(queryLen - 1) - pos] = subMat->num2aa[nuclMatrix->reverseResidue(res)];
+            }
+        }
+        if (sameQTDB && qdbr->isCompressed()) {
+            queryBuffer.clear();
+            queryBuffer.append(querySeq, queryLen);
+            querySeq = (char *) queryBuffer.c_str();
+        }
+    }
+//    if(par.rescoreMode != Parameters::RESCORE_MODE_HAMMING){
+//        query.mapSequence(id, queryId, querySeq);
+//        queryLen = query.L;
+//    }else{
+    // -2 because of \n\0 in sequenceDB
+//    }
+
+    std::vector<hit_t> results = QueryMatcher::parsePrefilterHits(data);
+    for (size_t entryIdx = 0; entryIdx < results.size(); entryIdx++) {
+        char *querySeqToAlign = querySeq;
+        bool isReverse = false;
+        if (reversePrefilterResult) {
+            if (results[entryIdx].prefScore < 0) {
+                querySeqToAlign = queryRevSeq;
+                isReverse=true;
+            }
+        }
+
+        unsigned int targetId = tdbr->getId(results[entryIdx].seqId);
+        if (swapOutput && (targetId < targetFrom || targetId >= targetFrom + targetSize)) {
+            continue;
+        }
+        const bool isIdentity = (queryId == targetId && (par.includeIdentity || sameQTDB)) ? true : false;
+        char *targetSeq = tdbr->getData(targetId, thread_idx);
+        int dbLen = static_cast<int>(tdbr->getSeqLen(targetId));
+
+        float queryLength = static_cast<float>(origQueryLen);
+        float targetLength = static_cast<float>(dbLen);
+        if (Util::canBeCovered(par.covThr, par.covMode, queryLength, targetLength) == false) {
+            continue;
+        }
+        DistanceCalculator::LocalAlignment alignment;
+        if (par.wrappedScoring) {
+            if (dbLen > origQueryLen) {
+                Debug(Debug::WARNING) << "WARNING: target sequence " << targetId
+                                      << " is skipped, no valid wrapped scoring possible\n";
+                continue;
+            }
+
+            alignment = DistanceCalculator::computeUngappedWrappedAlignment(
+                    querySeqToAlign, queryLen, targetSeq, targetLength,
+                    results[entryIdx].diagonal, fastMatrix.matrix, par.rescoreMode);
+        }
+        else {
+            alignment = DistanceCalculator::computeUngappedAlignment(
+                    querySeqToAlign, queryLen, targetSeq, targetLength,
+                    results[entryIdx].diagonal, fastMatrix.matrix, par.rescoreMode, nuclScoringPtr);
+        }
+        unsigned int distanceToDiagonal = alignment.distToDiagonal;
+        int diagonalLen = alignment.diagonalLen;
+        int distance = alignment.score;
+        int diagonal = alignment.diagonal;
+        double seqId = 0;
+        double evalue = 0.0;
+        int bitScore = 0;
+        int alnLen = 0;
+        float targetCov = static_cast<float>(diagonalLen) / static_cast<float>(dbLen);
+        float queryCov = static_cast<float>(diagonalLen) / static_cast<float>(origQueryLen);
+
+        Matcher::result_t result;
+        if (par.rescoreMode == Parameters::RESCORE_MODE_HAMMING) {
+            int idCnt = (static_cast<float>(distance));
+            seqId = Util::computeSeqId(par.seqIdMode, idCnt, origQueryLen, dbLen, diagonalLen);
+            alnLen = diagonalLen;
+        } else if (par.rescoreMode == Parameters::RESCORE_MODE_SUBSTITUTION ||
+                   par.rescoreMode == Parameters::RESCORE_MODE_ALIGNMENT ||
+                   par.rescoreMode == Parameters::RESCORE_MODE_END_TO_END_ALIGNMENT ||
+                   par.rescoreMode == Parameters::RESCORE_MODE_WINDOW_QUALITY_ALIGNMENT) {
+            evalue = evaluer.computeEvalue(distance, origQueryLen);
+            bitScore = static_cast<int>(evaluer.computeBitScore(distance) + 0.5);
+
+            if (par.rescoreMode == Parameters::RESCORE_MODE_ALIGNMENT ||
+                par.rescoreMode == Parameters::RESCORE_MODE_END_TO_END_ALIGNMENT ||
+                par.rescoreMode == Parameters::RESCORE_MODE_WINDOW_QUALITY_ALIGNMENT) {
+                alnLen = (alignment.endPos - alignment.startPos) + 1;
+                int qStartPos, qEndPos, dbStartPos, dbEndPos;
+                // -1 since diagonal is computed from sequence Len which starts by 1
+                if (diagonal >= 0) {
+                    qStartPos = alignment.startPos + distanceToDiagonal;
+                    qEndPos = alignment.endPos + distanceToDiagonal;
+                    dbStartPos = alignment.startPos;
+                    dbEndPos = alignment.endPos;
+                } else {
+                    qStartPos = alignment.startPos;
+                    qEndPos = alignment.endPos;
+                    dbStartPos = alignment.startPos + distanceToDiagonal;
+                    dbEndPos = alignment.endPos + distanceToDiagonal;
+                }
+//                    int qAlnLen = std::max(qEndPos - qStartPos, static_cast<int>(1));
+//                    int dbAlnLen = std::max(dbEndPos - dbStartPos, static_cast<int>(1));
+//                    seqId = (alignment.score1 / static_cast<float>(std::max(qAlnLength, dbAlnLength)))  * 0.1656 + 0.1141;
+
+                // compute seq.id if hit fulfills e-value but not by seqId criteria
+                if (evalue <= par.evalThr || isIdentity) {
+                    int idCnt = DistanceCalculator::countIdentities(querySeqToAlign + qStartPos, targetSeq + dbStartPos,
+                                                                    qEndPos - qStartPos + 1);
+                    seqId = Util::computeSeqId(par.seqIdMode, idCnt, origQueryLen, dbLen, alnLen);
+                }
+                char *end = Itoa::i32toa_sse2(alnLen, buffer);
+                size_t len = end - buffer;
+                std::string backtrace = "";
+                if (par.addBacktrace) {
+                    backtrace=std::string(buffer, len - 1);
+                    backtrace.push_back('M');
+                }
+                queryCov = SmithWaterman::computeCov(qStartPos, qEndPos, origQueryLen);
+                targetCov = SmithWaterman::computeCov(dbStartPos, dbEndPos, dbLen);
+                if (isReverse) {
+                    qStartPos = queryLen - qStartPos - 1;
+                    qEndPos = queryLen - qEndPos - 1;
+                }
+                result = Matcher::result_t(results[entryIdx].seqId, bitScore, queryCov, targetCov, seqId, evalue, alnLen,
+                                           qStartPos, qEndPos, origQueryLen, dbStartPos, dbEndPos, dbLen, backtrace);
+            }
+        }
+
+        //float maxSeqLen = std::max(static_cast<float>(targetLen), static_cast<float>(queryLen));
+        float currScorePerCol = static_cast<float>(distance) / static_cast<float>(diagonalLen);
+        // query/target cov mode
+        bool hasCov = Util::hasCoverage(par.covThr, par.covMode, queryCov, targetCov);
+        // --min-seq-id
+        bool hasSeqId = seqId >= (par.seqIdThr - std::numeric_limits<float>::epsilon());
+        bool hasEvalue = (evalue <= par.evalThr);
+        bool hasAlnLen = (alnLen >= par.alnLenThr);
+
+        // --filter-hits
+        bool hasToFilter = (par.filterHits == true && currScorePerCol >= scorePerColThr);
+        if (isIdentity || hasToFilter || (hasAlnLen && hasCov && hasSeqId && hasEvalue)) {
+            if (par.rescoreMode == Parameters::RESCORE_MODE_ALIGNMENT ||
+                par.rescoreMode == Parameters::RESCORE_MODE_END_TO_END_ALIGNMENT ||
+                par.rescoreMode == Parameters::RESCORE_MODE_WINDOW_QUALITY_ALIGNMENT) {
+                alnResults.emplace_back(result);
+            } else if (par.rescoreMode == Parameters::RESCORE_MODE_SUBSTITUTION) {
+                hit_t hit;
+                hit.seqId = results[entryIdx].seqId;
+                hit.prefScore = (isReverse) ? -bitScore : bitScore;
+                hit.diagonal = diagonal;
+                shortResults.emplace_back(hit);
+            } else {
+                hit_t hit;
+                hit.seqId = results[entryIdx].seqId;
+                hit.prefScore = 100 * seqId;
+                hit.prefScore = (isReverse) ? -hit.prefScore : hit.prefScore;
+                hit.diagonal = diagonal;
+                shortResults.emplace_back(hit);
+            }
+        }
+    }
+}
+
 int doRescorediagonal(Parameters &par,
                       DBWriter &resultWriter,
                       DBReader<unsigned int> &resultReader,
-              const size_t dbFrom, const size_t dbSize) {
+              const size_t dbFrom, const size_t dbSize, const SequenceWindows *windows) {
 
 
     IndexReader * qDbrIdx = NULL;
@@ -89,6 +321,13 @@ int doRescorediagonal(Parameters &par,
     }
 
     SubstitutionMatrix::FastMatrix fastMatrix = SubstitutionMatrix::createAsciiSubMat(*subMat);
+    // nucleotide matrices with one match and one mismatch score are aligned on mismatch masks
+    DistanceCalculator::NucleotideScoring nuclScoring;
+    const DistanceCalculator::NucleotideScoring *nuclScoringPtr = NULL;
+    if (Parameters::isEqualDbtype(querySeqType, Parameters::DBTYPE_NUCLEOTIDES)
+        && DistanceCalculator::initNucleotideScoring(nuclScoring, *subMat)) {
+        nuclScoringPtr = &nuclScoring;
+    }
 
 
     float scorePerColThr = 0.0;
@@ -106,20 +345,53 @@ int doRescorediagonal(Parameters &par,
     bool reversePrefilterResult = (Parameters::isEqualDbtype(resultReader.getDbtype(), Parameters::DBTYPE_PREFILTER_REV_RES));
     EvalueComputation evaluer(tdbr->getAminoAcidDBSize(), subMat);
 
+    // --swap-output: every thread sorts the swapped alignments into buckets of consecutive targets,
+    // the buckets of all threads are merged per target at the end instead of a separate swapresults pass
+    const bool swapOutput = par.swapOutput;
+    size_t queryFrom = dbFrom;
+    size_t querySize = dbSize;
+    size_t targetFrom = 0;
+    size_t targetSize = 0;
+    size_t bucketCount = 0;
+    EvalueComputation *swapEvaluer = NULL;
+    std::vector<std::vector<std::vector<std::pair<unsigned int, Matcher::result_t>>>> swapBuckets;
+    if (swapOutput) {
+        if (windows != NULL) {
+            Debug(Debug::ERROR) << "--swap-output can not be combined with windows\n";
+            EXIT(EXIT_FAILURE);
+        }
+        queryFrom = 0;
+        querySize = resultReader.getSize();
+        targetFrom = dbFrom;
+        targetSize = dbSize;
+        bucketCount = std::max(static_cast<size_t>(1), std::min(targetSize, static_cast<size_t>(par.threads) * 16));
+        swapBuckets.resize(par.threads, std::vector<std::vector<std::pair<unsigned int, Matcher::result_t>>>(bucketCount));
+        // same E-value as swapresults, the new query is searched against the old query DB
+        if (Parameters::isEqualDbtype(targetSeqType, Parameters::DBTYPE_NUCLEOTIDES)) {
+            swapEvaluer = new EvalueComputation(qdbr->getAminoAcidDBSize(), subMat, par.gapOpen.values.nucleotide(), par.gapExtend.values.nucleotide());
+        } else {
+            swapEvaluer = new EvalueComputation(qdbr->getAminoAcidDBSize(), subMat, par.gapOpen.values.aminoacid(), par.gapExtend.values.aminoacid());
+        }
+    }
+
+    RescoreContext context = { par, qdbr, tdbr, subMat, fastMatrix, nuclScoringPtr, evaluer, scorePerColThr,
+                               reversePrefilterResult, sameQTDB, swapOutput, targetFrom, targetSize };
+
     size_t totalMemory = Util::getTotalSystemMemory();
     size_t flushSize = 100000000;
     if (totalMemory > resultReader.getTotalDataSize()) {
-        flushSize = resultReader.getSize();
+        // with windows every contig gets an entry, also if the prefilter result is empty
+        flushSize = (windows == NULL) ? resultReader.getSize() : querySize;
     }
     
     size_t iterations = 1;
     if(flushSize > 0){
-        iterations = static_cast<int>(ceil(static_cast<double>(dbSize) / static_cast<double>(flushSize)));
+        iterations = static_cast<int>(ceil(static_cast<double>(querySize) / static_cast<double>(flushSize)));
     }
     
     for (size_t i = 0; i < iterations; i++) {
-        size_t start = dbFrom + (i * flushSize);
-        size_t bucketSize = std::min(dbSize - (i * flushSize), flushSize);
+        size_t start = queryFrom + (i * flushSize);
+        size_t bucketSize = std::min(querySize - (i * flushSize), flushSize);
         Debug::Progress progress(bucketSize);
 
 #pragma omp parallel
@@ -143,201 +415,66 @@ int doRescorediagonal(Parameters &par,
                 queryRevSeq = static_cast<char*>(malloc(queryRevSeqLen));
             }
 #pragma omp for schedule(dynamic, 1)
-            for (size_t id = start; id < (start + bucketSize); id++) {
+            for (size_t task = start; task < (start + bucketSize); task++) {
                 progress.updateProgress();
 
-                char *data = resultReader.getData(id, thread_idx);
-                size_t queryKey = resultReader.getDbKey(id);
-
-                char *querySeq = NULL;
-                std::string queryToWrap; // needed only for wrapped end-start scoring
-                unsigned int queryId = UINT_MAX;
-                int queryLen = -1, origQueryLen = -1;
-                if(*data !=  '\0'){
-                    queryId = qdbr->getId(queryKey);
-                    querySeq = qdbr->getData(queryId, thread_idx);
-                    queryLen = static_cast<int>(qdbr->getSeqLen(queryId));
-                    origQueryLen = queryLen;
-
-                    if (par.wrappedScoring){
-                        queryToWrap = std::string(querySeq,queryLen);
-                        queryToWrap = queryToWrap + queryToWrap;
-                        querySeq = (char*)(queryToWrap).c_str();
-                        queryLen = origQueryLen*2;
-                    }
-
-                    if(reversePrefilterResult == true && queryLen > queryRevSeqLen){
-                        queryRevSeq = static_cast<char*>(realloc(queryRevSeq, queryLen+1));
-                        queryRevSeqLen = queryLen+1;
-                    }
-                    if (reversePrefilterResult == true) {
-                        NucleotideMatrix *nuclMatrix = (NucleotideMatrix *) subMat;
-                        for (int pos = queryLen - 1; pos > -1; pos--) {
-                            unsigned char res = subMat->aa2num[static_cast<int>(querySeq[pos])];
-                            queryRevSeq[(queryLen - 1) - pos] = subMat->num2aa[nuclMatrix->reverseResidue(res)];
-                        }
-                    }
-                    if (sameQTDB && qdbr->isCompressed()) {
-                        queryBuffer.clear();
-                        queryBuffer.append(querySeq, queryLen);
-                        querySeq = (char *) queryBuffer.c_str();
-                    }
-                }
-//                if(par.rescoreMode != Parameters::RESCORE_MODE_HAMMING){
-//                    query.mapSequence(id, queryId, querySeq);
-//                    queryLen = query.L;
-//                }else{
-                // -2 because of \n\0 in sequenceDB
-//                }
-
-                std::vector<hit_t> results = QueryMatcher::parsePrefilterHits(data);
-                for (size_t entryIdx = 0; entryIdx < results.size(); entryIdx++) {
-                    char *querySeqToAlign = querySeq;
-                    bool isReverse = false;
-                    if (reversePrefilterResult) {
-                        if (results[entryIdx].prefScore < 0) {
-                            querySeqToAlign = queryRevSeq;
-                            isReverse=true;
-                        }
-                    }
-
-                    unsigned int targetId = tdbr->getId(results[entryIdx].seqId);
-                    const bool isIdentity = (queryId == targetId && (par.includeIdentity || sameQTDB)) ? true : false;
-                    char *targetSeq = tdbr->getData(targetId, thread_idx);
-                    int dbLen = static_cast<int>(tdbr->getSeqLen(targetId));
-
-                    float queryLength = static_cast<float>(origQueryLen);
-                    float targetLength = static_cast<float>(dbLen);
-                    if (Util::canBeCovered(par.covThr, par.covMode, queryLength, targetLength) == false) {
-                        continue;
-                    }
-                    DistanceCalculator::LocalAlignment alignment;
-                    if (par.wrappedScoring) {
-                        if (dbLen > origQueryLen) {
-                            Debug(Debug::WARNING) << "WARNING: target sequence " << targetId
-                                                  << " is skipped, no valid wrapped scoring possible\n";
+                // a task is one prefilter entry, with windows it covers all windows of a contig
+                const size_t entryCount = (windows == NULL) ? 1 : windows->getWindowCount(task);
+                const unsigned int outputKey = (windows == NULL) ? resultReader.getDbKey(task) : windows->getContigKey(task);
+                for (size_t entry = 0; entry < entryCount; entry++) {
+                    size_t id = task;
+                    if (windows != NULL) {
+                        id = resultReader.getId(windows->getFirstWindow(task) + entry);
+                        if (id == UINT_MAX) {
                             continue;
                         }
-
-                        alignment = DistanceCalculator::computeUngappedWrappedAlignment(
-                                querySeqToAlign, queryLen, targetSeq, targetLength,
-                                results[entryIdx].diagonal, fastMatrix.matrix, par.rescoreMode);
                     }
-                    else {
-                        alignment = DistanceCalculator::computeUngappedAlignment(
-                                querySeqToAlign, queryLen, targetSeq, targetLength,
-                                results[entryIdx].diagonal, fastMatrix.matrix, par.rescoreMode);
-                    }
-                    unsigned int distanceToDiagonal = alignment.distToDiagonal;
-                    int diagonalLen = alignment.diagonalLen;
-                    int distance = alignment.score;
-                    int diagonal = alignment.diagonal;
-                    double seqId = 0;
-                    double evalue = 0.0;
-                    int bitScore = 0;
-                    int alnLen = 0;
-                    float targetCov = static_cast<float>(diagonalLen) / static_cast<float>(dbLen);
-                    float queryCov = static_cast<float>(diagonalLen) / static_cast<float>(origQueryLen);
-
-                    Matcher::result_t result;
-                    if (par.rescoreMode == Parameters::RESCORE_MODE_HAMMING) {
-                        int idCnt = (static_cast<float>(distance));
-                        seqId = Util::computeSeqId(par.seqIdMode, idCnt, origQueryLen, dbLen, diagonalLen);
-                        alnLen = diagonalLen;
-                    } else if (par.rescoreMode == Parameters::RESCORE_MODE_SUBSTITUTION ||
-                               par.rescoreMode == Parameters::RESCORE_MODE_ALIGNMENT ||
-                               par.rescoreMode == Parameters::RESCORE_MODE_END_TO_END_ALIGNMENT ||
-                               par.rescoreMode == Parameters::RESCORE_MODE_WINDOW_QUALITY_ALIGNMENT) {
-                        evalue = evaluer.computeEvalue(distance, origQueryLen);
-                        bitScore = static_cast<int>(evaluer.computeBitScore(distance) + 0.5);
-
-                        if (par.rescoreMode == Parameters::RESCORE_MODE_ALIGNMENT ||
-                            par.rescoreMode == Parameters::RESCORE_MODE_END_TO_END_ALIGNMENT ||
-                            par.rescoreMode == Parameters::RESCORE_MODE_WINDOW_QUALITY_ALIGNMENT) {
-                            alnLen = (alignment.endPos - alignment.startPos) + 1;
-                            int qStartPos, qEndPos, dbStartPos, dbEndPos;
-                            // -1 since diagonal is computed from sequence Len which starts by 1
-                            if (diagonal >= 0) {
-                                qStartPos = alignment.startPos + distanceToDiagonal;
-                                qEndPos = alignment.endPos + distanceToDiagonal;
-                                dbStartPos = alignment.startPos;
-                                dbEndPos = alignment.endPos;
-                            } else {
-                                qStartPos = alignment.startPos;
-                                qEndPos = alignment.endPos;
-                                dbStartPos = alignment.startPos + distanceToDiagonal;
-                                dbEndPos = alignment.endPos + distanceToDiagonal;
-                            }
-//                                int qAlnLen = std::max(qEndPos - qStartPos, static_cast<int>(1));
-//                                int dbAlnLen = std::max(dbEndPos - dbStartPos, static_cast<int>(1));
-//                                seqId = (alignment.score1 / static_cast<float>(std::max(qAlnLength, dbAlnLength)))  * 0.1656 + 0.1141;
-
-                            // compute seq.id if hit fulfills e-value but not by seqId criteria
-                            if (evalue <= par.evalThr || isIdentity) {
-                                int idCnt = 0;
-                                for (int i = qStartPos; i <= qEndPos; i++) {
-                                    char qLetter = querySeqToAlign[i] & static_cast<unsigned char>(~0x20);
-                                    char tLetter = targetSeq[dbStartPos + (i - qStartPos)] & static_cast<unsigned char>(~0x20);
-                                    idCnt += (qLetter == tLetter) ? 1 : 0;
-                                }
-                                seqId = Util::computeSeqId(par.seqIdMode, idCnt, origQueryLen, dbLen, alnLen);
-                            }
-                            char *end = Itoa::i32toa_sse2(alnLen, buffer);
-                            size_t len = end - buffer;
-                            std::string backtrace = "";
-                            if (par.addBacktrace) {
-                                backtrace=std::string(buffer, len - 1);
-                                backtrace.push_back('M');
-                            }
-                            queryCov = SmithWaterman::computeCov(qStartPos, qEndPos, origQueryLen);
-                            targetCov = SmithWaterman::computeCov(dbStartPos, dbEndPos, dbLen);
-                            if (isReverse) {
-                                qStartPos = queryLen - qStartPos - 1;
-                                qEndPos = queryLen - qEndPos - 1;
-                            }
-                            result = Matcher::result_t(results[entryIdx].seqId, bitScore, queryCov, targetCov, seqId, evalue, alnLen,
-                                                       qStartPos, qEndPos, origQueryLen, dbStartPos, dbEndPos, dbLen, backtrace);
+                    const size_t alnFrom = alnResults.size();
+                    rescoreEntry(context, resultReader, id, thread_idx, buffer, queryBuffer, queryRevSeq, queryRevSeqLen, alnResults, shortResults);
+                    if (windows != NULL) {
+                        // window to contig coordinates, the ORF columns keep the window on the contig
+                        const unsigned int qStart = windows->getStart(resultReader.getDbKey(id));
+                        for (size_t i = alnFrom; i < alnResults.size(); ++i) {
+                            Matcher::result_t &res = alnResults[i];
+                            const unsigned int tStart = windows->getStart(res.dbKey);
+                            const unsigned int tContig = windows->getContig(res.dbKey);
+                            res.queryOrfStartPos = qStart;
+                            res.queryOrfEndPos = qStart + res.qLen - 1;
+                            res.dbOrfStartPos = tStart;
+                            res.dbOrfEndPos = tStart + res.dbLen - 1;
+                            res.qStartPos += qStart;
+                            res.qEndPos += qStart;
+                            res.dbStartPos += tStart;
+                            res.dbEndPos += tStart;
+                            res.qLen = windows->getContigLength(task);
+                            res.dbLen = windows->getContigLength(tContig);
+                            res.dbKey = windows->getContigKey(tContig);
                         }
                     }
+                }
 
-                    //float maxSeqLen = std::max(static_cast<float>(targetLen), static_cast<float>(queryLen));
-                    float currScorePerCol = static_cast<float>(distance) / static_cast<float>(diagonalLen);
-                    // query/target cov mode
-                    bool hasCov = Util::hasCoverage(par.covThr, par.covMode, queryCov, targetCov);
-                    // --min-seq-id
-                    bool hasSeqId = seqId >= (par.seqIdThr - std::numeric_limits<float>::epsilon());
-                    bool hasEvalue = (evalue <= par.evalThr);
-                    bool hasAlnLen = (alnLen >= par.alnLenThr);
-
-                    // --filter-hits
-                    bool hasToFilter = (par.filterHits == true && currScorePerCol >= scorePerColThr);
-                    if (isIdentity || hasToFilter || (hasAlnLen && hasCov && hasSeqId && hasEvalue)) {
-                        if (par.rescoreMode == Parameters::RESCORE_MODE_ALIGNMENT ||
-                            par.rescoreMode == Parameters::RESCORE_MODE_END_TO_END_ALIGNMENT ||
-                            par.rescoreMode == Parameters::RESCORE_MODE_WINDOW_QUALITY_ALIGNMENT) {
-                            alnResults.emplace_back(result);
-                        } else if (par.rescoreMode == Parameters::RESCORE_MODE_SUBSTITUTION) {
-                            hit_t hit;
-                            hit.seqId = results[entryIdx].seqId;
-                            hit.prefScore = (isReverse) ? -bitScore : bitScore;
-                            hit.diagonal = diagonal;
-                            shortResults.emplace_back(hit);
-                        } else {
-                            hit_t hit;
-                            hit.seqId = results[entryIdx].seqId;
-                            hit.prefScore = 100 * seqId;
-                            hit.prefScore = (isReverse) ? -hit.prefScore : hit.prefScore;
-                            hit.diagonal = diagonal;
-                            shortResults.emplace_back(hit);
+                if (swapOutput) {
+                    std::vector<std::vector<std::pair<unsigned int, Matcher::result_t>>> &buckets = swapBuckets[thread_idx];
+                    for (size_t i = 0; i < alnResults.size(); ++i) {
+                        Matcher::result_t &res = alnResults[i];
+                        const unsigned int targetKey = res.dbKey;
+                        Matcher::result_t::swapResult(res, *swapEvaluer, par.addBacktrace);
+                        if (res.eval > par.evalThr) {
+                            continue;
                         }
+                        res.dbKey = outputKey;
+                        const size_t bucket = ((tdbr->getId(targetKey) - targetFrom) * bucketCount) / targetSize;
+                        buckets[bucket].emplace_back(targetKey, res);
                     }
-                }
-
-                if (par.sortResults > 0 && alnResults.size() > 1) {
+                    alnResults.clear();
+                } else if (windows != NULL) {
+                    // same order as offsetalignment
+                    std::stable_sort(alnResults.begin(), alnResults.end(), Matcher::compareHits);
+                } else if (par.sortResults > 0 && alnResults.size() > 1) {
                     SORT_SERIAL(alnResults.begin(), alnResults.end(), Matcher::compareHits);
                 }
                 for (size_t i = 0; i < alnResults.size(); ++i) {
-                    size_t len = Matcher::resultToBuffer(buffer, alnResults[i], par.addBacktrace, false);
+                    size_t len = Matcher::resultToBuffer(buffer, alnResults[i], par.addBacktrace, false, windows != NULL);
                     resultBuffer.append(buffer, len);
                 }
 
@@ -349,7 +486,9 @@ int doRescorediagonal(Parameters &par,
                     resultBuffer.append(buffer, len);
                 }
 
-                resultWriter.writeData(resultBuffer.c_str(), resultBuffer.length(), queryKey, thread_idx);
+                if (swapOutput == false) {
+                    resultWriter.writeData(resultBuffer.c_str(), resultBuffer.length(), outputKey, thread_idx);
+                }
                 resultBuffer.clear();
                 shortResults.clear();
                 alnResults.clear();
@@ -361,6 +500,47 @@ int doRescorediagonal(Parameters &par,
         resultReader.remapData();
     }
 
+    if (swapOutput) {
+        Debug::Progress progress(bucketCount);
+#pragma omp parallel
+        {
+            unsigned int thread_idx = 0;
+#ifdef OPENMP
+            thread_idx = (unsigned int) omp_get_thread_num();
+#endif
+            char buffer[1024 + 32768*4];
+            std::string resultBuffer;
+            resultBuffer.reserve(1000000);
+            std::vector<std::pair<unsigned int, Matcher::result_t>> hits;
+#pragma omp for schedule(dynamic, 1)
+            for (size_t bucket = 0; bucket < bucketCount; ++bucket) {
+                progress.updateProgress();
+                hits.clear();
+                for (size_t thread = 0; thread < swapBuckets.size(); ++thread) {
+                    std::vector<std::pair<unsigned int, Matcher::result_t>> &threadHits = swapBuckets[thread][bucket];
+                    hits.insert(hits.end(), threadHits.begin(), threadHits.end());
+                    std::vector<std::pair<unsigned int, Matcher::result_t>>().swap(threadHits);
+                }
+                SORT_SERIAL(hits.begin(), hits.end(), compareSwappedHits);
+
+                // every target of the bucket gets an entry, like in swapresults
+                const size_t bucketFrom = targetFrom + (bucket * targetSize + bucketCount - 1) / bucketCount;
+                const size_t bucketTo = targetFrom + ((bucket + 1) * targetSize + bucketCount - 1) / bucketCount;
+                size_t hitIdx = 0;
+                for (size_t targetId = bucketFrom; targetId < bucketTo; ++targetId) {
+                    const unsigned int targetKey = tdbr->getDbKey(targetId);
+                    for (; hitIdx < hits.size() && hits[hitIdx].first == targetKey; ++hitIdx) {
+                        size_t len = Matcher::resultToBuffer(buffer, hits[hitIdx].second, par.addBacktrace, false);
+                        resultBuffer.append(buffer, len);
+                    }
+                    resultWriter.writeData(resultBuffer.c_str(), resultBuffer.length(), targetKey, thread_idx);
+                    resultBuffer.clear();
+                }
+            }
+        }
+        delete swapEvaluer;
+    }
+
 
     if (tDbrIdx != NULL) {
         delete tDbrIdx;
@@ -390,12 +570,22 @@ int rescorediagonal(int argc, const char **argv, const Command &command) {
        par.rescoreMode == Parameters::RESCORE_MODE_END_TO_END_ALIGNMENT ||
        par.rescoreMode == Parameters::RESCORE_MODE_WINDOW_QUALITY_ALIGNMENT){
         dbtype = Parameters::DBTYPE_ALIGNMENT_RES;
+    } else if (par.swapOutput) {
+        Debug(Debug::ERROR) << "--swap-output needs an alignment --rescore-mode (2, 3 or 4)\n";
+        return EXIT_FAILURE;
     }
+    // the swapped output is keyed by target, the work is split by the targets
+    DBReader<unsigned int> *targetReader = NULL;
+    if (par.swapOutput) {
+        targetReader = new DBReader<unsigned int>(par.db2.c_str(), par.db2Index.c_str(), 1, DBReader<unsigned int>::USE_INDEX);
+        targetReader->open(DBReader<unsigned int>::NOSORT);
+    }
+    DBReader<unsigned int> &splitReader = (targetReader != NULL) ? *targetReader : resultReader;
 #ifdef HAVE_MPI
     size_t dbFrom = 0;
     size_t dbSize = 0;
 
-    resultReader.decomposeDomainByAminoAcid(MMseqsMPI::rank, MMseqsMPI::numProc, &dbFrom, &dbSize);
+    splitReader.decomposeDomainByAminoAcid(MMseqsMPI::rank, MMseqsMPI::numProc, &dbFrom, &dbSize);
     std::string outfile = par.db4;
     std::string outfileIndex = par.db4Index;
     std::pair<std::string, std::string> tmpOutput = Util::createTmpFileNames(outfile, outfileIndex, MMseqsMPI::rank);
@@ -417,10 +607,14 @@ int rescorediagonal(int argc, const char **argv, const Command &command) {
 #else
     DBWriter resultWriter(par.db4.c_str(), par.db4Index.c_str(), par.threads, par.compressed, dbtype);
     resultWriter.open();
-    int status = doRescorediagonal(par, resultWriter, resultReader, 0, resultReader.getSize());
+    int status = doRescorediagonal(par, resultWriter, resultReader, 0, splitReader.getSize());
     resultWriter.close();
 
 #endif
+    if (targetReader != NULL) {
+        targetReader->close();
+        delete targetReader;
+    }
     resultReader.close();
     return status;
 }
@@ -0,0 +1,18 @@
+#ifndef RESCOREDIAGONAL_H
+#define RESCOREDIAGONAL_H
+
+#include "Parameters.h"
+#include "DBReader.h"
+#include "DBWriter.h"
+#include "SequenceWindows.h"
+
+// rescores the prefilter entries [dbFrom, dbFrom + dbSize) of resultReader
+// windows is optional, if set the query and target sequences are windows of the contigs of windows.
+// [dbFrom, dbFrom + dbSize) are then contig indices, all windows of a contig are written to one entry
+// of the contig with the alignments in contig coordinates (like offsetalignment --merge-query 1)
+// with par.swapOutput the alignments are written keyed by target like swapresults, all prefilter entries are
+// rescored and [dbFrom, dbFrom + dbSize) are the target sequences that are written. Can not be combined with windows.
+int doRescorediagonal(Parameters &par, DBWriter &resultWriter, DBReader<unsigned int> &resultReader,
+                      const size_t dbFrom, const size_t dbSize, const SequenceWindows *windows = NULL);
+
+#endif
@@ -4,6 +4,7 @@
 #include "DistanceCalculator.h"
 #include "FileUtil.h"
 #include "Timer.h"
+#include "Telemetry.h"
 
 #include <iomanip>
 
@@ -37,8 +38,10 @@ Command *getCommandByName(const char *s) {
 
 int runCommand(Command *p, int argc, const char **argv) {
     Timer timer;
+    Telemetry::begin(p->cmd);
     int status = p->commandFunction(argc, argv, *p);
     Debug(Debug::INFO) << "Time for processing: " << timer.lap() << "\n";
+    Telemetry::end(status);
     return status;
 }
 
@@ -1,4 +1,5 @@
 #include "DBReader.h"
+#include "Telemetry.h"
 #include "FastSort.h"
 #include <algorithm>
 #include <climits>
@@ -16,6 +17,8 @@
 #include "Util.h"
 #include "FileUtil.h"
 #include "itoa.h"
+#include "PackedNucleotides.h"
+#include "MemoryDatabase.h"
 
 #ifdef OPENMP
 #include <omp.h>
@@ -98,13 +101,37 @@ template <typename T> DBReader<T>::~DBReader(){
     }
 }
 
+// only databases with numeric keys are kept in memory
+static void copyMemoryIndex(DBReader<unsigned int>::Index &index, const DBReader<unsigned int>::Index &memoryIndex) {
+    index = memoryIndex;
+}
+
+static void copyMemoryIndex(DBReader<std::string>::Index &, const DBReader<unsigned int>::Index &) {
+    Debug(Debug::ERROR) << "A database in memory can only be opened with numeric keys\n";
+    EXIT(EXIT_FAILURE);
+}
+
 template <typename T> bool DBReader<T>::open(int accessType){
     // count the number of entries
     this->accessType = accessType;
     if (dataFileName != NULL) {
         dbtype = FileUtil::parseDbType(dataFileName);
     }
-    if (dataMode & USE_DATA) {
+    // kept in memory or shared by an earlier module of this process
+    MemoryDatabase::Entry *memory = (dataFileName != NULL && externalData == false) ? MemoryDatabase::find(dataFileName) : NULL;
+    if (memory != NULL && (dataMode & USE_DATA)) {
+        if (dataMode & USE_WRITABLE) {
+            Debug(Debug::ERROR) << "Database " << dataFileName << " is in memory and cannot be opened writable\n";
+            EXIT(EXIT_FAILURE);
+        }
+        // the data belongs to the MemoryDatabase, dataMapped stays false so close does not unmap it
+        dataFileCnt = memory->dataFiles.size();
+        dataSizeOffset = new size_t[dataFileCnt + 1];
+        dataFiles = new char*[dataFileCnt];
+        std::copy(memory->dataSizeOffset.begin(), memory->dataSizeOffset.end(), dataSizeOffset);
+        std::copy(memory->dataFiles.begin(), memory->dataFiles.end(), dataFiles);
+        totalDataSize = dataSizeOffset[dataFileCnt];
+    } else if (dataMode & USE_DATA) {
         dataFileNames = FileUtil::findDatafiles(dataFileName);
         if (dataFileNames.empty()) {
             Debug(Debug::ERROR) << "No datafile could be found for " << dataFileName << "!\n";
@@ -157,21 +184,44 @@ template <typename T> bool DBReader<T>::open(int accessType){
     }
     bool isSortedById = false;
     if (externalData == false) {
-        MemoryMapped indexData(indexFileName, MemoryMapped::WholeFile, MemoryMapped::SequentialScan);
-        if (!indexData.isValid()){
-            Debug(Debug::ERROR) << "Cannot open index file " << indexFileName << "\n";
-            EXIT(EXIT_FAILURE);
+        MemoryMapped indexData;
+        char* indexDataChar = NULL;
+        size_t indexDataSize = 0;
+        if (memory != NULL) {
+            size = memory->index.size();
+        } else {
+            indexData.open(indexFileName, MemoryMapped::WholeFile, MemoryMapped::SequentialScan);
+            if (!indexData.isValid()){
+                Debug(Debug::ERROR) << "Cannot open index file " << indexFileName << "\n";
+                EXIT(EXIT_FAILURE);
+            }
+            indexDataChar = (char *) indexData.getData();
+            indexDataSize = indexData.size();
+            size = Util::ompCountLines(indexDataChar, indexDataSize, threads);
         }
-        char* indexDataChar = (char *) indexData.getData();
-        size_t indexDataSize = indexData.size();
-        size = Util::ompCountLines(indexDataChar, indexDataSize, threads);
+        Telemetry::addEntriesIn(size);
 
         index = new(std::nothrow) Index[size];
         Util::checkAllocation(index, "Cannot allocate index memory in DBReader");
         incrementMemory(sizeof(Index) * size);
 
-        bool isSortedById = readIndex(indexDataChar, indexDataSize, index, dataSize);
-        indexData.close();
+        bool isSortedById;
+        if (memory != NULL) {
+            dataSize = 0;
+            maxSeqLen = 0;
+            unsigned int memoryLastKey = 0;
+            for (size_t i = 0; i < size; i++) {
+                copyMemoryIndex(index[i], memory->index[i]);
+                dataSize += memory->index[i].length;
+                maxSeqLen = std::max(memory->index[i].length, maxSeqLen);
+                memoryLastKey = std::max(memory->index[i].id, memoryLastKey);
+            }
+            lastKey = memoryLastKey;
+            isSortedById = memory->isSortedById;
+        } else {
+            isSortedById = readIndex(indexDataChar, indexDataSize, index, dataSize);
+            indexData.close();
+        }
 
         // sortIndex also handles access modes that don't require sorting
         sortIndex(isSortedById);
@@ -513,6 +563,10 @@ template <typename T> char* DBReader<T>::getDataCompressed(size_t id, int thrIdx
     size_t totalSize = 0;
     const void *cBuff = static_cast<void *>(data + sizeof(unsigned int));
     const char *dataStart = data + sizeof(unsigned int);
+    if (getExtendedDbtype(dbtype) & Parameters::DBTYPE_EXTENDED_NUCL_PACKED) {
+        PackedNucleotides::decode(dataStart, compressedBuffers[thrIdx]);
+        return compressedBuffers[thrIdx];
+    }
     bool isCompressed = (dataStart[cSize] == 0) ? true : false;
     if(isCompressed){
         ZSTD_inBuffer input = {cBuff, cSize, 0};
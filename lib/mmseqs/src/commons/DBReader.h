@@ -245,7 +245,7 @@ public:
     T getLookupKey(size_t id);
     std::string getLookupEntryName(size_t id);
     unsigned int getLookupFileNumber(size_t id);
-    void lookupEntryToBuffer(std::string& buffer, const LookupEntry& entry);
+    static void lookupEntryToBuffer(std::string& buffer, const LookupEntry& entry);
     LookupEntry* getLookup() { return lookup; };
 
     static const int NOSORT = 0;
@@ -1,5 +1,7 @@
 #include "DBWriter.h"
+#include "Telemetry.h"
 #include "DBReader.h"
+#include "MemoryDatabase.h"
 #include "Debug.h"
 #include "Util.h"
 #include "FileUtil.h"
@@ -11,6 +13,7 @@
 #define SIMDE_ENABLE_NATIVE_ALIASES
 #include <simde/simde-common.h>
 
+#include <algorithm>
 #include <cstdlib>
 #include <cstdio>
 #include <sstream>
@@ -22,6 +25,9 @@
 
 DBWriter::DBWriter(const char *dataFileName_, const char *indexFileName_, unsigned int threads, size_t mode, int dbtype)
         : threads(threads), mode(mode), dbtype(dbtype) {
+    // entries are written as given, only packnucleotidedb packs them and writes its own dbtype. Modules that take
+    // their output dbtype from a packed input (e.g. extractframes) would otherwise mark plain entries as packed.
+    this->dbtype &= ~(static_cast<int>(Parameters::DBTYPE_EXTENDED_NUCL_PACKED) << 16);
     dataFileName = strdup(dataFileName_);
     indexFileName = strdup(indexFileName_);
 
@@ -54,6 +60,16 @@ DBWriter::DBWriter(const char *dataFileName_, const char *indexFileName_, unsign
         datafileMode = "wb";
     }
 
+    inMemory = MemoryDatabase::isRequested(dataFileName_);
+    memoryData = NULL;
+    memoryDataSize = NULL;
+    memoryIndex = NULL;
+    if (inMemory) {
+        memoryData = new char*[threads];
+        memoryDataSize = new size_t[threads];
+        memoryIndex = new std::vector<DBReader<unsigned int>::Index>[threads];
+    }
+
     closed = true;
 }
 
@@ -93,6 +109,11 @@ DBWriter::~DBWriter() {
         delete [] cstream;
         delete [] state;
     }
+    if (inMemory) {
+        delete [] memoryData;
+        delete [] memoryDataSize;
+        delete [] memoryIndex;
+    }
 }
 
 void DBWriter::sortDatafileByIdOrder(DBReader<unsigned int> &dbr) {
@@ -136,43 +157,55 @@ void DBWriter::open(size_t bufferSize) {
         dataFileNames[i] = makeResultFilename(dataFileName, i);
         indexFileNames[i] = makeResultFilename(indexFileName, i);
 
-        dataFiles[i] = FileUtil::openAndDelete(dataFileNames[i], datafileMode.c_str());
-        int fd = fileno(dataFiles[i]);
-        int flags;
-        if ((flags = fcntl(fd, F_GETFL, 0)) < 0 || fcntl(fd, F_SETFD, flags | FD_CLOEXEC) == -1) {
-            Debug(Debug::ERROR) << "Can not set mode for " << dataFileNames[i] << "!\n";
-            EXIT(EXIT_FAILURE);
-        }
+        if (inMemory) {
+            // the FILE writes of a thread go to a growing buffer, there are no index files
+            dataFiles[i] = open_memstream(&memoryData[i], &memoryDataSize[i]);
+            if (dataFiles[i] == NULL) {
+                perror(dataFileNames[i]);
+                EXIT(EXIT_FAILURE);
+            }
+            dataFilesBuffer[i] = NULL;
+            indexFiles[i] = NULL;
+            memoryIndex[i].clear();
+        } else {
+            dataFiles[i] = FileUtil::openAndDelete(dataFileNames[i], datafileMode.c_str());
+            int fd = fileno(dataFiles[i]);
+            int flags;
+            if ((flags = fcntl(fd, F_GETFL, 0)) < 0 || fcntl(fd, F_SETFD, flags | FD_CLOEXEC) == -1) {
+                Debug(Debug::ERROR) << "Can not set mode for " << dataFileNames[i] << "!\n";
+                EXIT(EXIT_FAILURE);
+            }
 
-        dataFilesBuffer[i] = new(std::nothrow) char[bufferSize];
-        Util::checkAllocation(dataFilesBuffer[i], "Cannot allocate buffer for DBWriter");
-        incrementMemory(bufferSize);
-        this->bufferSize = bufferSize;
+            dataFilesBuffer[i] = new(std::nothrow) char[bufferSize];
+            Util::checkAllocation(dataFilesBuffer[i], "Cannot allocate buffer for DBWriter");
+            incrementMemory(bufferSize);
+            this->bufferSize = bufferSize;
 
-        // set buffer to 64
-        if (setvbuf(dataFiles[i], dataFilesBuffer[i], _IOFBF, bufferSize) != 0) {
-            Debug(Debug::WARNING) << "Write buffer could not be allocated (bufferSize=" << bufferSize << ")\n";
-        }
+            // set buffer to 64
+            if (setvbuf(dataFiles[i], dataFilesBuffer[i], _IOFBF, bufferSize) != 0) {
+                Debug(Debug::WARNING) << "Write buffer could not be allocated (bufferSize=" << bufferSize << ")\n";
+            }
 
-        indexFiles[i] = FileUtil::openAndDelete(indexFileNames[i], "w");
-        fd = fileno(indexFiles[i]);
-        if ((flags = fcntl(fd, F_GETFL, 0)) < 0 || fcntl(fd, F_SETFD, flags | FD_CLOEXEC) == -1) {
-            Debug(Debug::ERROR) << "Can not set mode for " << indexFileNames[i] << "!\n";
-            EXIT(EXIT_FAILURE);
-        }
+            indexFiles[i] = FileUtil::openAndDelete(indexFileNames[i], "w");
+            fd = fileno(indexFiles[i]);
+            if ((flags = fcntl(fd, F_GETFL, 0)) < 0 || fcntl(fd, F_SETFD, flags | FD_CLOEXEC) == -1) {
+                Debug(Debug::ERROR) << "Can not set mode for " << indexFileNames[i] << "!\n";
+                EXIT(EXIT_FAILURE);
+            }
 
-        if (setvbuf(indexFiles[i], NULL, _IOFBF, bufferSize) != 0) {
-            Debug(Debug::WARNING) << "Write buffer could not be allocated (bufferSize=" << bufferSize << ")\n";
-        }
+            if (setvbuf(indexFiles[i], NULL, _IOFBF, bufferSize) != 0) {
+                Debug(Debug::WARNING) << "Write buffer could not be allocated (bufferSize=" << bufferSize << ")\n";
+            }
 
-        if (dataFiles[i] == NULL) {
-            perror(dataFileNames[i]);
-            EXIT(EXIT_FAILURE);
-        }
+            if (dataFiles[i] == NULL) {
+                perror(dataFileNames[i]);
+                EXIT(EXIT_FAILURE);
+            }
 
-        if (indexFiles[i] == NULL) {
-            perror(indexFileNames[i]);
-            EXIT(EXIT_FAILURE);
+            if (indexFiles[i] == NULL) {
+                perror(indexFileNames[i]);
+                EXIT(EXIT_FAILURE);
+            }
         }
 
         if((mode & Parameters::WRITER_COMPRESSED_MODE) != 0){
@@ -220,7 +253,7 @@ void DBWriter::close(bool merge, bool needsSort) {
             Debug(Debug::ERROR) << "Cannot close data file " << dataFileNames[i] << "\n";
             EXIT(EXIT_FAILURE);
         }
-        if (fclose(indexFiles[i]) != 0) {
+        if (indexFiles[i] != NULL && fclose(indexFiles[i]) != 0) {
             Debug(Debug::ERROR) << "Cannot close index file " << indexFileNames[i] << "\n";
             EXIT(EXIT_FAILURE);
         }
@@ -236,21 +269,71 @@ void DBWriter::close(bool merge, bool needsSort) {
         }
     }
 
-    merge = getenv("MMSEQS_FORCE_MERGE") != NULL ? true : merge;
-    mergeResults(dataFileName, indexFileName, (const char **) dataFileNames, (const char **) indexFileNames,
-                 threads, merge, ((mode & Parameters::WRITER_LEXICOGRAPHIC_MODE) != 0), needsSort);
+    if (inMemory) {
+        closeInMemory(needsSort);
+    } else {
+        merge = getenv("MMSEQS_FORCE_MERGE") != NULL ? true : merge;
+        mergeResults(dataFileName, indexFileName, (const char **) dataFileNames, (const char **) indexFileNames,
+                     threads, merge, ((mode & Parameters::WRITER_LEXICOGRAPHIC_MODE) != 0), needsSort);
 
-    writeDbtypeFile(dataFileName, dbtype, (mode & Parameters::WRITER_COMPRESSED_MODE) != 0);
+        writeDbtypeFile(dataFileName, dbtype, (mode & Parameters::WRITER_COMPRESSED_MODE) != 0);
+    }
 
     for (unsigned int i = 0; i < threads; i++) {
-        delete [] dataFilesBuffer[i];
-        decrementMemory(bufferSize);
+        if (dataFilesBuffer[i] != NULL) {
+            delete [] dataFilesBuffer[i];
+            decrementMemory(bufferSize);
+        }
         free(dataFileNames[i]);
         free(indexFileNames[i]);
     }
     closed = true;
 }
 
+// concatenates the thread buffers like mergeResults concatenates the data files of the threads
+void DBWriter::closeInMemory(bool needsSort) {
+    if ((mode & Parameters::WRITER_LEXICOGRAPHIC_MODE) != 0) {
+        Debug(Debug::ERROR) << "Database " << dataFileName << " with string keys cannot be kept in memory\n";
+        EXIT(EXIT_FAILURE);
+    }
+    size_t totalSize = 0;
+    size_t entryCount = 0;
+    for (unsigned int i = 0; i < threads; i++) {
+        totalSize += memoryDataSize[i];
+        entryCount += memoryIndex[i].size();
+    }
+    char *data = memoryData[0];
+    std::vector<DBReader<unsigned int>::Index> index;
+    index.swap(memoryIndex[0]);
+    if (threads > 1) {
+        data = static_cast<char*>(realloc(data, std::max(totalSize, static_cast<size_t>(1))));
+        Util::checkAllocation(data, "Cannot allocate memory for " + std::string(dataFileName));
+        index.reserve(entryCount);
+        size_t globalOffset = memoryDataSize[0];
+        for (unsigned int i = 1; i < threads; i++) {
+            memcpy(data + globalOffset, memoryData[i], memoryDataSize[i]);
+            free(memoryData[i]);
+            for (size_t j = 0; j < memoryIndex[i].size(); j++) {
+                index.push_back(memoryIndex[i][j]);
+                index.back().offset += globalOffset;
+            }
+            memoryIndex[i].clear();
+            globalOffset += memoryDataSize[i];
+        }
+    }
+    bool isSortedById = true;
+    if (needsSort) {
+        std::stable_sort(index.begin(), index.end(), DBReader<unsigned int>::Index::compareById);
+    } else {
+        for (size_t i = 1; i < index.size() && isSortedById; i++) {
+            isSortedById = index[i - 1].id <= index[i].id;
+        }
+    }
+    const bool isCompressed = (mode & Parameters::WRITER_COMPRESSED_MODE) != 0;
+    MemoryDatabase::add(dataFileName, data, totalSize, index, isSortedById,
+                        isCompressed ? dbtype | (1 << 31) : dbtype & ~(1 << 31));
+}
+
 void DBWriter::writeStart(unsigned int thrIdx) {
     checkClosed();
     if (thrIdx >= threads) {
@@ -390,6 +473,15 @@ void DBWriter::writeEnd(unsigned int key, unsigned int thrIdx, bool addNullByte,
 }
 
 void DBWriter::writeIndexEntry(unsigned int key, size_t offset, size_t length, unsigned int thrIdx){
+    if (inMemory) {
+        DBReader<unsigned int>::Index entry;
+        entry.id = key;
+        entry.offset = offset;
+        entry.length = length;
+        memoryIndex[thrIdx].push_back(entry);
+        Telemetry::addEntriesOut(1);
+        return;
+    }
     char buffer[1024];
     size_t len = indexToBuffer(buffer, key, offset, length );
     size_t written = fwrite(buffer, sizeof(char), len, indexFiles[thrIdx]);
@@ -397,6 +489,7 @@ void DBWriter::writeIndexEntry(unsigned int key, size_t offset, size_t length, u
         Debug(Debug::ERROR) << "Can not write to data file " << dataFileName[thrIdx] << "\n";
         EXIT(EXIT_FAILURE);
     }
+    Telemetry::addEntriesOut(1);
 }
 
 
@@ -72,6 +72,8 @@ private:
 
     void checkClosed();
 
+    void closeInMemory(bool needsSort);
+
     static void mergeResults(const char *outFileName, const char *outFileNameIndex,
                              const char **dataFileNames, const char **indexFileNames,
                              unsigned long fileCount, bool mergeDatafiles,
@@ -111,6 +113,12 @@ private:
 
     std::string datafileMode;
 
+    // result is kept in a MemoryDatabase instead of the data, index and dbtype files
+    bool inMemory;
+    char** memoryData;
+    size_t* memoryDataSize;
+    std::vector<DBReader<unsigned int>::Index>* memoryIndex;
+
 
 };
 
@@ -1,6 +1,7 @@
 #include "FileUtil.h"
 #include "Util.h"
 #include "Debug.h"
+#include "MemoryDatabase.h"
 
 #define SIMDE_ENABLE_NATIVE_ALIASES
 #include <simde/simde-common.h>
@@ -389,6 +390,10 @@ void FileUtil::move(const char * src, const char * dst) {
 }
 
 int FileUtil::parseDbType(const char *name) {
+    MemoryDatabase::Entry *memory = MemoryDatabase::find(name);
+    if (memory != NULL) {
+        return memory->dbtype;
+    }
     std::string dbTypeFile = std::string(name) + ".dbtype";
     if (FileUtil::fileExists(dbTypeFile.c_str()) == false) {
         return Parameters::DBTYPE_GENERIC_DB;
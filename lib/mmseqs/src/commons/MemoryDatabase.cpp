@@ -0,0 +1,78 @@
+#include "MemoryDatabase.h"
+
+#include <cstdlib>
+#include <map>
+#include <set>
+
+static std::map<std::string, MemoryDatabase::Entry> &getEntries() {
+    static std::map<std::string, MemoryDatabase::Entry> entries;
+    return entries;
+}
+
+static std::set<std::string> &getRequested() {
+    static std::set<std::string> requested;
+    return requested;
+}
+
+void MemoryDatabase::request(const std::string &dataFileName) {
+    getRequested().insert(dataFileName);
+}
+
+bool MemoryDatabase::isRequested(const char *dataFileName) {
+    return getRequested().find(dataFileName) != getRequested().end();
+}
+
+void MemoryDatabase::add(const std::string &dataFileName, char *data, size_t dataSize,
+                         std::vector<DBReader<unsigned int>::Index> &index, bool isSortedById, int dbtype) {
+    release(dataFileName);
+    getRequested().erase(dataFileName);
+    Entry &entry = getEntries()[dataFileName];
+    entry.dbtype = dbtype;
+    entry.dataFiles.push_back(data);
+    entry.dataSizeOffset.push_back(0);
+    entry.dataSizeOffset.push_back(dataSize);
+    entry.index.swap(index);
+    entry.isSortedById = isSortedById;
+    entry.ownsData = true;
+}
+
+void MemoryDatabase::share(DBReader<unsigned int> &reader) {
+    const std::string dataFileName = reader.getDataFileName();
+    release(dataFileName);
+    Entry &entry = getEntries()[dataFileName];
+    entry.dbtype = reader.getDbtype();
+    entry.dataSizeOffset.push_back(0);
+    for (size_t i = 0; i < reader.getDataFileCnt(); i++) {
+        entry.dataFiles.push_back(reader.getDataForFile(i));
+        entry.dataSizeOffset.push_back(entry.dataSizeOffset.back() + reader.getDataSizeForFile(i));
+    }
+    DBReader<unsigned int>::Index *index = reader.getIndex();
+    entry.index.assign(index, index + reader.getSize());
+    entry.isSortedById = true;
+    for (size_t i = 1; i < entry.index.size() && entry.isSortedById; i++) {
+        entry.isSortedById = entry.index[i - 1].id <= entry.index[i].id;
+    }
+    entry.ownsData = false;
+}
+
+MemoryDatabase::Entry *MemoryDatabase::find(const char *dataFileName) {
+    std::map<std::string, Entry> &entries = getEntries();
+    if (entries.empty()) {
+        return NULL;
+    }
+    std::map<std::string, Entry>::iterator it = entries.find(dataFileName);
+    return (it != entries.end()) ? &it->second : NULL;
+}
+
+void MemoryDatabase::release(const std::string &dataFileName) {
+    std::map<std::string, Entry>::iterator it = getEntries().find(dataFileName);
+    if (it == getEntries().end()) {
+        return;
+    }
+    if (it->second.ownsData) {
+        for (size_t i = 0; i < it->second.dataFiles.size(); i++) {
+            free(it->second.dataFiles[i]);
+        }
+    }
+    getEntries().erase(it);
+}
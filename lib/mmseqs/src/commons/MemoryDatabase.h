@@ -0,0 +1,47 @@
+#ifndef MMSEQS_MEMORYDATABASE_H
+#define MMSEQS_MEMORYDATABASE_H
+
+#include <string>
+#include <vector>
+
+#include "DBReader.h"
+
+// Databases that the modules of one process hand to each other without going through the file system.
+// A DBWriter to a requested name keeps its result in memory instead of writing the data, index and dbtype files.
+// A DBReader of a registered name uses the data and index of the registration instead of opening the files,
+// either the result of such a DBWriter or a reader that was opened once and is shared by all later modules.
+// Registrations are looked up by the name of the data file. The modules run one after another, there is no locking.
+class MemoryDatabase {
+public:
+    struct Entry {
+        int dbtype;
+        // data of the database, split like the data files of a DBReader
+        std::vector<char *> dataFiles;
+        // dataFiles.size() + 1 offsets, the last one is the total size
+        std::vector<size_t> dataSizeOffset;
+        std::vector<DBReader<unsigned int>::Index> index;
+        bool isSortedById;
+        // data that was written in memory is freed with the entry, the data of a shared reader belongs to the reader
+        bool ownsData;
+    };
+
+    // the next DBWriter to dataFileName keeps its result in memory
+    static void request(const std::string &dataFileName);
+
+    static bool isRequested(const char *dataFileName);
+
+    // registers the result of a DBWriter, takes ownership of data
+    static void add(const std::string &dataFileName, char *data, size_t dataSize,
+                    std::vector<DBReader<unsigned int>::Index> &index, bool isSortedById, int dbtype);
+
+    // shares the data and the index of an open reader, the reader has to stay open until it is released
+    static void share(DBReader<unsigned int> &reader);
+
+    // NULL if dataFileName is not registered
+    static Entry *find(const char *dataFileName);
+
+    // removes the registration and frees the data written in memory
+    static void release(const std::string &dataFileName);
+};
+
+#endif
@@ -3,5 +3,21 @@
 //
 
 #include "MemoryTracker.h"
+#include <sys/time.h>
+#include <sys/resource.h>
+
 size_t MemoryTracker::totalMemorySizeInst = 0;
+size_t MemoryTracker::peakMemorySizeInst = 0;
 
+size_t MemoryTracker::getPeakRssInKb() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#ifdef __APPLE__
+    // bytes on macOS
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+}
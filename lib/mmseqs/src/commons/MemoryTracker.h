@@ -8,9 +8,17 @@
 class MemoryTracker{
 public:
     static size_t getSize() { return totalMemorySizeInst;};
+    // highest getSize() since the start of the process
+    static size_t getPeakSize() { return peakMemorySizeInst;};
+    // peak resident set size of the process in kilobytes as reported by the OS
+    static size_t getPeakRssInKb();
 protected:
     static size_t totalMemorySizeInst;
-    static void incrementMemory(size_t memorySize) { totalMemorySizeInst+=memorySize; }
+    static size_t peakMemorySizeInst;
+    static void incrementMemory(size_t memorySize) {
+        totalMemorySizeInst+=memorySize;
+        peakMemorySizeInst = (totalMemorySizeInst > peakMemorySizeInst) ? totalMemorySizeInst : peakMemorySizeInst;
+    }
     static void decrementMemory(size_t memorySize) { totalMemorySizeInst-=memorySize; }
 };
 #endif //MMSEQS_MEMORYTRACKER_H
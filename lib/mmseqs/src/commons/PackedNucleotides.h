@@ -0,0 +1,185 @@
+#ifndef PACKED_NUCLEOTIDES_H
+#define PACKED_NUCLEOTIDES_H
+
+#include <string>
+#include <cstring>
+#include <stdint.h>
+
+// Nucleotide sequence entries with 2 bits per base (Parameters::DBTYPE_EXTENDED_NUCL_PACKED).
+// A packed database is a compressed database with another codec: an entry is framed like a compressed entry
+// (unsigned int payload size, payload, null byte) and the index keeps the length of the plain entry,
+// so getSeqLen, getEntryLen and the copy functions for compressed entries work unchanged.
+//
+// Payload: uint32 sequence length, uint32 exception run count, uint32 lower case run count,
+// exception runs (uint32 start, uint32 length, char letter), lower case runs (uint32 start, uint32 length),
+// (length + 3) / 4 bytes of bases, base i in bits 2 * (i % 4) of byte i / 4.
+// Exception runs are maximal runs of the same upper case letter that is not A, C, G or T (N, IUPAC codes),
+// their bases are stored as A. The N exception runs are the assembly gaps of the sequence.
+class PackedNucleotides {
+public:
+    static const size_t HEADER_SIZE = 3 * sizeof(uint32_t);
+    static const size_t EXCEPTION_SIZE = 2 * sizeof(uint32_t) + sizeof(char);
+    static const size_t LOWER_CASE_SIZE = 2 * sizeof(uint32_t);
+
+    // appends the payload of seq[0, seqLen) to out
+    static void encode(const char *seq, size_t seqLen, std::string &out) {
+        uint32_t exceptionCount = 0;
+        uint32_t lowerCaseCount = 0;
+        for (size_t pos = 0; pos < seqLen;) {
+            const char letter = toUpper(seq[pos]);
+            size_t end = pos + 1;
+            while (end < seqLen && toUpper(seq[end]) == letter) {
+                end++;
+            }
+            exceptionCount += (baseCode(letter) == NO_BASE) ? 1 : 0;
+            pos = end;
+        }
+        for (size_t pos = 0; pos < seqLen;) {
+            if (isLower(seq[pos]) == false) {
+                pos++;
+                continue;
+            }
+            while (pos < seqLen && isLower(seq[pos])) {
+                pos++;
+            }
+            lowerCaseCount++;
+        }
+
+        const uint32_t length = static_cast<uint32_t>(seqLen);
+        const size_t start = out.size();
+        out.resize(start + HEADER_SIZE + exceptionCount * EXCEPTION_SIZE + lowerCaseCount * LOWER_CASE_SIZE + (seqLen + 3) / 4, 0);
+        char *p = &out[start];
+        memcpy(p, &length, sizeof(uint32_t));
+        memcpy(p + sizeof(uint32_t), &exceptionCount, sizeof(uint32_t));
+        memcpy(p + 2 * sizeof(uint32_t), &lowerCaseCount, sizeof(uint32_t));
+        p += HEADER_SIZE;
+        for (size_t pos = 0; pos < seqLen;) {
+            const char letter = toUpper(seq[pos]);
+            size_t end = pos + 1;
+            while (end < seqLen && toUpper(seq[end]) == letter) {
+                end++;
+            }
+            if (baseCode(letter) == NO_BASE) {
+                const uint32_t runStart = static_cast<uint32_t>(pos);
+                const uint32_t runLength = static_cast<uint32_t>(end - pos);
+                memcpy(p, &runStart, sizeof(uint32_t));
+                memcpy(p + sizeof(uint32_t), &runLength, sizeof(uint32_t));
+                p[2 * sizeof(uint32_t)] = letter;
+                p += EXCEPTION_SIZE;
+            }
+            pos = end;
+        }
+        for (size_t pos = 0; pos < seqLen;) {
+            if (isLower(seq[pos]) == false) {
+                pos++;
+                continue;
+            }
+            const uint32_t runStart = static_cast<uint32_t>(pos);
+            while (pos < seqLen && isLower(seq[pos])) {
+                pos++;
+            }
+            const uint32_t runLength = static_cast<uint32_t>(pos - runStart);
+            memcpy(p, &runStart, sizeof(uint32_t));
+            memcpy(p + sizeof(uint32_t), &runLength, sizeof(uint32_t));
+            p += LOWER_CASE_SIZE;
+        }
+        unsigned char *bases = reinterpret_cast<unsigned char *>(p);
+        for (size_t pos = 0; pos < seqLen; pos++) {
+            const unsigned char code = baseCode(toUpper(seq[pos]));
+            bases[pos / 4] |= static_cast<unsigned char>((code == NO_BASE ? 0 : code) << (2 * (pos % 4)));
+        }
+    }
+
+    // writes the sequence followed by \n\0 like a plain sequence entry, returns the sequence length
+    static size_t decode(const char *payload, char *out) {
+        uint32_t seqLen, exceptionCount, lowerCaseCount;
+        memcpy(&seqLen, payload, sizeof(uint32_t));
+        memcpy(&exceptionCount, payload + sizeof(uint32_t), sizeof(uint32_t));
+        memcpy(&lowerCaseCount, payload + 2 * sizeof(uint32_t), sizeof(uint32_t));
+        const char *exceptions = payload + HEADER_SIZE;
+        const char *lowerCase = exceptions + exceptionCount * EXCEPTION_SIZE;
+        const unsigned char *bases = reinterpret_cast<const unsigned char *>(lowerCase + lowerCaseCount * LOWER_CASE_SIZE);
+
+        const DecodeTable &table = decodeTable();
+        const size_t fullBytes = seqLen / 4;
+        for (size_t i = 0; i < fullBytes; i++) {
+            memcpy(out + 4 * i, table.letters[bases[i]], 4);
+        }
+        for (size_t pos = fullBytes * 4; pos < seqLen; pos++) {
+            out[pos] = table.letters[bases[fullBytes]][pos % 4];
+        }
+        for (uint32_t i = 0; i < exceptionCount; i++) {
+            uint32_t start, length;
+            getRun(exceptions + i * EXCEPTION_SIZE, start, length);
+            memset(out + start, exceptions[i * EXCEPTION_SIZE + 2 * sizeof(uint32_t)], length);
+        }
+        for (uint32_t i = 0; i < lowerCaseCount; i++) {
+            uint32_t start, length;
+            getRun(lowerCase + i * LOWER_CASE_SIZE, start, length);
+            for (uint32_t pos = start; pos < start + length; pos++) {
+                out[pos] = static_cast<char>(out[pos] | 0x20);
+            }
+        }
+        out[seqLen] = '\n';
+        out[seqLen + 1] = '\0';
+        return seqLen;
+    }
+
+    static uint32_t getExceptionCount(const char *payload) {
+        uint32_t exceptionCount;
+        memcpy(&exceptionCount, payload + sizeof(uint32_t), sizeof(uint32_t));
+        return exceptionCount;
+    }
+
+    // exception run i of a payload without decoding the bases
+    static void getException(const char *payload, uint32_t i, uint32_t &start, uint32_t &length, char &letter) {
+        const char *exception = payload + HEADER_SIZE + i * EXCEPTION_SIZE;
+        getRun(exception, start, length);
+        letter = exception[2 * sizeof(uint32_t)];
+    }
+
+private:
+    static const unsigned char NO_BASE = 4;
+
+    struct DecodeTable {
+        char letters[256][4];
+        DecodeTable() {
+            const char bases[4] = {'A', 'C', 'G', 'T'};
+            for (int byte = 0; byte < 256; byte++) {
+                for (int i = 0; i < 4; i++) {
+                    letters[byte][i] = bases[(byte >> (2 * i)) & 3];
+                }
+            }
+        }
+    };
+
+    static const DecodeTable &decodeTable() {
+        static const DecodeTable table;
+        return table;
+    }
+
+    static unsigned char baseCode(char letter) {
+        switch (letter) {
+            case 'A': return 0;
+            case 'C': return 1;
+            case 'G': return 2;
+            case 'T': return 3;
+            default: return NO_BASE;
+        }
+    }
+
+    static bool isLower(char letter) {
+        return letter >= 'a' && letter <= 'z';
+    }
+
+    static char toUpper(char letter) {
+        return isLower(letter) ? static_cast<char>(letter & ~0x20) : letter;
+    }
+
+    static void getRun(const char *run, uint32_t &start, uint32_t &length) {
+        memcpy(&start, run, sizeof(uint32_t));
+        memcpy(&length, run + sizeof(uint32_t), sizeof(uint32_t));
+    }
+};
+
+#endif
@@ -5,6 +5,7 @@
 #include "CommandCaller.h"
 #include "ByteParser.h"
 #include "FileUtil.h"
+#include "MemoryDatabase.h"
 
 #include <map>
 #include <iomanip>
@@ -106,6 +107,7 @@ Parameters::Parameters():
         PARAM_WRAPPED_SCORING(PARAM_WRAPPED_SCORING_ID, "--wrapped-scoring", "Allow wrapped scoring", "Double the (nucleotide) query sequence during the scoring process to allow wrapped diagonal scoring around end and start", typeid(bool), (void *) &wrappedScoring, "", MMseqsParameter::COMMAND_ALIGN | MMseqsParameter::COMMAND_EXPERT),
         PARAM_FILTER_HITS(PARAM_FILTER_HITS_ID, "--filter-hits", "Remove hits by seq. id. and coverage", "Filter hits by seq.id. and coverage", typeid(bool), (void *) &filterHits, "", MMseqsParameter::COMMAND_EXPERT),
         PARAM_SORT_RESULTS(PARAM_SORT_RESULTS_ID, "--sort-results", "Sort results", "Sort results: 0: no sorting, 1: sort by E-value (Alignment) or seq.id. (Hamming)", typeid(int), (void *) &sortResults, "^[0-1]{1}$", MMseqsParameter::COMMAND_EXPERT),
+        PARAM_SWAP_OUTPUT(PARAM_SWAP_OUTPUT_ID, "--swap-output", "Swap output", "Write the alignments keyed by target like swapresults (needs --rescore-mode 2, 3 or 4). The E-values are recomputed with --gap-open and --gap-extend and the alignments are kept in memory", typeid(bool), (void *) &swapOutput, "", MMseqsParameter::COMMAND_EXPERT),
         // result2msa
         PARAM_MSA_FORMAT_MODE(PARAM_MSA_FORMAT_MODE_ID, "--msa-format-mode", "MSA format mode", "Format MSA as: 0: binary cA3M DB\n1: binary ca3m w. consensus DB\n2: aligned FASTA DB\n3: aligned FASTA w. header summary\n4: STOCKHOLM flat file\n5: A3M format\n6: A3M format w. alignment info", typeid(int), (void *) &msaFormatMode, "^[0-6]{1}$"),
         PARAM_ALLOW_DELETION(PARAM_ALLOW_DELETION_ID, "--allow-deletion", "Allow deletions", "Allow deletions in a MSA", typeid(bool), (void *) &allowDeletion, ""),
@@ -449,6 +451,9 @@ Parameters::Parameters():
     rescorediagonal.push_back(&PARAM_SEQ_ID_MODE);
     rescorediagonal.push_back(&PARAM_INCLUDE_IDENTITY);
     rescorediagonal.push_back(&PARAM_SORT_RESULTS);
+    rescorediagonal.push_back(&PARAM_SWAP_OUTPUT);
+    rescorediagonal.push_back(&PARAM_GAP_OPEN);
+    rescorediagonal.push_back(&PARAM_GAP_EXTEND);
     rescorediagonal.push_back(&PARAM_PRELOAD_MODE);
     rescorediagonal.push_back(&PARAM_THREADS);
     rescorediagonal.push_back(&PARAM_COMPRESSED);
@@ -757,6 +762,7 @@ Parameters::Parameters():
     createdb.push_back(&PARAM_WRITE_LOOKUP);
     createdb.push_back(&PARAM_ID_OFFSET);
     createdb.push_back(&PARAM_COMPRESSED);
+    createdb.push_back(&PARAM_THREADS);
     createdb.push_back(&PARAM_V);
 
     // convert2fasta
@@ -2007,7 +2013,8 @@ void Parameters::checkIfDatabaseIsValid(const Command& command, int argc, const
                     continue;
                 }
 
-                if (filenames[fileIdx] != "stdin" && FileUtil::fileExists((filenames[fileIdx]).c_str()) == false && FileUtil::fileExists((filenames[fileIdx] + ".dbtype").c_str()) == false) {
+                if (filenames[fileIdx] != "stdin" && FileUtil::fileExists((filenames[fileIdx]).c_str()) == false && FileUtil::fileExists((filenames[fileIdx] + ".dbtype").c_str()) == false
+                    && MemoryDatabase::find(filenames[fileIdx].c_str()) == NULL) {
                     regex_t regex;
                     compileRegex(&regex, "[a-zA-Z][a-zA-Z0-9+-.]*:\\/\\/");
                     int nomatch = regexec(&regex, filenames[fileIdx].c_str(), 0, NULL, 0);
@@ -2362,6 +2369,7 @@ void Parameters::setDefaults() {
     wrappedScoring = false;
     filterHits = false;
     sortResults = false;
+    swapOutput = false;
 
     // filterDb
     filterColumn = 1;
@@ -87,6 +87,8 @@ public:
     static const unsigned int DBTYPE_EXTENDED_COMPRESSED = 1;
     static const unsigned int DBTYPE_EXTENDED_INDEX_NEED_SRC = 2;
     static const unsigned int DBTYPE_EXTENDED_CONTEXT_PSEUDO_COUNTS = 4;
+    // compressed nucleotide database with 2 bits per base, see PackedNucleotides.h
+    static const unsigned int DBTYPE_EXTENDED_NUCL_PACKED = 8;
 
     // don't forget to add new database types to DBReader::getDbTypeName and Parameters::PARAM_OUTPUT_DBTYPE
 
@@ -474,6 +476,7 @@ public:
     bool filterHits;
     bool globalAlignment;
     int sortResults;
+    bool swapOutput;
 
     // result2msa
     int msaFormatMode;
@@ -775,6 +778,7 @@ public:
     PARAMETER(PARAM_WRAPPED_SCORING)
     PARAMETER(PARAM_FILTER_HITS)
     PARAMETER(PARAM_SORT_RESULTS)
+    PARAMETER(PARAM_SWAP_OUTPUT)
 
     // result2msa
     PARAMETER(PARAM_MSA_FORMAT_MODE)
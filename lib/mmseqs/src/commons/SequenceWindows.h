@@ -0,0 +1,139 @@
+#ifndef SEQUENCE_WINDOWS_H
+#define SEQUENCE_WINDOWS_H
+
+#include "DBReader.h"
+#include "Debug.h"
+#include "Util.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <vector>
+
+// Window view of a sequenceDB that was split by splitsequence into windows of at most windowLength residues
+// overlapping by windowOverlap residues. splitsequence renumbers the windows in the order (contig key, start),
+// so the window keys follow from the contig lengths alone and no header DB has to be parsed.
+// If no contig is longer than windowLength splitsequence links the input, each contig is its own window.
+// Per window 8 bytes (contig index, start) are kept, per contig its key, length and window range.
+class SequenceWindows {
+public:
+    static const unsigned int NO_CONTIG = UINT_MAX;
+
+    // contigReader only needs the index and has to be sorted by key
+    SequenceWindows(DBReader<unsigned int> &contigReader, size_t windowLength, size_t windowOverlap) {
+        // splitsequence needs a positive step between the windows
+        if (windowLength <= windowOverlap) {
+            Debug(Debug::ERROR) << "--sequence-overlap has to be smaller than --max-seq-len\n";
+            EXIT(EXIT_FAILURE);
+        }
+        bool needsSplit = false;
+        for (size_t i = 0; i < contigReader.getSize(); ++i) {
+            needsSplit |= (contigReader.getSeqLen(i) > windowLength);
+        }
+        contigs.resize(contigReader.getSize());
+        if (needsSplit == false) {
+            const size_t windowCount = (contigReader.getSize() > 0) ? contigReader.getLastKey() + 1 : 0;
+            Window none = { NO_CONTIG, 0 };
+            windows.resize(windowCount, none);
+            for (size_t i = 0; i < contigReader.getSize(); ++i) {
+                const unsigned int key = contigReader.getDbKey(i);
+                Contig contig = { key, static_cast<unsigned int>(contigReader.getSeqLen(i)), key, 1 };
+                contigs[i] = contig;
+                Window window = { static_cast<unsigned int>(i), 0 };
+                windows[key] = window;
+            }
+            return;
+        }
+
+        const size_t step = windowLength - windowOverlap;
+        for (size_t i = 0; i < contigReader.getSize(); ++i) {
+            const size_t seqLen = contigReader.getSeqLen(i);
+            // same float arithmetic as splitsequence, it decides the number of windows
+            const size_t windowCount = (size_t) ceilf(static_cast<float>(seqLen) / static_cast<float>(step));
+            Contig contig = { contigReader.getDbKey(i), static_cast<unsigned int>(seqLen),
+                              static_cast<unsigned int>(windows.size()), static_cast<unsigned int>(windowCount) };
+            contigs[i] = contig;
+            for (size_t split = 0; split < windowCount; ++split) {
+                Window window = { static_cast<unsigned int>(i), static_cast<unsigned int>(split * step) };
+                windows.push_back(window);
+            }
+        }
+        this->windowLength = windowLength;
+    }
+
+    // true if the windows of windowReader are the windows of this view
+    bool matches(DBReader<unsigned int> &windowReader) const {
+        size_t windowCount = 0;
+        for (size_t i = 0; i < windows.size(); ++i) {
+            windowCount += (windows[i].contig != NO_CONTIG) ? 1 : 0;
+        }
+        if (windowReader.getSize() != windowCount) {
+            return false;
+        }
+        for (size_t i = 0; i < windowReader.getSize(); ++i) {
+            const unsigned int key = windowReader.getDbKey(i);
+            if (getContig(key) == NO_CONTIG || windowReader.getSeqLen(i) != getLength(key)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    size_t getContigCount() const {
+        return contigs.size();
+    }
+
+    unsigned int getContigKey(size_t contigIdx) const {
+        return contigs[contigIdx].key;
+    }
+
+    unsigned int getContigLength(size_t contigIdx) const {
+        return contigs[contigIdx].length;
+    }
+
+    // the windows of a contig are the keys [getFirstWindow, getFirstWindow + getWindowCount)
+    unsigned int getFirstWindow(size_t contigIdx) const {
+        return contigs[contigIdx].firstWindow;
+    }
+
+    unsigned int getWindowCount(size_t contigIdx) const {
+        return contigs[contigIdx].windowCount;
+    }
+
+    // contig index of a window key, NO_CONTIG if the key is no window
+    unsigned int getContig(unsigned int windowKey) const {
+        return (windowKey < windows.size()) ? windows[windowKey].contig : NO_CONTIG;
+    }
+
+    // start of the window on its contig
+    unsigned int getStart(unsigned int windowKey) const {
+        return windows[windowKey].start;
+    }
+
+    unsigned int getLength(unsigned int windowKey) const {
+        const Window &window = windows[windowKey];
+        const unsigned int contigLength = contigs[window.contig].length;
+        return (windowLength == 0) ? contigLength : std::min(static_cast<unsigned int>(windowLength), contigLength - window.start);
+    }
+
+private:
+    struct Contig {
+        unsigned int key;
+        unsigned int length;
+        unsigned int firstWindow;
+        unsigned int windowCount;
+    };
+
+    struct Window {
+        unsigned int contig;
+        unsigned int start;
+    };
+
+    std::vector<Contig> contigs;
+    // indexed by window key
+    std::vector<Window> windows;
+    // 0 if the contigs are not split
+    size_t windowLength = 0;
+};
+
+#endif
@@ -0,0 +1,133 @@
+#include "Telemetry.h"
+#include "MemoryTracker.h"
+#include "CommandCaller.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+const char *Telemetry::ENV_NAME = "MMSEQS_TELEMETRY";
+size_t Telemetry::entriesIn = 0;
+size_t Telemetry::entriesOut = 0;
+std::vector<std::pair<const char *, Telemetry::Snapshot>> Telemetry::running;
+
+void Telemetry::readIoBytes(size_t &bytesRead, size_t &bytesWritten) {
+    bytesRead = 0;
+    bytesWritten = 0;
+    // storage I/O including the page faults of memory mapped DBs
+    FILE *io = fopen("/proc/self/io", "r");
+    if (io != NULL) {
+        char line[128];
+        unsigned long long value;
+        while (fgets(line, sizeof(line), io) != NULL) {
+            if (sscanf(line, "read_bytes: %llu", &value) == 1) {
+                bytesRead = value;
+            } else if (sscanf(line, "write_bytes: %llu", &value) == 1) {
+                bytesWritten = value;
+            }
+        }
+        fclose(io);
+        return;
+    }
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        bytesRead = usage.ru_inblock * 512;
+        bytesWritten = usage.ru_oublock * 512;
+    }
+}
+
+Telemetry::Snapshot Telemetry::snapshot() {
+    Snapshot snapshot;
+    // nesting level of this command, 0 for a command started by the user
+    snapshot.depth = static_cast<int>(CommandCaller::getCallDepth());
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    snapshot.wallTime = now.tv_sec + 1e-6 * now.tv_usec;
+    struct rusage usage;
+    memset(&usage, 0, sizeof(usage));
+    getrusage(RUSAGE_SELF, &usage);
+    snapshot.userTime = usage.ru_utime.tv_sec + 1e-6 * usage.ru_utime.tv_usec;
+    snapshot.systemTime = usage.ru_stime.tv_sec + 1e-6 * usage.ru_stime.tv_usec;
+    readIoBytes(snapshot.bytesRead, snapshot.bytesWritten);
+    snapshot.entriesIn = entriesIn;
+    snapshot.entriesOut = entriesOut;
+    return snapshot;
+}
+
+void Telemetry::record(const char *command, const Snapshot &start, int exitStatus) {
+    const char *file = getenv(ENV_NAME);
+    if (file == NULL || file[0] == '\0') {
+        return;
+    }
+    Snapshot end = snapshot();
+    char buffer[1024];
+    int len = snprintf(buffer, sizeof(buffer), "%s\t%d\t%d\t%.3f\t%.3f\t%.3f\t%zu\t%zu\t%zu\t%zu\t%zu\t%zu\t%d\n",
+                       command, start.depth, static_cast<int>(getpid()),
+                       end.wallTime - start.wallTime, end.userTime - start.userTime, end.systemTime - start.systemTime,
+                       MemoryTracker::getPeakRssInKb(), MemoryTracker::getPeakSize(),
+                       end.bytesRead - start.bytesRead, end.bytesWritten - start.bytesWritten,
+                       end.entriesIn - start.entriesIn, end.entriesOut - start.entriesOut, exitStatus);
+    if (len <= 0 || static_cast<size_t>(len) >= sizeof(buffer)) {
+        return;
+    }
+    int fd = open(file, O_WRONLY | O_CREAT | O_APPEND, 0666);
+    if (fd == -1) {
+        return;
+    }
+    // telemetry must never fail a command
+    if (write(fd, buffer, len) != len) {
+        close(fd);
+        return;
+    }
+    close(fd);
+}
+
+void Telemetry::begin(const char *command) {
+    if (running.empty()) {
+        // glibc passes the status of exit to the handler, elsewhere the status is unknown and recorded as -1
+#ifdef __GLIBC__
+        static bool registered = (on_exit(recordAtExit, NULL) == 0);
+#else
+        static bool registered = (atexit([]() { recordAtExit(-1, NULL); }) == 0);
+#endif
+        (void) registered;
+    }
+    running.emplace_back(command, snapshot());
+}
+
+void Telemetry::end(int exitStatus) {
+    if (running.empty()) {
+        return;
+    }
+    record(running.back().first, running.back().second, exitStatus);
+    running.pop_back();
+}
+
+void Telemetry::recordAtExit(int exitStatus, void *) {
+    while (running.empty() == false) {
+        end(exitStatus);
+    }
+}
+
+bool Telemetry::parseRecord(const char *line, Record &record) {
+    char command[256];
+    unsigned long long maxRssKb, trackedPeakBytes, bytesRead, bytesWritten, entriesIn, entriesOut;
+    int fields = sscanf(line, "%255s\t%d\t%d\t%lf\t%lf\t%lf\t%llu\t%llu\t%llu\t%llu\t%llu\t%llu\t%d",
+                        command, &record.depth, &record.pid, &record.wallTime, &record.userTime, &record.systemTime,
+                        &maxRssKb, &trackedPeakBytes, &bytesRead, &bytesWritten, &entriesIn, &entriesOut, &record.exitStatus);
+    if (fields != 13) {
+        return false;
+    }
+    record.command = command;
+    record.maxRssKb = maxRssKb;
+    record.trackedPeakBytes = trackedPeakBytes;
+    record.bytesRead = bytesRead;
+    record.bytesWritten = bytesWritten;
+    record.entriesIn = entriesIn;
+    record.entriesOut = entriesOut;
+    return true;
+}
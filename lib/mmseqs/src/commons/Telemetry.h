@@ -0,0 +1,74 @@
+#ifndef MMSEQS_TELEMETRY_H
+#define MMSEQS_TELEMETRY_H
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+#include <utility>
+
+// Resource usage of the commands of a workflow run.
+// If the environment variable MMSEQS_TELEMETRY names a file, every command appends one tab separated record:
+// command depth pid wallTime userTime systemTime maxRssKb trackedPeakBytes bytesRead bytesWritten entriesIn entriesOut exitStatus
+// Records are written with a single O_APPEND write, so concurrent processes do not interleave.
+class Telemetry {
+public:
+    struct Snapshot {
+        int depth;
+        double wallTime;
+        double userTime;
+        double systemTime;
+        size_t bytesRead;
+        size_t bytesWritten;
+        size_t entriesIn;
+        size_t entriesOut;
+    };
+
+    struct Record {
+        std::string command;
+        int depth;
+        int pid;
+        double wallTime;
+        double userTime;
+        double systemTime;
+        size_t maxRssKb;
+        size_t trackedPeakBytes;
+        size_t bytesRead;
+        size_t bytesWritten;
+        size_t entriesIn;
+        size_t entriesOut;
+        int exitStatus;
+    };
+
+    static const char *ENV_NAME;
+
+    static Snapshot snapshot();
+
+    // appends the usage since start to the MMSEQS_TELEMETRY file, does nothing if it is not set
+    static void record(const char *command, const Snapshot &start, int exitStatus);
+
+    // begin starts the measurement of a command, end records it. Commands can be nested (in process stages).
+    // Commands that leave the process through EXIT before end are recorded with the exit status at exit
+    static void begin(const char *command);
+    static void end(int exitStatus);
+
+    static bool parseRecord(const char *line, Record &record);
+
+    // number of index entries of the opened DBReaders and the written DBWriter entries
+    static void addEntriesIn(size_t count) {
+        __sync_fetch_and_add(&entriesIn, count);
+    }
+    static void addEntriesOut(size_t count) {
+        __sync_fetch_and_add(&entriesOut, count);
+    }
+
+private:
+    static size_t entriesIn;
+    static size_t entriesOut;
+    static std::vector<std::pair<const char *, Snapshot>> running;
+
+    static void recordAtExit(int exitStatus, void *);
+
+    static void readIoBytes(size_t &bytesRead, size_t &bytesWritten);
+};
+
+#endif //MMSEQS_TELEMETRY_H
@@ -386,7 +386,8 @@ std::pair<size_t, size_t> fillKmerPositionArray(KmerPosition<T> * kmerArray, siz
 
 template <typename T>
 KmerPosition<T> * doComputation(size_t totalKmers, size_t hashStartRange, size_t hashEndRange, std::string splitFile,
-                                DBReader<unsigned int> & seqDbr, Parameters & par, BaseMatrix  * subMat) {
+                                DBReader<unsigned int> & seqDbr, Parameters & par, BaseMatrix  * subMat,
+                                const unsigned char *seqLabels, const unsigned char *seqIsNew) {
 
     KmerPosition<T> * hashSeqPair = initKmerPositionMemory<T>(totalKmers);
     size_t elementsToSort;
@@ -416,9 +417,9 @@ KmerPosition<T> * doComputation(size_t totalKmers, size_t hashStartRange, size_t
     // The longest sequence is the first since we sorted by kmer, seq.Len and id
     size_t writePos;
     if(Parameters::isEqualDbtype(seqDbr.getDbtype(), Parameters::DBTYPE_NUCLEOTIDES)){
-        writePos = assignGroup<Parameters::DBTYPE_NUCLEOTIDES, T>(hashSeqPair, totalKmers, par.includeOnlyExtendable, par.covMode, par.covThr);
+        writePos = assignGroup<Parameters::DBTYPE_NUCLEOTIDES, T>(hashSeqPair, totalKmers, par.includeOnlyExtendable, par.covMode, par.covThr, seqLabels, seqIsNew);
     }else{
-        writePos = assignGroup<Parameters::DBTYPE_AMINO_ACIDS, T>(hashSeqPair, totalKmers, par.includeOnlyExtendable, par.covMode, par.covThr);
+        writePos = assignGroup<Parameters::DBTYPE_AMINO_ACIDS, T>(hashSeqPair, totalKmers, par.includeOnlyExtendable, par.covMode, par.covThr, seqLabels, seqIsNew);
     }
 
     // sort by rep. sequence (stored in kmer) and sequence id
@@ -448,7 +449,8 @@ KmerPosition<T> * doComputation(size_t totalKmers, size_t hashStartRange, size_t
 }
 
 template <int TYPE, typename T>
-size_t assignGroup(KmerPosition<T> *hashSeqPair, size_t splitKmerCount, bool includeOnlyExtendable, int covMode, float covThr) {
+size_t assignGroup(KmerPosition<T> *hashSeqPair, size_t splitKmerCount, bool includeOnlyExtendable, int covMode, float covThr,
+                   const unsigned char *seqLabels, const unsigned char *seqIsNew) {
     size_t writePos=0;
     size_t prevHash = hashSeqPair[0].kmer;
     size_t repSeqId = hashSeqPair[0].id;
@@ -468,12 +470,30 @@ size_t assignGroup(KmerPosition<T> *hashSeqPair, size_t splitKmerCount, bool inc
             currKmer = BIT_SET(currKmer, 63);
         }
         if (prevHash != currKmer) {
+            // with labels only groups that contain a member with a label different from the rep. sequence are kept
+            bool keepGroup = true;
+            if (seqLabels != NULL && prevSetSize > 1) {
+                const unsigned char repLabel = seqLabels[hashSeqPair[prevHashStart].id];
+                keepGroup = false;
+                for (size_t i = prevHashStart + 1; i < elementIdx && repLabel != KMER_NO_LABEL; i++) {
+                    const unsigned char label = seqLabels[hashSeqPair[i].id];
+                    if (label != KMER_NO_LABEL && label != repLabel) {
+                        keepGroup = true;
+                        break;
+                    }
+                }
+            }
+            // with seqIsNew only pairs with a new rep. sequence or member are kept
+            const bool repIsNew = (seqIsNew == NULL) || seqIsNew[hashSeqPair[prevHashStart].id];
             for (size_t i = prevHashStart; i < elementIdx; i++) {
                 size_t kmer = hashSeqPair[i].kmer;
                 if(TYPE == Parameters::DBTYPE_NUCLEOTIDES) {
                     kmer = BIT_SET(hashSeqPair[i].kmer, 63);
                 }
-                size_t rId = (kmer != SIZE_T_MAX) ? ((prevSetSize == 1) ? SIZE_T_MAX : repSeqId) : SIZE_T_MAX;
+                size_t rId = (kmer != SIZE_T_MAX && keepGroup) ? ((prevSetSize == 1) ? SIZE_T_MAX : repSeqId) : SIZE_T_MAX;
+                if (rId != SIZE_T_MAX && repIsNew == false && seqIsNew[hashSeqPair[i].id] == 0) {
+                    rId = SIZE_T_MAX;
+                }
                 // remove singletones from set
                 if(rId != SIZE_T_MAX){
                     int diagonal = repSeq_i_pos - hashSeqPair[i].pos;
@@ -558,10 +578,10 @@ size_t assignGroup(KmerPosition<T> *hashSeqPair, size_t splitKmerCount, bool inc
     return writePos;
 }
 
-template size_t assignGroup<0, short>(KmerPosition<short> *kmers, size_t splitKmerCount, bool includeOnlyExtendable, int covMode, float covThr);
-template size_t assignGroup<0, int>(KmerPosition<int> *kmers, size_t splitKmerCount, bool includeOnlyExtendable, int covMode, float covThr);
-template size_t assignGroup<1, short>(KmerPosition<short> *kmers, size_t splitKmerCount, bool includeOnlyExtendable, int covMode, float covThr);
-template size_t assignGroup<1, int>(KmerPosition<int> *kmers, size_t splitKmerCount, bool includeOnlyExtendable, int covMode, float covThr);
+template size_t assignGroup<0, short>(KmerPosition<short> *kmers, size_t splitKmerCount, bool includeOnlyExtendable, int covMode, float covThr, const unsigned char *seqLabels, const unsigned char *seqIsNew);
+template size_t assignGroup<0, int>(KmerPosition<int> *kmers, size_t splitKmerCount, bool includeOnlyExtendable, int covMode, float covThr, const unsigned char *seqLabels, const unsigned char *seqIsNew);
+template size_t assignGroup<1, short>(KmerPosition<short> *kmers, size_t splitKmerCount, bool includeOnlyExtendable, int covMode, float covThr, const unsigned char *seqLabels, const unsigned char *seqIsNew);
+template size_t assignGroup<1, int>(KmerPosition<int> *kmers, size_t splitKmerCount, bool includeOnlyExtendable, int covMode, float covThr, const unsigned char *seqLabels, const unsigned char *seqIsNew);
 
 void setLinearFilterDefault(Parameters *p) {
     p->covThr = 0.8;
@@ -591,7 +611,7 @@ size_t computeMemoryNeededLinearfilter(size_t totalKmer) {
 
 
 template <typename T>
-int kmermatcherInner(Parameters& par, DBReader<unsigned int>& seqDbr) {
+int kmermatcherInner(Parameters& par, DBReader<unsigned int>& seqDbr, const unsigned char *seqLabels, const unsigned char *seqIsNew) {
 
     int querySeqType = seqDbr.getDbtype();
     BaseMatrix *subMat;
@@ -649,7 +669,7 @@ int kmermatcherInner(Parameters& par, DBReader<unsigned int>& seqDbr) {
 
     for(size_t split = fromSplit; split < fromSplit+splitCount; split++) {
         std::string splitFileName = par.db2 + "_split_" +SSTR(split);
-        hashSeqPair = doComputation<T>(totalKmers, hashRanges[split].first, hashRanges[split].second, splitFileName, seqDbr, par, subMat);
+        hashSeqPair = doComputation<T>(totalKmers, hashRanges[split].first, hashRanges[split].second, splitFileName, seqDbr, par, subMat, seqLabels, seqIsNew);
     }
     MPI_Barrier(MPI_COMM_WORLD);
     if(mpiRank == 0){
@@ -665,7 +685,7 @@ int kmermatcherInner(Parameters& par, DBReader<unsigned int>& seqDbr) {
 
         std::string splitFileNameDone = splitFileName + ".done";
         if(FileUtil::fileExists(splitFileNameDone.c_str()) == false){
-            hashSeqPair = doComputation<T>(totalKmersPerSplit, hashRanges[split].first, hashRanges[split].second, splitFileName, seqDbr, par, subMat);
+            hashSeqPair = doComputation<T>(totalKmersPerSplit, hashRanges[split].first, hashRanges[split].second, splitFileName, seqDbr, par, subMat, seqLabels, seqIsNew);
         }
 
         splitFiles.push_back(splitFileName);
@@ -701,6 +721,7 @@ int kmermatcherInner(Parameters& par, DBReader<unsigned int>& seqDbr) {
         }
         Debug(Debug::INFO) << "Time for fill: " << timer.lap() << "\n";
         // add missing entries to the result (needed for clustering)
+        // a labeled result only keeps sequences with matches, it is not used for clustering
 
 #pragma omp parallel num_threads(1)
         {
@@ -712,7 +733,7 @@ int kmermatcherInner(Parameters& par, DBReader<unsigned int>& seqDbr) {
             for (size_t id = 0; id < seqDbr.getSize(); id++) {
                 char buffer[100];
                 unsigned int dbKey = seqDbr.getDbKey(id);
-                if (repSequence[dbKey] == false) {
+                if (repSequence[dbKey] == false && seqLabels == NULL) {
                     hit_t h;
                     h.prefScore = 0;
                     h.diagonal = 0;
@@ -733,6 +754,9 @@ int kmermatcherInner(Parameters& par, DBReader<unsigned int>& seqDbr) {
     return EXIT_SUCCESS;
 }
 
+template int kmermatcherInner<short>(Parameters& par, DBReader<unsigned int>& seqDbr, const unsigned char *seqLabels, const unsigned char *seqIsNew);
+template int kmermatcherInner<int>(Parameters& par, DBReader<unsigned int>& seqDbr, const unsigned char *seqLabels, const unsigned char *seqIsNew);
+
 template <typename T>
 std::vector<std::pair<size_t, size_t>> setupKmerSplits(Parameters &par, BaseMatrix * subMat, DBReader<unsigned int> &seqDbr, size_t totalKmers, size_t splits){
     std::vector<std::pair<size_t, size_t>> hashRanges;
@@ -6,6 +6,7 @@
 #include "BaseMatrix.h"
 
 #include <queue>
+#include <climits>
 
 struct SequencePosition{
     unsigned short score;
@@ -192,8 +193,20 @@ public:
 };
 
 
+// label of sequences without a label in the seqLabels array
+const unsigned char KMER_NO_LABEL = UCHAR_MAX;
+
+// seqLabels (indexed by dbKey) is optional, if set k-mer groups without a member
+// that has a different label than the rep. sequence are removed
+// seqIsNew (indexed by dbKey) is optional, if set only pairs where the rep. sequence
+// or the member is new are kept (incremental updates of a previous search)
 template  <int TYPE, typename T>
-size_t assignGroup(KmerPosition<T> *kmers, size_t splitKmerCount, bool includeOnlyExtendable, int covMode, float covThr);
+size_t assignGroup(KmerPosition<T> *kmers, size_t splitKmerCount, bool includeOnlyExtendable, int covMode, float covThr,
+                   const unsigned char *seqLabels = NULL, const unsigned char *seqIsNew = NULL);
+
+template <typename T>
+int kmermatcherInner(Parameters& par, DBReader<unsigned int>& seqDbr, const unsigned char *seqLabels = NULL,
+                     const unsigned char *seqIsNew = NULL);
 
 template <int TYPE, typename T>
 void mergeKmerFilesAndOutput(DBWriter & dbw, std::vector<std::string> tmpFiles, std::vector<char> &repSequence);
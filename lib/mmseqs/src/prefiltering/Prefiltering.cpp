@@ -203,12 +203,14 @@ Prefiltering::Prefiltering(const std::string &queryDB,
 
     Debug(Debug::INFO) << "Target database size: " << tdbr->getSize() << " type: " <<Parameters::getDbTypeName(targetSeqType) << "\n";
 
+    // getIndexTable only creates the sequence lookup of an index for diagonal scoring
+    sequenceLookup = NULL;
+    indexTable = NULL;
     if (splitMode == Parameters::QUERY_DB_SPLIT) {
         // create the whole index table
         getIndexTable(0, 0, tdbr->getSize());
     } else if (splitMode == Parameters::TARGET_DB_SPLIT) {
-        sequenceLookup = NULL;
-        indexTable = NULL;
+        // the index table of each split is created in runSplit
     } else {
         Debug(Debug::ERROR) << "Invalid split mode: " << splitMode << "\n";
         EXIT(EXIT_FAILURE);
@@ -13,23 +13,11 @@
 #include <algorithm>
 #include <cassert>
 
-const int NcbiTaxonomy::SERIALIZATION_VERSION = 2;
+const int NcbiTaxonomy::SERIALIZATION_VERSION = 3;
 
-int **makeMatrix(size_t maxNodes) {
-    size_t dimension = maxNodes * 2;
-    int **M = new int*[dimension];
-    int k = (int)(MathUtil::flog2(dimension)) + 1;
-    M[0] = new int[dimension * k]();
-    for(size_t i = 1; i < dimension; i++) {
-        M[i] = M[i-1] + k;
-    }
-
-    return M;
-}
-
-void deleteMatrix(int** M) {
-    delete[] M[0];
-    delete[] M;
+// number of columns of the sparse table M, it has one row per Euler tour position
+static size_t matrixColumns(size_t maxNodes) {
+    return (size_t)(MathUtil::flog2(maxNodes * 2)) + 1;
 }
 
 NcbiTaxonomy::NcbiTaxonomy(const std::string &namesFile, const std::string &nodesFile, const std::string &mergedFile) : externalData(false) {
@@ -60,6 +48,21 @@ NcbiTaxonomy::NcbiTaxonomy(const std::string &namesFile, const std::string &node
     }
 
     elh(children, 1, 0, tmpE, tmpL);
+
+    // nodes that are not reached by the tour get an empty interval
+    I = new int[maxNodes * 2];
+    for (size_t i = 0; i < maxNodes; ++i) {
+        I[2 * i] = -1;
+        I[2 * i + 1] = -2;
+    }
+    for (size_t i = 0; i < tmpE.size(); ++i) {
+        int id = tmpE[i];
+        if (I[2 * id] == -1) {
+            I[2 * id] = i;
+        }
+        I[2 * id + 1] = i;
+    }
+
     tmpE.resize(maxNodes * 2, 0);
     tmpL.resize(maxNodes * 2, 0);
 
@@ -68,7 +71,8 @@ NcbiTaxonomy::NcbiTaxonomy(const std::string &namesFile, const std::string &node
     L = new int[maxNodes * 2];
     std::copy(tmpL.begin(), tmpL.end(), L);
 
-    M = makeMatrix(maxNodes);
+    matrixK = matrixColumns(maxNodes);
+    M = new int[maxNodes * 2 * matrixK]();
     InitRangeMinimumQuery();
 
     mmapData = NULL;
@@ -76,15 +80,14 @@ NcbiTaxonomy::NcbiTaxonomy(const std::string &namesFile, const std::string &node
 }
 
 NcbiTaxonomy::~NcbiTaxonomy() {
-    if (externalData) {
-        delete[] M;
-    } else {
+    if (externalData == false) {
         delete[] taxonNodes;
         delete[] H;
+        delete[] I;
         delete[] D;
         delete[] E;
         delete[] L;
-        deleteMatrix(M);
+        delete[] M;
     }
     delete block;
     if (mmapData != NULL) {
@@ -207,17 +210,17 @@ void NcbiTaxonomy::InitRangeMinimumQuery() {
     Debug(Debug::INFO) << "Init RMQ ...";
 
     for (unsigned int i = 0; i < (maxNodes * 2); ++i) {
-        M[i][0] = i;
+        M[i * matrixK] = i;
     }
 
     for (unsigned int j = 1; (1ul << j) <= (maxNodes * 2); ++j) {
         for (unsigned int i = 0; (i + (1ul << j) - 1) < (maxNodes * 2); ++i) {
-            int A = M[i][j - 1];
-            int B = M[i + (1ul << (j - 1))][j - 1];
+            int A = M[i * matrixK + j - 1];
+            int B = M[(i + (1ul << (j - 1))) * matrixK + j - 1];
             if (L[A] < L[B]) {
-                M[i][j] = A;
+                M[i * matrixK + j] = A;
             } else {
-                M[i][j] = B;
+                M[i * matrixK + j] = B;
             }
         }
     }
@@ -227,8 +230,8 @@ void NcbiTaxonomy::InitRangeMinimumQuery() {
 int NcbiTaxonomy::RangeMinimumQuery(int i, int j) const {
     assert(j >= i);
     int k = (int)MathUtil::flog2(j - i + 1);
-    int A = M[i][k];
-    int B = M[j - MathUtil::ipow<int>(2, k) + 1][k];
+    int A = M[i * matrixK + k];
+    int B = M[(j - MathUtil::ipow<int>(2, k) + 1) * matrixK + k];
     if (L[A] <= L[B]) {
         return A;
     }
@@ -273,7 +276,10 @@ bool NcbiTaxonomy::IsAncestor(TaxID ancestor, TaxID child) {
         return false;
     }
 
-    return lcaHelper(nodeId(child), nodeId(ancestor)) == nodeId(ancestor);
+    // the child is a descendant if the tour enters it while it is inside the subtree of the ancestor
+    const int *interval = I + 2 * D[ancestor];
+    const int entry = I[2 * D[child]];
+    return interval[0] <= entry && entry <= interval[1];
 }
 
 
@@ -703,9 +709,7 @@ WeightedTaxResult NcbiTaxonomy::weightedMajorityLCA(const std::vector<WeightedTa
 
 std::pair<char*, size_t> NcbiTaxonomy::serialize(const NcbiTaxonomy& t) {
     t.block->compact();
-    size_t matrixDim = (t.maxNodes * 2);
-    size_t matrixK = (int)(MathUtil::flog2(matrixDim)) + 1;
-    size_t matrixSize = matrixDim * matrixK * sizeof(int);
+    size_t matrixSize = (t.maxNodes * 2) * t.matrixK * sizeof(int);
     size_t blockSize = StringBlock<unsigned int>::memorySize(*t.block);
     size_t memSize = sizeof(int) // SERIALIZATION_VERSION
         + sizeof(size_t) // maxNodes
@@ -714,6 +718,7 @@ std::pair<char*, size_t> NcbiTaxonomy::serialize(const NcbiTaxonomy& t) {
         + (t.maxTaxID + 1) * sizeof(int) // D
         + 2 * (t.maxNodes * 2) * sizeof(int) // E,L
         + t.maxNodes * sizeof(int) // H
+        + (t.maxNodes * 2) * sizeof(int) // I
         + matrixSize // M
         + blockSize; // block
 
@@ -735,7 +740,9 @@ std::pair<char*, size_t> NcbiTaxonomy::serialize(const NcbiTaxonomy& t) {
     p += (t.maxNodes * 2) * sizeof(int);
     memcpy(p, t.H, t.maxNodes * sizeof(int));
     p += t.maxNodes * sizeof(int);
-    memcpy(p, t.M[0], matrixSize);
+    memcpy(p, t.I, (t.maxNodes * 2) * sizeof(int));
+    p += (t.maxNodes * 2) * sizeof(int);
+    memcpy(p, t.M, matrixSize);
     p += matrixSize;
     char* blockData = StringBlock<unsigned int>::serialize(*t.block);
     memcpy(p, blockData, blockSize);
@@ -765,15 +772,12 @@ NcbiTaxonomy* NcbiTaxonomy::unserialize(char* mem) {
     p += (maxNodes * 2) * sizeof(int);
     int* H = (int*)p;
     p += maxNodes * sizeof(int);
-    size_t matrixDim = (maxNodes * 2);
-    size_t matrixK = (int)(MathUtil::flog2(matrixDim)) + 1;
-    size_t matrixSize = matrixDim * matrixK * sizeof(int);
-    int** M = new int*[matrixDim];
-    M[0] = (int*)p;
-    for(size_t i = 1; i < matrixDim; i++) {
-        M[i] = M[i-1] + matrixK;
-    }
-    p += matrixSize;
+    int* I = (int*)p;
+    p += (maxNodes * 2) * sizeof(int);
+    // the sparse table is used in place, no row pointers are allocated
+    size_t matrixK = matrixColumns(maxNodes);
+    int* M = (int*)p;
+    p += (maxNodes * 2) * matrixK * sizeof(int);
     StringBlock<unsigned int>* block = StringBlock<unsigned int>::unserialize(p);
-    return new NcbiTaxonomy(taxonNodes, maxNodes, maxTaxID, D, E, L, H, M, block);
+    return new NcbiTaxonomy(taxonNodes, maxNodes, maxTaxID, D, E, L, H, I, M, matrixK, block);
 }
@@ -12,6 +12,330 @@
 #include "KSeqWrapper.h"
 #include "itoa.h"
 
+#include <algorithm>
+#include <sys/stat.h>
+
+enum {
+    PARALLEL_READ_OK,
+    PARALLEL_READ_UNSPLITTABLE,
+    PARALLEL_READ_MULTILINE
+};
+
+// number of records ('>' at a line start) in data[start, end), start is a file start or follows a newline
+static size_t countFastaRecords(const char *data, size_t start, size_t end) {
+    size_t count = (start < end && data[start] == '>') ? 1 : 0;
+    const char *pos = data + start;
+    const char *last = data + end;
+    while ((pos = static_cast<const char *>(memchr(pos, '\n', last - pos))) != NULL) {
+        pos++;
+        count += (pos < last && *pos == '>') ? 1 : 0;
+    }
+    return count;
+}
+
+// part of the lookup of a range that belongs to one shuffle split, stored in the lookup file of the range
+struct LookupChunk {
+    unsigned int split;
+    size_t offset;
+    size_t length;
+};
+
+static void writeLookupChunk(FILE *file, const std::string &lookupFile, std::vector<LookupChunk> &chunks, unsigned int split, std::string &buffer) {
+    if (buffer.empty()) {
+        return;
+    }
+    LookupChunk chunk = { split, static_cast<size_t>(ftell(file)), buffer.size() };
+    size_t written = fwrite(buffer.c_str(), sizeof(char), buffer.size(), file);
+    if (written != buffer.size()) {
+        Debug(Debug::ERROR) << "Cannot write to lookup file " << lookupFile << "\n";
+        EXIT(EXIT_FAILURE);
+    }
+    chunks.emplace_back(chunk);
+    buffer.clear();
+}
+
+// Reads uncompressed fasta files with all threads. The concatenated files are split into one byte range per thread,
+// each range starts at a record or a file start. A first pass counts the records of each range and the prefix sums
+// give the keys, so the database does not depend on the number of threads. The second pass parses the ranges
+// with KSeqBuffer and writes the entries and the lookup of range i to thread file i, the files are merged in order.
+// With shuffleSplits > 1 the keys are the ones createRenumberedDB assigns after the serial reader.
+// Input that kseq reads differently than the record count (fastq, a line starting with '@') is UNSPLITTABLE.
+static int readFastaParallel(Parameters &par, const std::vector<std::string> &filenames, int dbType, unsigned int shuffleSplits,
+                             DBWriter &hdrWriter, DBWriter &seqWriter, const std::string &lookupFile,
+                             Debug::Progress &progress, unsigned int &entries_num, size_t &sampleCount, size_t &isNuclCnt) {
+    const size_t fileCount = filenames.size();
+    std::vector<char *> data(fileCount, NULL);
+    // also the offset of a file in the soft linked data files
+    std::vector<size_t> fileStart(fileCount + 1, 0);
+    for (size_t fileIdx = 0; fileIdx < fileCount; fileIdx++) {
+        size_t fileSize = FileUtil::getFileSize(filenames[fileIdx]);
+        if (fileSize > 0) {
+            FILE *file = FileUtil::openFileOrDie(filenames[fileIdx].c_str(), "r", true);
+            data[fileIdx] = static_cast<char *>(FileUtil::mmapFile(file, &fileSize));
+            if (fclose(file) != 0) {
+                Debug(Debug::ERROR) << "Cannot close file " << filenames[fileIdx] << "\n";
+                EXIT(EXIT_FAILURE);
+            }
+        }
+        fileStart[fileIdx + 1] = fileStart[fileIdx] + fileSize;
+    }
+
+    const size_t rangeCount = par.threads;
+    const size_t totalSize = fileStart[fileCount];
+    std::vector<size_t> rangeStart(rangeCount + 1, totalSize);
+    rangeStart[0] = 0;
+    for (size_t range = 1; range < rangeCount; range++) {
+        size_t pos = std::max(totalSize / rangeCount * range, rangeStart[range - 1]);
+        size_t fileIdx = std::upper_bound(fileStart.begin(), fileStart.end(), pos) - fileStart.begin() - 1;
+        if (fileIdx < fileCount && pos > fileStart[fileIdx]) {
+            // move to the next record, or to the end of the file
+            const char *fileData = data[fileIdx];
+            const char *fileEnd = fileData + (fileStart[fileIdx + 1] - fileStart[fileIdx]);
+            const char *newline = fileData + (pos - fileStart[fileIdx]) - 1;
+            pos = fileStart[fileIdx + 1];
+            while ((newline = static_cast<const char *>(memchr(newline, '\n', fileEnd - newline))) != NULL) {
+                if (newline + 1 < fileEnd && newline[1] == '>') {
+                    pos = fileStart[fileIdx] + (newline + 1 - fileData);
+                    break;
+                }
+                newline++;
+            }
+        }
+        rangeStart[range] = pos;
+    }
+
+    // rangeEntries[range] is the index of the first entry of range after the prefix sum
+    std::vector<size_t> rangeEntries(rangeCount + 1, 0);
+#pragma omp parallel for schedule(dynamic, 1)
+    for (size_t range = 0; range < rangeCount; range++) {
+        for (size_t fileIdx = 0; fileIdx < fileCount; fileIdx++) {
+            const size_t start = std::max(rangeStart[range], fileStart[fileIdx]);
+            const size_t end = std::min(rangeStart[range + 1], fileStart[fileIdx + 1]);
+            if (start < end) {
+                rangeEntries[range + 1] += countFastaRecords(data[fileIdx], start - fileStart[fileIdx], end - fileStart[fileIdx]);
+            }
+        }
+    }
+    for (size_t range = 0; range < rangeCount; range++) {
+        rangeEntries[range + 1] += rangeEntries[range];
+    }
+
+    // the serial reader writes entry i to split (offset + i) % shuffleSplits and numbers the merged splits from 0
+    const size_t totalEntries = rangeEntries[rangeCount];
+    std::vector<size_t> splitFirstEntry(shuffleSplits, 0);
+    std::vector<size_t> splitFirstKey(shuffleSplits + 1, 0);
+    for (unsigned int split = 0; split < shuffleSplits; split++) {
+        splitFirstEntry[split] = (split + shuffleSplits - par.identifierOffset % shuffleSplits) % shuffleSplits;
+        const size_t splitEntries = (totalEntries > splitFirstEntry[split]) ? (totalEntries - splitFirstEntry[split] - 1) / shuffleSplits + 1 : 0;
+        splitFirstKey[split + 1] = splitFirstKey[split] + splitEntries;
+    }
+
+    std::vector<FILE *> lookupFiles(rangeCount, NULL);
+    std::vector<std::vector<LookupChunk>> lookupChunks(rangeCount);
+    if (par.writeLookup == true) {
+        for (size_t range = 0; range < rangeCount; range++) {
+            lookupFiles[range] = FileUtil::openAndDelete((lookupFile + "." + SSTR(range)).c_str(), "w+");
+        }
+    }
+
+    const char newline = '\n';
+    std::vector<int> rangeStatus(rangeCount, PARALLEL_READ_OK);
+    // first entry that is not a single line entry and its newline count
+    std::vector<size_t> rangeMultiline(rangeCount, SIZE_MAX);
+    std::vector<int> rangeNewlineCount(rangeCount, 1);
+    std::vector<size_t> rangeNuclCnt(rangeCount, 0);
+    std::vector<size_t> rangeSampleCount(rangeCount, 0);
+#pragma omp parallel for schedule(dynamic, 1)
+    for (size_t range = 0; range < rangeCount; range++) {
+        const unsigned int thread = static_cast<unsigned int>(range);
+        std::string header;
+        header.reserve(1024);
+        std::vector<std::string> lookupBuffers(shuffleSplits);
+        DBReader<unsigned int>::LookupEntry entry;
+        size_t entryIdx = rangeEntries[range];
+        for (size_t fileIdx = 0; fileIdx < fileCount && rangeStatus[range] == PARALLEL_READ_OK; fileIdx++) {
+            const size_t start = std::max(rangeStart[range], fileStart[fileIdx]);
+            const size_t end = std::min(rangeStart[range + 1], fileStart[fileIdx + 1]);
+            if (start >= end) {
+                continue;
+            }
+            const char *rangeData = data[fileIdx] + (start - fileStart[fileIdx]);
+            KSeqBuffer kseq(rangeData, end - start);
+            while (kseq.ReadEntry()) {
+                const KSeqWrapper::KSeqEntry &e = kseq.entry;
+                if (entryIdx >= rangeEntries[range + 1] || e.qual.l > 0) {
+                    rangeStatus[range] = PARALLEL_READ_UNSPLITTABLE;
+                    break;
+                }
+                progress.updateProgress();
+                if (e.name.l == 0) {
+                    Debug(Debug::ERROR) << "Fasta entry " << entryIdx << " is invalid\n";
+                    EXIT(EXIT_FAILURE);
+                }
+
+                std::string headerId;
+                if (par.createdbMode == Parameters::SEQUENCE_SPLIT_MODE_HARD) {
+                    header.append(e.name.s, e.name.l);
+                    if (e.comment.l > 0) {
+                        header.append(" ", 1);
+                        header.append(e.comment.s, e.comment.l);
+                    }
+                    headerId = Util::parseFastaHeader(header.c_str());
+                    header.push_back('\n');
+                } else if (par.writeLookup == true) {
+                    headerId = Util::parseFastaHeader(rangeData + e.headerOffset);
+                }
+                if (headerId.empty() && (par.createdbMode == Parameters::SEQUENCE_SPLIT_MODE_HARD || par.writeLookup == true)) {
+                    Debug(Debug::WARNING) << "Cannot extract identifier from entry " << entryIdx << "\n";
+                }
+
+                unsigned int id = par.identifierOffset + entryIdx;
+                const unsigned int splitIdx = id % shuffleSplits;
+                size_t lookupId = entryIdx;
+                if (shuffleSplits > 1) {
+                    lookupId = splitFirstKey[splitIdx] + (entryIdx - splitFirstEntry[splitIdx]) / shuffleSplits;
+                    id = lookupId;
+                }
+                if (dbType == -1) {
+                    // same sample as the serial reader, the first 10 sequences
+                    if (entryIdx < 10) {
+                        size_t cnt = 0;
+                        for (size_t i = 0; i < e.sequence.l; i++) {
+                            switch (toupper(e.sequence.s[i])) {
+                                case 'T':
+                                case 'A':
+                                case 'G':
+                                case 'C':
+                                case 'U':
+                                case 'N':
+                                    cnt++;
+                                    break;
+                            }
+                        }
+                        const float nuclDNAFraction = static_cast<float>(cnt) / static_cast<float>(e.sequence.l);
+                        if (nuclDNAFraction > 0.9) {
+                            rangeNuclCnt[range]++;
+                        }
+                        rangeSampleCount[range]++;
+                    }
+                    if (par.createdbMode == Parameters::SEQUENCE_SPLIT_MODE_SOFT && e.newlineCount != 1) {
+                        rangeStatus[range] = PARALLEL_READ_MULTILINE;
+                        rangeMultiline[range] = entryIdx;
+                        rangeNewlineCount[range] = e.newlineCount;
+                        break;
+                    }
+                }
+
+                if (par.createdbMode == Parameters::SEQUENCE_SPLIT_MODE_SOFT) {
+                    const size_t offset = fileStart[fileIdx] + (rangeData - data[fileIdx]);
+                    hdrWriter.writeIndexEntry(id, offset + e.headerOffset, (e.sequenceOffset-e.headerOffset)+1, thread);
+                    seqWriter.writeIndexEntry(id, offset + e.sequenceOffset, e.sequence.l+2, thread);
+                } else {
+                    hdrWriter.writeData(header.c_str(), header.length(), id, thread);
+                    seqWriter.writeStart(thread);
+                    seqWriter.writeAdd(e.sequence.s, e.sequence.l, thread);
+                    seqWriter.writeAdd(&newline, 1, thread);
+                    seqWriter.writeEnd(id, thread, true);
+                }
+
+                if (par.writeLookup == true) {
+                    entry.id = lookupId;
+                    entry.entryName = headerId;
+                    entry.fileNumber = fileIdx;
+                    DBReader<unsigned int>::lookupEntryToBuffer(lookupBuffers[splitIdx], entry);
+                    if (lookupBuffers[splitIdx].size() > 1024 * 1024) {
+                        writeLookupChunk(lookupFiles[range], lookupFile, lookupChunks[range], splitIdx, lookupBuffers[splitIdx]);
+                    }
+                }
+                entryIdx++;
+                header.clear();
+            }
+        }
+        if (rangeStatus[range] == PARALLEL_READ_OK && entryIdx != rangeEntries[range + 1]) {
+            rangeStatus[range] = PARALLEL_READ_UNSPLITTABLE;
+        }
+        if (par.writeLookup == true) {
+            for (unsigned int split = 0; split < shuffleSplits; split++) {
+                writeLookupChunk(lookupFiles[range], lookupFile, lookupChunks[range], split, lookupBuffers[split]);
+            }
+        }
+    }
+
+    for (size_t fileIdx = 0; fileIdx < fileCount; fileIdx++) {
+        if (data[fileIdx] != NULL) {
+            FileUtil::munmapData(data[fileIdx], fileStart[fileIdx + 1] - fileStart[fileIdx]);
+        }
+    }
+
+    int status = PARALLEL_READ_OK;
+    size_t multiline = SIZE_MAX;
+    int newlineCount = 1;
+    for (size_t range = 0; range < rangeCount; range++) {
+        if (rangeStatus[range] == PARALLEL_READ_UNSPLITTABLE) {
+            status = PARALLEL_READ_UNSPLITTABLE;
+        } else if (rangeStatus[range] == PARALLEL_READ_MULTILINE && rangeMultiline[range] < multiline) {
+            multiline = rangeMultiline[range];
+            newlineCount = rangeNewlineCount[range];
+        }
+    }
+    if (status == PARALLEL_READ_OK && multiline != SIZE_MAX) {
+        status = PARALLEL_READ_MULTILINE;
+        if (newlineCount == 0) {
+            Debug(Debug::WARNING) << "Fasta entry " << multiline << " has no newline character\n";
+        } else if (newlineCount > 1) {
+            Debug(Debug::WARNING) << "Multiline fasta can not be combined with --createdb-mode 0\n";
+        }
+    }
+
+    if (par.writeLookup == true) {
+        // the lookup is ordered by key, split by split and within a split by range
+        FILE *file = (status == PARALLEL_READ_OK) ? FileUtil::openAndDelete(lookupFile.c_str(), "w") : NULL;
+        std::vector<char> buffer(1024 * 1024 + 1);
+        for (unsigned int split = 0; split < shuffleSplits && file != NULL; split++) {
+            for (size_t range = 0; range < rangeCount; range++) {
+                for (size_t i = 0; i < lookupChunks[range].size(); i++) {
+                    const LookupChunk &chunk = lookupChunks[range][i];
+                    if (chunk.split != split) {
+                        continue;
+                    }
+                    if (buffer.size() < chunk.length) {
+                        buffer.resize(chunk.length);
+                    }
+                    if (fseek(lookupFiles[range], chunk.offset, SEEK_SET) != 0
+                        || fread(buffer.data(), sizeof(char), chunk.length, lookupFiles[range]) != chunk.length) {
+                        Debug(Debug::ERROR) << "Cannot read from lookup file " << lookupFile << "." << range << "\n";
+                        EXIT(EXIT_FAILURE);
+                    }
+                    if (fwrite(buffer.data(), sizeof(char), chunk.length, file) != chunk.length) {
+                        Debug(Debug::ERROR) << "Cannot write to lookup file " << lookupFile << "\n";
+                        EXIT(EXIT_FAILURE);
+                    }
+                }
+            }
+        }
+        if (file != NULL && fclose(file) != 0) {
+            Debug(Debug::ERROR) << "Cannot close file " << lookupFile << "\n";
+            EXIT(EXIT_FAILURE);
+        }
+        for (size_t range = 0; range < rangeCount; range++) {
+            if (fclose(lookupFiles[range]) != 0) {
+                Debug(Debug::ERROR) << "Cannot close file " << lookupFile << "." << range << "\n";
+                EXIT(EXIT_FAILURE);
+            }
+            FileUtil::remove((lookupFile + "." + SSTR(range)).c_str());
+        }
+    }
+
+    if (status == PARALLEL_READ_OK) {
+        entries_num += totalEntries;
+        for (size_t range = 0; range < rangeCount; range++) {
+            isNuclCnt += rangeNuclCnt[range];
+            sampleCount += rangeSampleCount[range];
+        }
+    }
+    return status;
+}
+
 int createdb(int argc, const char **argv, const Command& command) {
     Parameters &par = Parameters::getInstance();
     par.parseParameters(argc, argv, command, true, Parameters::PARSE_VARIADIC, 0);
@@ -82,16 +406,29 @@ int createdb(int argc, const char **argv, const Command& command) {
     Debug(Debug::INFO) << "Converting sequences\n";
 
     std::string sourceFile = dataFile + ".source";
+    std::string lookupFile = dataFile + ".lookup";
+
+    // uncompressed files are split into ranges that are read by all threads, pipes and FIFOs are streamed
+    bool parallelInput = dbInput == false && par.threads > 1;
+    for (size_t i = 0; i < filenames.size(); i++) {
+        struct stat st;
+        parallelInput &= filenames[i] != "stdin" && Util::endsWith(".gz", filenames[i]) == false && Util::endsWith(".bz2", filenames[i]) == false
+                         && stat(filenames[i].c_str(), &st) == 0 && S_ISREG(st.st_mode);
+    }
 
     redoComputation:
+    entries_num = 0;
+    sampleCount = 0;
+    isNuclCnt = 0;
     FILE *source = fopen(sourceFile.c_str(), "w");
     if (source == NULL) {
         Debug(Debug::ERROR) << "Cannot open " << sourceFile << " for writing\n";
         EXIT(EXIT_FAILURE);
     }
-    DBWriter hdrWriter(hdrDataFile.c_str(), hdrIndexFile.c_str(), shuffleSplits, par.compressed, Parameters::DBTYPE_GENERIC_DB);
+    const unsigned int writerThreads = parallelInput ? par.threads : shuffleSplits;
+    DBWriter hdrWriter(hdrDataFile.c_str(), hdrIndexFile.c_str(), writerThreads, par.compressed, Parameters::DBTYPE_GENERIC_DB);
     hdrWriter.open();
-    DBWriter seqWriter(dataFile.c_str(), indexFile.c_str(), shuffleSplits, par.compressed, (dbType == -1) ? Parameters::DBTYPE_OMIT_FILE : dbType );
+    DBWriter seqWriter(dataFile.c_str(), indexFile.c_str(), writerThreads, par.compressed, (dbType == -1) ? Parameters::DBTYPE_OMIT_FILE : dbType );
     seqWriter.open();
     size_t headerFileOffset = 0;
     size_t seqFileOffset = 0;
@@ -180,6 +517,11 @@ int createdb(int argc, const char **argv, const Command& command) {
             }
             goto redoComputation;
         }
+        if (parallelInput) {
+            // the entries of all files are read after the source file is written
+            delete kseq;
+            continue;
+        }
         while (kseq->ReadEntry()) {
             progress.updateProgress();
             const KSeqWrapper::KSeqEntry &e = kseq->entry;
@@ -279,13 +621,36 @@ int createdb(int argc, const char **argv, const Command& command) {
             seqFileOffset += fileSize;
         }
     }
+    if (parallelInput) {
+        int status = readFastaParallel(par, filenames, dbType, shuffleSplits, hdrWriter, seqWriter, lookupFile, progress, entries_num, sampleCount, isNuclCnt);
+        if (status != PARALLEL_READ_OK) {
+            if (status == PARALLEL_READ_UNSPLITTABLE) {
+                Debug(Debug::WARNING) << "Input cannot be split at fasta records. We recompute with a single thread\n";
+                parallelInput = false;
+            } else {
+                Debug(Debug::WARNING) << "We recompute with --createdb-mode 1\n";
+                par.createdbMode = Parameters::SEQUENCE_SPLIT_MODE_HARD;
+            }
+            progress.reset(SIZE_MAX);
+            // merging removes the thread files, the single threaded reader writes fewer
+            hdrWriter.close(true, false);
+            seqWriter.close(true, false);
+            if (fclose(source) != 0) {
+                Debug(Debug::ERROR) << "Cannot close file " << sourceFile << "\n";
+                EXIT(EXIT_FAILURE);
+            }
+            goto redoComputation;
+        }
+    }
     Debug(Debug::INFO) << "\n";
     if (fclose(source) != 0) {
         Debug(Debug::ERROR) << "Cannot close file " << sourceFile << "\n";
         EXIT(EXIT_FAILURE);
     }
-    hdrWriter.close(true, false);
-    seqWriter.close(true, false);
+    // the parallel reader writes the shuffled keys in input order
+    const bool needsSort = parallelInput && par.shuffleDatabase;
+    hdrWriter.close(true, needsSort);
+    seqWriter.close(true, needsSort);
     if (dbType == -1) {
         if (isNuclCnt == sampleCount) {
             dbType = Parameters::DBTYPE_NUCLEOTIDES;
@@ -310,7 +675,7 @@ int createdb(int argc, const char **argv, const Command& command) {
     }
 
     // fix ids
-    if (par.shuffleDatabase == true) {
+    if (par.shuffleDatabase == true && parallelInput == false) {
         DBWriter::createRenumberedDB(dataFile, indexFile, "", "", DBReader<unsigned int>::LINEAR_ACCCESS);
         DBWriter::createRenumberedDB(hdrDataFile, hdrIndexFile, "", "", DBReader<unsigned int>::LINEAR_ACCCESS);
     }
@@ -326,11 +691,10 @@ int createdb(int argc, const char **argv, const Command& command) {
         }
     }
 
-    if (par.writeLookup == true) {
+    if (par.writeLookup == true && parallelInput == false) {
         DBReader<unsigned int> readerHeader(hdrDataFile.c_str(), hdrIndexFile.c_str(), 1, DBReader<unsigned int>::USE_DATA | DBReader<unsigned int>::USE_INDEX);
         readerHeader.open(DBReader<unsigned int>::NOSORT);
         // create lookup file
-        std::string lookupFile = dataFile + ".lookup";
         FILE* file = FileUtil::openAndDelete(lookupFile.c_str(), "w");
         std::string buffer;
         buffer.reserve(2048);
@@ -3,6 +3,9 @@
 #include "DBWriter.h"
 #include "Util.h"
 #include "Debug.h"
+#include "itoa.h"
+
+#include <algorithm>
 
 #ifdef OPENMP
 #include <omp.h>
@@ -30,46 +33,68 @@ const bool tsvOut, const std::string &mappingFile, const std::string &userStrToA
         doMapping = true;
     }
 
+    // every thread writes a contiguous range of entries of about the same size. The thread files are
+    // concatenated in thread order when the writer is closed, so the output keeps the order of the input
+    std::vector<size_t> entryOffsets(entries + 1, 0);
+    for (size_t i = 0; i < entries; ++i) {
+        entryOffsets[i + 1] = entryOffsets[i] + reader.getEntryLen(i);
+    }
+    const size_t totalSize = entryOffsets[entries];
+
 #pragma omp parallel
     {
         unsigned int thread_idx = 0;
+        unsigned int threadCount = 1;
 #ifdef OPENMP
         thread_idx = static_cast<unsigned int>(omp_get_thread_num());
+        threadCount = static_cast<unsigned int>(omp_get_num_threads());
 #endif
+        const size_t from = std::lower_bound(entryOffsets.begin(), entryOffsets.end() - 1, (totalSize * thread_idx) / threadCount) - entryOffsets.begin();
+        const size_t to = std::lower_bound(entryOffsets.begin(), entryOffsets.end() - 1, (totalSize * (thread_idx + 1)) / threadCount) - entryOffsets.begin();
 
-#pragma omp for schedule(dynamic, 100)
-        for (size_t i = 0; i < entries; ++i) {
+        char keyBuffer[32];
+        std::string strToAdd = userStrToAdd;
+        std::string result;
+        result.reserve(1024 * 1024);
+        for (size_t i = from; i < to; ++i) {
             progress.updateProgress();
 
             unsigned int key = reader.getDbKey(i);
-            std::istringstream data(reader.getData(i, thread_idx));
-            std::ostringstream ss;
-
-            std::string line;
-            while (std::getline(data, line)) {
-                std::string strToAdd = "";
-                if (userStrToAdd != "") {
-                    strToAdd = userStrToAdd;
-                } else if (doMapping) {
-                    size_t lookupId = lookupReader->getLookupIdByKey(key);
-                    if (lookupId == SIZE_MAX) {
-                        Debug(Debug::ERROR) << "Could not find key " << key << " in lookup\n";
-                        EXIT(EXIT_FAILURE);
-                    }
-                    strToAdd = lookupReader->getLookupEntryName(lookupId);
-                } else {
-                    strToAdd = SSTR(key);
+            // a user string is the same for all entries
+            if (userStrToAdd.empty() && doMapping) {
+                size_t lookupId = lookupReader->getLookupIdByKey(key);
+                if (lookupId == SIZE_MAX) {
+                    Debug(Debug::ERROR) << "Could not find key " << key << " in lookup\n";
+                    EXIT(EXIT_FAILURE);
                 }
+                strToAdd = lookupReader->getLookupEntryName(lookupId);
+            } else if (userStrToAdd.empty()) {
+                char *end = Itoa::u32toa_sse2(key, keyBuffer);
+                strToAdd.assign(keyBuffer, end - keyBuffer - 1);
+            }
 
+            const char *data = reader.getData(i, thread_idx);
+            const char *dataEnd = data + strlen(data);
+            while (data < dataEnd) {
+                const char *lineEnd = static_cast<const char *>(memchr(data, '\n', dataEnd - data));
+                if (lineEnd == NULL) {
+                    lineEnd = dataEnd;
+                }
                 if (isPrefix) {
-                    ss << strToAdd << "\t" << line << "\n";
+                    result.append(strToAdd);
+                    result.push_back('\t');
+                    result.append(data, lineEnd - data);
                 } else {
-                    ss << line << "\t" << strToAdd << "\n";
+                    result.append(data, lineEnd - data);
+                    result.push_back('\t');
+                    result.append(strToAdd);
                 }
+                result.push_back('\n');
+                data = lineEnd + 1;
             }
 
-            std::string result = ss.str();
             writer.writeData(result.c_str(), result.length(), key, thread_idx, shouldWriteNullByte);
+            result.clear();
         }
     }
     writer.close(tsvOut);
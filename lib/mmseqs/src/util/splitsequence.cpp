@@ -4,6 +4,7 @@
 #include "DBWriter.h"
 #include "Matcher.h"
 #include "Util.h"
+#include "FileUtil.h"
 #include "itoa.h"
 
 #include "Orf.h"
@@ -21,6 +22,11 @@ int splitsequence(int argc, const char **argv, const Command& command) {
     par.maxSeqLen = 10000;
     par.sequenceOverlap = 300;
     par.parseParameters(argc, argv, command, true, 0, 0);
+    // soft split entries point into the data of the input, compressed and packed entries can not be cut
+    if (par.sequenceSplitMode == Parameters::SEQUENCE_SPLIT_MODE_SOFT && DBReader<unsigned int>::isCompressed(FileUtil::parseDbType(par.db1.c_str()))) {
+        Debug(Debug::WARNING) << "Sequence split mode (--sequence-split-mode 1) can not be used with a compressed input database.\nTurn sequence split mode to 0\n";
+        par.sequenceSplitMode = Parameters::SEQUENCE_SPLIT_MODE_HARD;
+    }
     int mode = DBReader<unsigned int>::USE_INDEX;
     if (par.sequenceSplitMode == Parameters::SEQUENCE_SPLIT_MODE_HARD) {
         mode |= DBReader<unsigned int>::USE_DATA;
@@ -47,7 +53,9 @@ int splitsequence(int argc, const char **argv, const Command& command) {
         par.compressed = 0;
     }
 
-    DBWriter sequenceWriter(par.db2.c_str(), par.db2Index.c_str(), par.threads, par.compressed, reader.getDbtype());
+    // hard split entries are written decoded, a packed input gives a plain output
+    const int outputDbtype = reader.getDbtype() & ~(static_cast<int>(Parameters::DBTYPE_EXTENDED_NUCL_PACKED) << 16);
+    DBWriter sequenceWriter(par.db2.c_str(), par.db2Index.c_str(), par.threads, par.compressed, outputDbtype);
     sequenceWriter.open();
 
     DBWriter headerWriter(par.hdr2.c_str(), par.hdr2Index.c_str(), par.threads, false, Parameters::DBTYPE_GENERIC_DB);
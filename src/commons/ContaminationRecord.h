@@ -0,0 +1,65 @@
+#ifndef CONTERMINATOR_CONTAMINATIONRECORD_H
+#define CONTERMINATOR_CONTAMINATIONRECORD_H
+
+#include "DBReader.h"
+#include "NcbiTaxonomy.h"
+#include "Util.h"
+#include "itoa.h"
+#include <string>
+
+// Binary record of createallreport, an entry of the report DB is an array of these records.
+// predictcontamination reads them without parsing, convertallreport renders them as TSV:
+// fastaId start end nLen entryLen termId speciesName
+struct __attribute__((__packed__)) ContaminationRecord {
+    unsigned int dbKey;
+    int start;
+    int end;
+    // length of the contig between the closest N runs
+    int nLen;
+    int entryLen;
+    int termId;
+    int taxId;
+
+    ContaminationRecord() {}
+    ContaminationRecord(unsigned int dbKey, int start, int end, int nLen, int entryLen, int termId, int taxId)
+            : dbKey(dbKey), start(start), end(end), nLen(nLen), entryLen(entryLen), termId(termId), taxId(taxId) {}
+
+    // DBWriter adds a null byte to every entry
+    static size_t getRecordCount(size_t entryLen) {
+        return entryLen / sizeof(ContaminationRecord);
+    }
+
+    static const char *getSpeciesName(NcbiTaxonomy &t, int taxId) {
+        const TaxonNode *node = t.taxonNode(taxId, false);
+        return (node == NULL) ? "Undef" : t.getString(node->nameIdx);
+    }
+
+    static void appendFastaId(std::string &out, DBReader<unsigned int> &header, unsigned int dbKey, unsigned int thread_idx) {
+        out.append(Util::parseFastaHeader(header.getDataByDBKey(dbKey, thread_idx)));
+    }
+
+    static void appendInt(std::string &out, int value) {
+        char buffer[16];
+        char *end = Itoa::i32toa_sse2(value, buffer);
+        out.append(buffer, end - buffer - 1);
+    }
+
+    void appendTsv(std::string &out, DBReader<unsigned int> &header, NcbiTaxonomy &t, unsigned int thread_idx) const {
+        appendFastaId(out, header, dbKey, thread_idx);
+        out.push_back('\t');
+        appendInt(out, start);
+        out.push_back('\t');
+        appendInt(out, end);
+        out.push_back('\t');
+        appendInt(out, nLen);
+        out.push_back('\t');
+        appendInt(out, entryLen);
+        out.push_back('\t');
+        appendInt(out, termId);
+        out.push_back('\t');
+        out.append(getSpeciesName(t, taxId));
+        out.push_back('\n');
+    }
+};
+
+#endif //CONTERMINATOR_CONTAMINATIONRECORD_H
@@ -5,12 +5,15 @@
 #ifndef CONTERMINATOR_INTERVALARRAY_H
 #define CONTERMINATOR_INTERVALARRAY_H
 
-#include "MathUtil.h"
 #include <utility>
-#include <list>
+#include <vector>
+#include <algorithm>
 #include <iostream>
-#include <string.h>
 
+// Union of closed integer intervals.
+// Inserted intervals are collected unsorted and merged by a sort + sweep, so the cost
+// depends on the number of inserted intervals and not on the highest coordinate.
+// Overlapping and adjacent intervals are merged ([1,3] and [4,6] become [1,6]).
 class IntervalArray {
 
 public:
@@ -32,92 +35,29 @@ public:
         }
 
     };
-    IntervalArray(){
-        const int size = 1;
-        array=(unsigned char *)calloc(size, sizeof(unsigned char));
-        arraySizeInBytes = size;
-        maxSizeInByte = size*8;
-    }
-
 
-    ~IntervalArray(){
-        free(array);
-        array = NULL;
-    }
+    IntervalArray() : merged(true) {}
 
     void reset(){
-        int ceilMax = MathUtil::ceilIntDivision(std::max(1,maxSizeInByte), 8);
-        memset(array, 0, ceilMax * sizeof(unsigned char));
+        intervals.clear();
         ranges.clear();
-        maxSizeInByte = 0;
-    }
-
-    unsigned char getLowMask(unsigned int rest) {
-        const unsigned char mask[8] = {0xFF, 0xFE, 0xFC, 0xF8, 0xF0, 0xE0, 0xC0,0x80};
-        return mask[rest];
+        merged = true;
     }
 
-
-    unsigned char getHighRest(unsigned int rest) {
-        const unsigned char mask[8] = { 0xFF, 0x7F, 0x3F, 0x1F, 0x0F,0x07, 0x03, 0x01};
-        return mask[rest];
-    }
-
-
     void insert(int low, int high){
         if(low > high){
             std::swap(low, high);
         }
-        //insert(array, low, high);
-        maxSizeInByte = std::max(high+1, maxSizeInByte + 1);
-        int ceilMax = MathUtil::ceilIntDivision(maxSizeInByte, 8);
-        if(ceilMax >= arraySizeInBytes){
-            int prevSize = arraySizeInBytes;
-            arraySizeInBytes = std::max(arraySizeInBytes * 2, ceilMax+1);
-            array = (unsigned char *) realloc(array,  arraySizeInBytes);
-            memset(array+prevSize, 0,  arraySizeInBytes-prevSize);
-        }
-        bool lowFound = isSet(low);
-        bool highFound =  isSet(high);;
-        if((lowFound == true && highFound == true)){
-            return;
-        }
-        unsigned int startPos=low/8;
-        unsigned int startRest=low%8;
-        unsigned int endPos=high/8;
-        unsigned int endRest=high%8;
-        for(size_t pos = startPos+1; pos < endPos; pos++ ){
-            array[pos] = 0xFF;
-        }
-        unsigned char lowMask = getLowMask(startRest);
-        unsigned char highMask = getHighRest(7-endRest);
-        if(startPos == endPos){
-            array[startPos] |= lowMask & highMask;
-        }else{
-            array[startPos] |= lowMask;
-            array[endPos] |= highMask;
-        }
+        intervals.emplace_back(low, high);
+        merged = false;
     }
 
     void buildRanges(){
-        bool started = false;
-        unsigned int startPos = 0;
-        unsigned int endPos = 0;
-        unsigned int index = 0;
-        for(int pos = 0; pos <= maxSizeInByte; pos++){
-            if(isSet(pos)  && started == false){
-                started = true;
-                startPos = pos;
-            }
-            if(isSet(pos)==false && started== true){
-                started = false;
-                endPos = pos;
-                ranges.push_back(Range(index, startPos, endPos-1));
-                index++;
-            }
-        }
-        if(started==true){
-            ranges.push_back(Range(index, startPos, maxSizeInByte-1));
+        merge();
+        ranges.clear();
+        ranges.reserve(intervals.size());
+        for(size_t i = 0; i < intervals.size(); i++){
+            ranges.push_back(Range(i, intervals[i].first, intervals[i].second));
         }
     }
 
@@ -170,65 +110,22 @@ public:
         if(low > high){
             std::swap(low, high);
         }
-        bool lowFound;
-        if(low >= maxSizeInByte){
-            return false;
-        }else{
-            lowFound = isSet(low);
-        }
-        bool highFound;
-        if(high >= maxSizeInByte){
-            highFound = false;
-        }else{
-            highFound = isSet(high);;
-        }
-        if(lowFound || highFound){
-            return true;
-        }
-        // check if interval is contained in low, high
-        high = std::min(high, maxSizeInByte);
-        unsigned int startPos=low/8;
-        unsigned int startRest=low%8;
-        unsigned int endPos=high/8;
-        unsigned int endRest=high%8;
-        int foundOverlap = 0;
-        for(size_t pos = startPos+1; pos < endPos && foundOverlap == 0; pos++ ){
-            foundOverlap += (array[pos]>0);
-        }
-        unsigned char lowMask = getLowMask(startRest);
-        unsigned char highMask = getHighRest(7-endRest);
-        if(startPos == endPos){
-            foundOverlap += (array[startPos] & lowMask & highMask);
-        }else{
-            foundOverlap += array[startPos] & lowMask;
-            foundOverlap += array[endPos] & highMask;
-        }
-        return (foundOverlap==0)? false : true;
+        merge();
+        // first interval that ends at or after low
+        std::vector<std::pair<int, int>>::const_iterator it =
+                std::lower_bound(intervals.begin(), intervals.end(), low, compareEndToValue);
+        return it != intervals.end() && it->first <= high;
     }
 
     bool isSet(int pos){
-        unsigned int posIdx = pos/8;
-        unsigned int posRest= pos%8;
-        unsigned char value = array[posIdx];
-        unsigned char check = (1U << posRest);
-        return check & value;
+        return doesOverlap(pos, pos);
     }
 
 
     void print(){
-        bool started = false;
-        for(int pos = 0; pos < maxSizeInByte; pos++){
-            if(isSet(pos)  && started == false){
-                started = true;
-                std::cout << "[" << pos << ", ";
-            }
-            if(isSet(pos)==false && started== true){
-                started = false;
-                std::cout << pos - 1 << "]" << std::endl;
-            }
-        }
-        if(started == true){
-            std::cout << maxSizeInByte - 1 << "]" << std::endl;
+        merge();
+        for(size_t i = 0; i < intervals.size(); i++){
+            std::cout << "[" << intervals[i].first << ", " << intervals[i].second << "]" << std::endl;
         }
     }
 
@@ -239,10 +136,34 @@ public:
 
 private:
     std::vector<Range> ranges;
-    unsigned char * array;
-    int arraySizeInBytes;
-    int maxSizeInByte;
+    // inserted intervals, sorted and disjoint if merged is true
+    std::vector<std::pair<int, int>> intervals;
+    bool merged;
+
+    static bool compareEndToValue(const std::pair<int, int> &interval, int value){
+        return interval.second < value;
+    }
 
+    void merge(){
+        if(merged){
+            return;
+        }
+        std::sort(intervals.begin(), intervals.end());
+        size_t writePos = 0;
+        for(size_t i = 1; i < intervals.size(); i++){
+            // overlapping or adjacent
+            if(static_cast<long long>(intervals[i].first) <= static_cast<long long>(intervals[writePos].second) + 1){
+                intervals[writePos].second = std::max(intervals[writePos].second, intervals[i].second);
+            }else{
+                writePos++;
+                intervals[writePos] = intervals[i];
+            }
+        }
+        if(intervals.empty() == false){
+            intervals.resize(writePos + 1);
+        }
+        merged = true;
+    }
 };
 
 
@@ -0,0 +1,116 @@
+#ifndef CONTERMINATOR_KINGDOMLOOKUP_H
+#define CONTERMINATOR_KINGDOMLOOKUP_H
+
+#include "KingdomExpression.h"
+#include "NcbiTaxonomy.h"
+#include "Debug.h"
+#include "Util.h"
+#include <vector>
+#include <string>
+#include <algorithm>
+
+#ifdef OPENMP
+#include <omp.h>
+#endif
+
+// Resolves the kingdom term and the blacklist state of every taxon once.
+// Afterwards each lookup is a single array access, the table is immutable and
+// can be shared by all threads (unlike KingdomExpression, which needs one instance per thread).
+class KingdomLookup {
+public:
+    KingdomLookup(std::string & kingdoms, const std::string & blacklist, NcbiTaxonomy & taxonomy) {
+        std::vector<std::string> blacklistStr = Util::split(blacklist, ",");
+        std::vector<int> blacklistTaxa;
+        for (size_t i = 0; i < blacklistStr.size(); ++i) {
+            blacklistTaxa.push_back(Util::fast_atoi<int>(blacklistStr[i].c_str()));
+        }
+
+        TaxID maxTaxId = 0;
+        for (size_t i = 0; i < taxonomy.maxNodes; ++i) {
+            maxTaxId = std::max(maxTaxId, taxonomy.taxonNodes[i].taxId);
+        }
+        size = static_cast<size_t>(maxTaxId) + 1;
+
+        // evaluate the expensive expressions once per node
+        std::vector<unsigned char> nodeValue(taxonomy.maxNodes, static_cast<unsigned char>(NO_TERM));
+        termCount = 0;
+#pragma omp parallel
+        {
+            KingdomExpression kingdomExpression(kingdoms, taxonomy);
+#pragma omp single
+            termCount = kingdomExpression.getTaxTerms().size();
+
+#pragma omp for schedule(static)
+            for (size_t i = 0; i < taxonomy.maxNodes; ++i) {
+                const TaxID taxId = taxonomy.taxonNodes[i].taxId;
+                const int termId = kingdomExpression.isAncestorOf(taxId);
+                unsigned char value = (termId == -1) ? NO_TERM : static_cast<unsigned char>(termId);
+                for (size_t j = 0; j < blacklistTaxa.size(); ++j) {
+                    if (taxonomy.IsAncestor(blacklistTaxa[j], taxId)) {
+                        value |= BLACKLISTED;
+                        break;
+                    }
+                }
+                nodeValue[taxonomy.taxonNodes[i].id] = value;
+            }
+        }
+        if (termCount >= NO_TERM) {
+            Debug(Debug::ERROR) << "At most " << (NO_TERM - 1) << " kingdom terms are supported\n";
+            EXIT(EXIT_FAILURE);
+        }
+
+        // spread the node values over the taxon ids, this also resolves merged taxa
+        lookup = new unsigned char[size];
+#pragma omp parallel for schedule(static)
+        for (size_t taxId = 0; taxId < size; ++taxId) {
+            const TaxonNode *node = taxonomy.taxonNode(static_cast<TaxID>(taxId), false);
+            lookup[taxId] = (node == NULL) ? NO_TERM : nodeValue[node->id];
+        }
+    }
+
+    ~KingdomLookup() {
+        delete[] lookup;
+    }
+
+    // returns the index of the first term that contains the taxon
+    // -1 means no term fulfils the criteria
+    int getTermId(unsigned int taxId) const {
+        return toTermId(getValue(taxId));
+    }
+
+    bool isBlacklisted(unsigned int taxId) const {
+        return getValue(taxId) & BLACKLISTED;
+    }
+
+    // raw entry, decode with isBlacklistedValue and toTermId to avoid a second lookup
+    unsigned char getValue(unsigned int taxId) const {
+        return (taxId < size) ? lookup[taxId] : NO_TERM;
+    }
+
+    static bool isBlacklistedValue(unsigned char value) {
+        return value & BLACKLISTED;
+    }
+
+    static int toTermId(unsigned char value) {
+        const unsigned char term = value & TERM_MASK;
+        return (term == NO_TERM) ? -1 : term;
+    }
+
+    size_t getTermCount() const {
+        return termCount;
+    }
+
+private:
+    static const unsigned char BLACKLISTED = 0x80;
+    static const unsigned char TERM_MASK = 0x7F;
+    static const unsigned char NO_TERM = 0x7F;
+
+    unsigned char *lookup;
+    size_t size;
+    size_t termCount;
+
+    KingdomLookup(KingdomLookup const&);
+    void operator=(KingdomLookup const&);
+};
+
+#endif //CONTERMINATOR_KINGDOMLOOKUP_H
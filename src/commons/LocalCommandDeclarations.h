@@ -10,5 +10,20 @@ extern int extractalignments(int argc, const char** argv, const Command &command
 extern int crosstaxonfilter(int argc, const char **argv, const Command &command);
 extern int createstats(int argc, const char** argv, const Command &command);
 extern int createallreport(int argc, const char** argv, const Command &command);
+extern int convertallreport(int argc, const char** argv, const Command &command);
 extern int crosstaxonfilterorf(int argc, const char** argv, const Command &command);
+extern int crosstaxonkmermatcher(int argc, const char** argv, const Command &command);
+extern int windowrescorediagonal(int argc, const char** argv, const Command &command);
+extern int createdensetaxmapping(int argc, const char** argv, const Command &command);
+extern int createnrunindex(int argc, const char** argv, const Command &command);
+extern int intervalbenchmark(int argc, const char** argv, const Command &command);
+extern int createsyntheticbenchmark(int argc, const char** argv, const Command &command);
+extern int benchmarkstage(int argc, const char** argv, const Command &command);
+extern int benchmark(int argc, const char** argv, const Command &command);
+extern int telemetryreport(int argc, const char** argv, const Command &command);
+extern int createupdatemapping(int argc, const char** argv, const Command &command);
+extern int createtaxmapping(int argc, const char** argv, const Command &command);
+extern int mergeupdatealignments(int argc, const char** argv, const Command &command);
+extern int packnucleotidedb(int argc, const char** argv, const Command &command);
+extern int cachedindexdb(int argc, const char** argv, const Command &command);
 #endif
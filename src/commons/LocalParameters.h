@@ -17,20 +17,74 @@ public:
     }
     PARAMETER(PARAM_KINGDOMS)
     std::string kingdoms;
+    PARAMETER(PARAM_IN_PROCESS)
+    bool inProcess;
+    PARAMETER(PARAM_GENOMES_PER_KINGDOM)
+    int genomesPerKingdom;
+    PARAMETER(PARAM_GENOME_LENGTH)
+    int genomeLength;
+    PARAMETER(PARAM_CONTAMINANT_COUNT)
+    int contaminantCount;
+    PARAMETER(PARAM_CONTAMINANT_LENGTH)
+    int contaminantLength;
+    PARAMETER(PARAM_SEED)
+    int seed;
+    PARAMETER(PARAM_BENCHMARK_SCALES)
+    std::string benchmarkScales;
+    PARAMETER(PARAM_UPDATE)
+    std::string updateDir;
+    PARAMETER(PARAM_UPDATE_MAPPING)
+    std::string updateMapping;
+    PARAMETER(PARAM_PACK_SEQUENCES)
+    bool packSequences;
+    PARAMETER(PARAM_INDEX_CACHE)
+    std::string indexCache;
+    PARAMETER(PARAM_TAX_FROM_HEADER)
+    bool taxFromHeader;
 
     std::vector<MMseqsParameter*> conterminatordna;
     std::vector<MMseqsParameter*> conterminatorprotein;
     std::vector<MMseqsParameter*> extractalignments;
     std::vector<MMseqsParameter*> createstats;
     std::vector<MMseqsParameter*> crosstaxonfilterorf;
+    std::vector<MMseqsParameter*> crosstaxonkmermatcher;
+    std::vector<MMseqsParameter*> windowrescorediagonal;
+    std::vector<MMseqsParameter*> createsyntheticbenchmark;
+    std::vector<MMseqsParameter*> benchmark;
+    std::vector<MMseqsParameter*> createtaxmapping;
 private:
     LocalParameters() :
             Parameters(),
-            PARAM_KINGDOMS(PARAM_KINGDOMS_ID,"--kingdoms", "Compare across kingdoms", "",typeid(std::string), (void *) &kingdoms, "[,]"){
+            PARAM_KINGDOMS(PARAM_KINGDOMS_ID,"--kingdoms", "Compare across kingdoms", "",typeid(std::string), (void *) &kingdoms, "[,]"),
+            PARAM_IN_PROCESS(PARAM_IN_PROCESS_ID,"--in-process", "Run in process", "Run all workflow stages inside this process instead of a shell script calling one process per stage",typeid(bool), (void *) &inProcess, "", MMseqsParameter::COMMAND_EXPERT),
+            PARAM_GENOMES_PER_KINGDOM(PARAM_GENOMES_PER_KINGDOM_ID,"--genomes-per-kingdom", "Genomes per kingdom", "Number of synthetic genomes generated for each kingdom",typeid(int), (void *) &genomesPerKingdom, "^[1-9]{1}[0-9]*$"),
+            PARAM_GENOME_LENGTH(PARAM_GENOME_LENGTH_ID,"--genome-length", "Genome length", "Length of each synthetic genome",typeid(int), (void *) &genomeLength, "^[1-9]{1}[0-9]*$"),
+            PARAM_CONTAMINANT_COUNT(PARAM_CONTAMINANT_COUNT_ID,"--contaminant-count", "Contaminant count", "Number of contaminant fragments planted in genomes of other kingdoms",typeid(int), (void *) &contaminantCount, "^[0-9]{1}[0-9]*$"),
+            PARAM_CONTAMINANT_LENGTH(PARAM_CONTAMINANT_LENGTH_ID,"--contaminant-length", "Contaminant length", "Length of each planted contaminant fragment",typeid(int), (void *) &contaminantLength, "^[1-9]{1}[0-9]*$"),
+            PARAM_SEED(PARAM_SEED_ID,"--seed", "Seed", "Seed of the random number generator",typeid(int), (void *) &seed, "^[0-9]{1}[0-9]*$"),
+            PARAM_BENCHMARK_SCALES(PARAM_BENCHMARK_SCALES_ID,"--scales", "Scales", "Comma separated multipliers of --genomes-per-kingdom, the workflows run once for each",typeid(std::string), (void *) &benchmarkScales, ""),
+            PARAM_UPDATE(PARAM_UPDATE_ID,"--update", "Update", "tmpDir of a previous run (with --remove-tmp-files 0), only the new and changed sequences are searched against all",typeid(std::string), (void *) &updateDir, ""),
+            PARAM_UPDATE_MAPPING(PARAM_UPDATE_MAPPING_ID,"--update-mapping", "Update mapping", "createupdatemapping result, only pairs with a new or changed sequence are kept",typeid(std::string), (void *) &updateMapping, "", MMseqsParameter::COMMAND_EXPERT),
+            PARAM_PACK_SEQUENCES(PARAM_PACK_SEQUENCES_ID,"--pack-sequences", "Pack sequences", "Store the sequenceDB with 2 bits per base, the stages decode the sequences on demand",typeid(bool), (void *) &packSequences, "", MMseqsParameter::COMMAND_EXPERT),
+            PARAM_INDEX_CACHE(PARAM_INDEX_CACHE_ID,"--index-cache", "Index cache", "Directory of prefilter indices kept across runs, the contaminated regions are searched against the cached index of the split sequences",typeid(std::string), (void *) &indexCache, "", MMseqsParameter::COMMAND_EXPERT),
+            PARAM_TAX_FROM_HEADER(PARAM_TAX_FROM_HEADER_ID,"--tax-from-header", "Taxa from headers", "Take the taxon of each sequence from the word after its identifier in the FASTA header, the mapping file is not read",typeid(bool), (void *) &taxFromHeader, ""){
+        inProcess = false;
+        genomesPerKingdom = 4;
+        genomeLength = 100000;
+        contaminantCount = 10;
+        contaminantLength = 2000;
+        seed = 1;
+        benchmarkScales = "1,4,16";
+        updateDir = "";
+        updateMapping = "";
+        packSequences = false;
+        indexCache = "";
+        taxFromHeader = false;
 
         // extractalignments
         extractalignments.push_back(&PARAM_BLACKLIST);
         extractalignments.push_back(&PARAM_KINGDOMS);
+        extractalignments.push_back(&PARAM_SPLIT_MEMORY_LIMIT);
         extractalignments.push_back(&PARAM_THREADS);
         extractalignments.push_back(&PARAM_V);
         // crosstaxonfilterorf
@@ -38,6 +92,30 @@ private:
         crosstaxonfilterorf.push_back(&PARAM_KINGDOMS);
         crosstaxonfilterorf.push_back(&PARAM_THREADS);
         crosstaxonfilterorf.push_back(&PARAM_V);
+        // crosstaxonkmermatcher
+        crosstaxonkmermatcher = combineList(kmermatcher, crosstaxonfilterorf);
+        crosstaxonkmermatcher.push_back(&PARAM_UPDATE_MAPPING);
+        crosstaxonkmermatcher.push_back(&PARAM_SEQUENCE_OVERLAP);
+        // windowrescorediagonal
+        windowrescorediagonal = removeParameter(rescorediagonal, PARAM_SWAP_OUTPUT);
+        windowrescorediagonal.push_back(&PARAM_MAX_SEQ_LEN);
+        windowrescorediagonal.push_back(&PARAM_SEQUENCE_OVERLAP);
+        // createsyntheticbenchmark
+        createsyntheticbenchmark.push_back(&PARAM_GENOMES_PER_KINGDOM);
+        createsyntheticbenchmark.push_back(&PARAM_GENOME_LENGTH);
+        createsyntheticbenchmark.push_back(&PARAM_CONTAMINANT_COUNT);
+        createsyntheticbenchmark.push_back(&PARAM_CONTAMINANT_LENGTH);
+        createsyntheticbenchmark.push_back(&PARAM_SEED);
+        createsyntheticbenchmark.push_back(&PARAM_V);
+        // benchmark
+        benchmark = createsyntheticbenchmark;
+        benchmark.push_back(&PARAM_BENCHMARK_SCALES);
+        benchmark.push_back(&PARAM_THREADS);
+        benchmark.push_back(&PARAM_REMOVE_TMP_FILES);
+        // createtaxmapping
+        createtaxmapping.push_back(&PARAM_TAX_FROM_HEADER);
+        createtaxmapping.push_back(&PARAM_THREADS);
+        createtaxmapping.push_back(&PARAM_V);
         // createstats
         createstats.push_back(&PARAM_BLACKLIST);
         createstats.push_back(&PARAM_KINGDOMS);
@@ -55,6 +133,12 @@ private:
         conterminatorprotein = combineList(conterminatordna, createtaxdb);
         conterminatorprotein = combineList(conterminatordna, createstats);
         conterminatorprotein = combineList(conterminatordna, extractalignments);
+        // only the DNA workflow can run in process, be updated or read its taxa from a FASTA stream
+        conterminatordna.push_back(&PARAM_IN_PROCESS);
+        conterminatordna.push_back(&PARAM_UPDATE);
+        conterminatordna.push_back(&PARAM_PACK_SEQUENCES);
+        conterminatordna.push_back(&PARAM_INDEX_CACHE);
+        conterminatordna.push_back(&PARAM_TAX_FROM_HEADER);
     }
     LocalParameters(LocalParameters const&);
     ~LocalParameters() {};
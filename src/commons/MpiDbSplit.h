@@ -0,0 +1,55 @@
+#ifndef CONTERMINATOR_MPIDBSPLIT_H
+#define CONTERMINATOR_MPIDBSPLIT_H
+
+#include "DBReader.h"
+#include "DBWriter.h"
+#include "MMseqsMPI.h"
+#include "Util.h"
+
+#include <string>
+#include <vector>
+
+// Splits the entries of an input database across the MPI ranks like rescorediagonal does.
+// Each rank processes the entries [from, from + size) and writes them to its own temporary database,
+// rank 0 merges the parts with DBWriter::mergeResults once all ranks are done.
+// Without MPI the whole database is processed and written to the output directly.
+class MpiDbSplit {
+public:
+    MpiDbSplit(DBReader<unsigned int> &reader, const std::string &outDb, const std::string &outIndex)
+            : from(0), size(reader.getSize()), dataFile(outDb), indexFile(outIndex), outDb(outDb), outIndex(outIndex) {
+#ifdef HAVE_MPI
+        reader.decomposeDomainByAminoAcid(MMseqsMPI::rank, MMseqsMPI::numProc, &from, &size);
+        std::pair<std::string, std::string> tmpOutput = Util::createTmpFileNames(outDb, outIndex, MMseqsMPI::rank);
+        dataFile = tmpOutput.first;
+        indexFile = tmpOutput.second;
+#endif
+    }
+
+    // closes the writer opened on dataFile/indexFile and merges the parts of all ranks
+    void close(DBWriter &writer) {
+#ifdef HAVE_MPI
+        writer.close(true);
+        MPI_Barrier(MPI_COMM_WORLD);
+        if (MMseqsMPI::rank == 0) {
+            std::vector<std::pair<std::string, std::string>> splitFiles;
+            for (int proc = 0; proc < MMseqsMPI::numProc; ++proc) {
+                splitFiles.push_back(Util::createTmpFileNames(outDb, outIndex, proc));
+            }
+            DBWriter::mergeResults(outDb, outIndex, splitFiles);
+        }
+#else
+        writer.close();
+#endif
+    }
+
+    size_t from;
+    size_t size;
+    std::string dataFile;
+    std::string indexFile;
+
+private:
+    const std::string outDb;
+    const std::string outIndex;
+};
+
+#endif //CONTERMINATOR_MPIDBSPLIT_H
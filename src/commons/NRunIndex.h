@@ -0,0 +1,238 @@
+#ifndef CONTERMINATOR_NRUNINDEX_H
+#define CONTERMINATOR_NRUNINDEX_H
+
+#include "DBReader.h"
+#include "MemoryMapped.h"
+#include "FileUtil.h"
+#include "Debug.h"
+#include "Util.h"
+#include "PackedNucleotides.h"
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef OPENMP
+#include <omp.h>
+#endif
+
+// Positions of N runs (assembly gaps) of every sequence of a sequence DB.
+// The runs of dbKey k are runs[offsets[k], offsets[k+1]), each run is an inclusive [start, end] pair.
+// The index is written once by createnrunindex to <db>_nruns and memory mapped read-only,
+// if it is missing it is built in memory. File layout: 8 byte header (magic), uint64 key count,
+// uint64 offsets[key count + 1], Run runs[offsets[key count]].
+class NRunIndex {
+public:
+    struct Run {
+        unsigned int start;
+        unsigned int end;
+    };
+
+    NRunIndex(const std::string &db, unsigned int threads) : file(NULL), offsets(NULL), runs(NULL), keyCount(0) {
+        std::string indexFile = db + "_nruns";
+        if (FileUtil::fileExists(indexFile.c_str())) {
+            file = new MemoryMapped(indexFile, MemoryMapped::WholeFile, MemoryMapped::RandomAccess);
+            if (file->isValid() && file->size() >= HEADER_SIZE + sizeof(uint64_t) && memcmp(file->getData(), magic(), MAGIC_SIZE) == 0) {
+                const char *data = reinterpret_cast<const char *>(file->getData()) + HEADER_SIZE;
+                memcpy(&keyCount, data, sizeof(uint64_t));
+                offsets = reinterpret_cast<const uint64_t *>(data + sizeof(uint64_t));
+                runs = reinterpret_cast<const Run *>(offsets + keyCount + 1);
+                if (file->size() == HEADER_SIZE + (keyCount + 2) * sizeof(uint64_t) + offsets[keyCount] * sizeof(Run)) {
+                    return;
+                }
+            }
+            Debug(Debug::WARNING) << indexFile << " is invalid. Building N index in memory.\n";
+            delete file;
+            file = NULL;
+        }
+        DBReader<unsigned int> sequences(db.c_str(), (db + ".index").c_str(), threads,
+                                         DBReader<unsigned int>::USE_INDEX | DBReader<unsigned int>::USE_DATA);
+        sequences.open(DBReader<unsigned int>::NOSORT);
+        build(sequences, ownedOffsets, ownedRuns);
+        sequences.close();
+        keyCount = ownedOffsets.size() - 1;
+        offsets = ownedOffsets.data();
+        runs = ownedRuns.data();
+    }
+
+    ~NRunIndex() {
+        if (file != NULL) {
+            file->close();
+            delete file;
+        }
+    }
+
+    // largest N position <= startPos and smallest N position >= endPos, -1 if there is none
+    void findLeftAndRightPos(unsigned int key, int startPos, int endPos, int &leftNPos, int &rightNPos) const {
+        if (key >= keyCount) {
+            return;
+        }
+        const Run *first = runs + offsets[key];
+        const Run *last = runs + offsets[key + 1];
+        // first run that starts after startPos, the run before it is the closest on the left
+        const Run *it = std::upper_bound(first, last, startPos, compareValueToStart);
+        if (it != first) {
+            --it;
+            leftNPos = std::min(static_cast<int>(it->end), startPos);
+        }
+        // first run that ends at or after endPos
+        it = std::lower_bound(first, last, endPos, compareEndToValue);
+        if (it != last) {
+            rightNPos = std::max(static_cast<int>(it->start), endPos);
+        }
+    }
+
+    static void build(DBReader<unsigned int> &sequences, std::vector<uint64_t> &offsets, std::vector<Run> &runs) {
+        const size_t keyCount = static_cast<size_t>(sequences.getLastKey()) + 1;
+        offsets.assign(keyCount + 1, 0);
+        // the N runs of a packed database are its N exception runs, the bases do not need to be decoded
+        const bool isPacked = DBReader<unsigned int>::getExtendedDbtype(sequences.getDbtype()) & Parameters::DBTYPE_EXTENDED_NUCL_PACKED;
+        // first pass counts the runs of each key, the second pass fills them in
+        for (int pass = 0; pass < 2; pass++) {
+            Debug::Progress progress(sequences.getSize());
+#pragma omp parallel
+            {
+                unsigned int thread_idx = 0;
+#ifdef OPENMP
+                thread_idx = (unsigned int) omp_get_thread_num();
+#endif
+#pragma omp for schedule(dynamic, 10)
+                for (size_t i = 0; i < sequences.getSize(); i++) {
+                    progress.updateProgress();
+                    const unsigned int key = sequences.getDbKey(i);
+                    Run *keyRuns = (pass == 0) ? NULL : runs.data() + offsets[key];
+                    size_t runCount;
+                    if (isPacked) {
+                        runCount = scanPacked(sequences.getDataUncompressed(i) + sizeof(unsigned int), keyRuns);
+                    } else {
+                        runCount = scan(sequences.getData(i, thread_idx), sequences.getSeqLen(i), keyRuns);
+                    }
+                    if (pass == 0) {
+                        offsets[key + 1] = runCount;
+                    }
+                }
+            }
+            if (pass == 0) {
+                for (size_t key = 0; key < keyCount; key++) {
+                    offsets[key + 1] += offsets[key];
+                }
+                runs.resize(offsets[keyCount]);
+            }
+        }
+    }
+
+    static bool write(const std::string &db, const std::vector<uint64_t> &offsets, const std::vector<Run> &runs) {
+        std::string indexFile = db + "_nruns";
+        FILE *handle = fopen(indexFile.c_str(), "w");
+        if (handle == NULL) {
+            Debug(Debug::ERROR) << "Could not open " << indexFile << " for writing\n";
+            return false;
+        }
+        char header[HEADER_SIZE];
+        memset(header, 0, HEADER_SIZE);
+        memcpy(header, magic(), MAGIC_SIZE);
+        const uint64_t keyCount = offsets.size() - 1;
+        bool success = fwrite(header, HEADER_SIZE, 1, handle) == 1;
+        success = success && fwrite(&keyCount, sizeof(uint64_t), 1, handle) == 1;
+        success = success && fwrite(offsets.data(), sizeof(uint64_t), offsets.size(), handle) == offsets.size();
+        success = success && fwrite(runs.data(), sizeof(Run), runs.size(), handle) == runs.size();
+        if (fclose(handle) != 0 || success == false) {
+            Debug(Debug::ERROR) << "Could not write to " << indexFile << "\n";
+            return false;
+        }
+        return true;
+    }
+
+private:
+    MemoryMapped *file;
+    std::vector<uint64_t> ownedOffsets;
+    std::vector<Run> ownedRuns;
+    const uint64_t *offsets;
+    const Run *runs;
+    uint64_t keyCount;
+
+    static const char *magic() {
+        //                              N   R   U   N  Version
+        static const char magic[5] = {13, 17, 20, 13, 0};
+        return magic;
+    }
+    static const size_t MAGIC_SIZE = 5;
+    static const size_t HEADER_SIZE = 8;
+
+    static bool compareValueToStart(int value, const Run &run) {
+        return value < static_cast<int>(run.start);
+    }
+
+    static bool compareEndToValue(const Run &run, int value) {
+        return static_cast<int>(run.end) < value;
+    }
+
+    // true if one of the 8 bytes is 'N' or 'n'
+    static bool hasN(uint64_t word) {
+        const uint64_t ones = 0x0101010101010101ULL;
+        const uint64_t highs = 0x8080808080808080ULL;
+        // 'N' | 0x20 == 'n', no other byte turns into 'n'
+        const uint64_t diff = (word | (ones * 0x20)) ^ (ones * 'n');
+        return ((diff - ones) & ~diff & highs) != 0;
+    }
+
+    static bool isN(char c) {
+        return c == 'N' || c == 'n';
+    }
+
+    // counts the N runs of a sequence and stores them if runs is not NULL
+    // the sequence is checked 8 bytes at a time, runs are only resolved base by base where an N occurs
+    static size_t scan(const char *seq, size_t seqLen, Run *runs) {
+        size_t runCount = 0;
+        size_t pos = 0;
+        while (pos < seqLen) {
+            if (pos + sizeof(uint64_t) <= seqLen) {
+                uint64_t word;
+                memcpy(&word, seq + pos, sizeof(uint64_t));
+                if (hasN(word) == false) {
+                    pos += sizeof(uint64_t);
+                    continue;
+                }
+            }
+            if (isN(seq[pos]) == false) {
+                pos++;
+                continue;
+            }
+            const size_t start = pos;
+            while (pos < seqLen && isN(seq[pos])) {
+                pos++;
+            }
+            if (runs != NULL) {
+                runs[runCount].start = static_cast<unsigned int>(start);
+                runs[runCount].end = static_cast<unsigned int>(pos - 1);
+            }
+            runCount++;
+        }
+        return runCount;
+    }
+
+    static size_t scanPacked(const char *payload, Run *runs) {
+        size_t runCount = 0;
+        const uint32_t exceptionCount = PackedNucleotides::getExceptionCount(payload);
+        for (uint32_t i = 0; i < exceptionCount; i++) {
+            uint32_t start, length;
+            char letter;
+            PackedNucleotides::getException(payload, i, start, length, letter);
+            if (letter != 'N') {
+                continue;
+            }
+            if (runs != NULL) {
+                runs[runCount].start = start;
+                runs[runCount].end = start + length - 1;
+            }
+            runCount++;
+        }
+        return runCount;
+    }
+
+    NRunIndex(NRunIndex const&);
+    void operator=(NRunIndex const&);
+};
+
+#endif //CONTERMINATOR_NRUNINDEX_H
@@ -0,0 +1,152 @@
+#ifndef CONTERMINATOR_TAXONMAPPING_H
+#define CONTERMINATOR_TAXONMAPPING_H
+
+#include "MemoryMapped.h"
+#include "FileUtil.h"
+#include "Debug.h"
+#include "Util.h"
+#include <vector>
+#include <string>
+#include <climits>
+#include <algorithm>
+#include <string.h>
+
+// Dense dbKey -> taxon table. dbKeys of a sequence DB are dense (0..N), so the taxon
+// of each key is stored at its position and a lookup is a single array access.
+// The table is written once by createdensetaxmapping to <db>_mapping_dense and memory mapped
+// read-only by every tool. It uses the magic of the binary mapping (MappingReader::serialize)
+// with its own version byte, followed by the uint32 taxon array.
+// If the dense file is missing the table is built in memory from the text or binary <db>_mapping.
+class TaxonMapping {
+public:
+    static const unsigned int NO_TAXON = UINT_MAX;
+
+    TaxonMapping(const std::string &db) : file(NULL), taxa(NULL), size(0) {
+        std::string denseFile = db + "_mapping_dense";
+        if (FileUtil::fileExists(denseFile.c_str())) {
+            file = new MemoryMapped(denseFile, MemoryMapped::WholeFile, MemoryMapped::RandomAccess);
+            if (file->isValid() && file->size() >= HEADER_SIZE && memcmp(file->getData(), denseMagic(), MAGIC_SIZE) == 0) {
+                taxa = reinterpret_cast<const unsigned int *>(file->getData() + HEADER_SIZE);
+                size = (file->size() - HEADER_SIZE) / sizeof(unsigned int);
+                return;
+            }
+            Debug(Debug::WARNING) << denseFile << " is invalid. Building mapping in memory.\n";
+            delete file;
+            file = NULL;
+        }
+        buildDense(db, owned);
+        taxa = owned.data();
+        size = owned.size();
+    }
+
+    ~TaxonMapping() {
+        if (file != NULL) {
+            file->close();
+            delete file;
+        }
+    }
+
+    // returns NO_TAXON if the key has no mapping
+    unsigned int lookup(unsigned int key) const {
+        return (key < size) ? taxa[key] : NO_TAXON;
+    }
+
+    static void buildDense(const std::string &db, std::vector<unsigned int> &dense) {
+        std::string mappingFile = db + "_mapping";
+        if (FileUtil::fileExists(mappingFile.c_str()) == false) {
+            Debug(Debug::ERROR) << mappingFile << " does not exist. Please create the taxonomy mapping!\n";
+            EXIT(EXIT_FAILURE);
+        }
+        MemoryMapped mapping(mappingFile, MemoryMapped::WholeFile, MemoryMapped::SequentialScan);
+        if (!mapping.isValid()) {
+            Debug(Debug::ERROR) << "Could not open mapping file " << mappingFile << "\n";
+            EXIT(EXIT_FAILURE);
+        }
+        const char *data = reinterpret_cast<const char *>(mapping.getData());
+        const size_t dataSize = mapping.size();
+        dense.clear();
+        if (dataSize > MAGIC_SIZE && memcmp(data, binaryMagic(), MAGIC_SIZE) == 0) {
+            // binary mapping written by createbintaxmapping: sorted packed (dbKey, taxon) pairs
+            const size_t count = (dataSize - MAGIC_SIZE) / (2 * sizeof(unsigned int));
+            const char *entries = data + MAGIC_SIZE;
+            for (size_t i = 0; i < count; ++i) {
+                unsigned int pair[2];
+                memcpy(pair, entries + i * sizeof(pair), sizeof(pair));
+                add(dense, pair[0], pair[1]);
+            }
+        } else {
+            size_t currPos = 0;
+            char *dataChar = const_cast<char *>(data);
+            const char *cols[3];
+            while (currPos < dataSize) {
+                Util::getWordsOfLine(dataChar, cols, 2);
+                unsigned int id = Util::fast_atoi<size_t>(cols[0]);
+                unsigned int taxon = Util::fast_atoi<size_t>(cols[1]);
+                add(dense, id, taxon);
+                dataChar = Util::skipLine(dataChar);
+                currPos = dataChar - data;
+            }
+        }
+        mapping.close();
+        while (dense.empty() == false && dense.back() == NO_TAXON) {
+            dense.pop_back();
+        }
+        if (dense.empty()) {
+            Debug(Debug::ERROR) << mappingFile << " is empty. Rerun createtaxdb to recreate taxonomy mapping.\n";
+            EXIT(EXIT_FAILURE);
+        }
+    }
+
+    static bool writeDense(const std::string &db, const std::vector<unsigned int> &dense) {
+        std::string denseFile = db + "_mapping_dense";
+        FILE *handle = fopen(denseFile.c_str(), "w");
+        if (handle == NULL) {
+            Debug(Debug::ERROR) << "Could not open " << denseFile << " for writing\n";
+            return false;
+        }
+        char header[HEADER_SIZE];
+        memset(header, 0, HEADER_SIZE);
+        memcpy(header, denseMagic(), MAGIC_SIZE);
+        bool success = fwrite(header, HEADER_SIZE, 1, handle) == 1;
+        success = success && fwrite(dense.data(), sizeof(unsigned int), dense.size(), handle) == dense.size();
+        if (fclose(handle) != 0 || success == false) {
+            Debug(Debug::ERROR) << "Could not write to " << denseFile << "\n";
+            return false;
+        }
+        return true;
+    }
+
+private:
+    MemoryMapped *file;
+    std::vector<unsigned int> owned;
+    const unsigned int *taxa;
+    size_t size;
+
+    static const char *binaryMagic() {
+        //                               T  A   X   M  Version
+        static const char magic[5] = {19, 0, 23, 12, 0};
+        return magic;
+    }
+    static const char *denseMagic() {
+        static const char magic[5] = {19, 0, 23, 12, 1};
+        return magic;
+    }
+    static const size_t MAGIC_SIZE = 5;
+    // keep the taxon array 4 byte aligned
+    static const size_t HEADER_SIZE = 8;
+
+    // the first mapping of a key wins, same as the upper_bound lookup over the stable sorted mapping
+    static void add(std::vector<unsigned int> &dense, unsigned int key, unsigned int taxon) {
+        if (key >= dense.size()) {
+            dense.resize(std::max(static_cast<size_t>(key) + 1, dense.size() * 2), static_cast<unsigned int>(NO_TAXON));
+        }
+        if (dense[key] == NO_TAXON) {
+            dense[key] = taxon;
+        }
+    }
+
+    TaxonMapping(TaxonMapping const&);
+    void operator=(TaxonMapping const&);
+};
+
+#endif //CONTERMINATOR_TAXONMAPPING_H
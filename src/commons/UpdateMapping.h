@@ -0,0 +1,66 @@
+#ifndef CONTERMINATOR_UPDATEMAPPING_H
+#define CONTERMINATOR_UPDATEMAPPING_H
+
+#include "Debug.h"
+#include "Util.h"
+#include <fstream>
+#include <vector>
+#include <string>
+#include <climits>
+
+// Key mapping between the sequenceDB of a previous run and the sequenceDB of an update (conterminator dna --update).
+// The file is written by createupdatemapping, one "oldKey\tnewKey" line per unchanged entry.
+// Entries of the new DB without an old key are new or changed, entries of the old DB without a new key are gone.
+class UpdateMapping {
+public:
+    static const unsigned int NO_KEY = UINT_MAX;
+
+    UpdateMapping(const std::string &file) {
+        std::ifstream in(file.c_str());
+        if (in.fail()) {
+            Debug(Debug::ERROR) << "Could not open update mapping " << file << "\n";
+            EXIT(EXIT_FAILURE);
+        }
+        std::string line;
+        while (std::getline(in, line)) {
+            char *rest;
+            const unsigned int oldKey = static_cast<unsigned int>(strtoul(line.c_str(), &rest, 10));
+            const unsigned int newKey = static_cast<unsigned int>(strtoul(rest, NULL, 10));
+            if (rest == line.c_str() || *rest != '\t') {
+                Debug(Debug::ERROR) << "Invalid update mapping entry " << line << " in " << file << "\n";
+                EXIT(EXIT_FAILURE);
+            }
+            set(oldToNewKeys, oldKey, newKey);
+            set(newToOldKeys, newKey, oldKey);
+        }
+    }
+
+    unsigned int oldToNew(unsigned int oldKey) const {
+        return (oldKey < oldToNewKeys.size()) ? oldToNewKeys[oldKey] : NO_KEY;
+    }
+
+    unsigned int newToOld(unsigned int newKey) const {
+        return (newKey < newToOldKeys.size()) ? newToOldKeys[newKey] : NO_KEY;
+    }
+
+    bool isNew(unsigned int newKey) const {
+        return newToOld(newKey) == NO_KEY;
+    }
+
+    unsigned int getLastNewKey() const {
+        return newToOldKeys.empty() ? 0 : static_cast<unsigned int>(newToOldKeys.size() - 1);
+    }
+
+private:
+    std::vector<unsigned int> oldToNewKeys;
+    std::vector<unsigned int> newToOldKeys;
+
+    static void set(std::vector<unsigned int> &keys, unsigned int key, unsigned int value) {
+        if (key >= keys.size()) {
+            keys.resize(key + 1, static_cast<unsigned int>(NO_KEY));
+        }
+        keys[key] = value;
+    }
+};
+
+#endif //CONTERMINATOR_UPDATEMAPPING_H
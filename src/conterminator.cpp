@@ -18,9 +18,9 @@ std::vector<struct Command> commands = {
                 "Searches for cross taxon contamination in DNA sequences",
                 "Searches for cross taxon contamination in DNA sequences",
                 "Martin Steinegger <martin.steinegger@mpibpc.mpg.de>",
-                "<i:fasta/q> <i:mappingFile> <o:result> <tmpDir>", CITATION_MMSEQS2,
-                {{"sequenceDB", DbType::ACCESS_MODE_INPUT, DbType::NEED_DATA, &DbValidator::flatfile },
-                 {"mappingFile", DbType::ACCESS_MODE_INPUT, DbType::NEED_DATA, &DbValidator::flatfile },
+                "<i:fasta/q>|<i:stdin> <i:mappingFile>|<i:stdin> <o:result> <tmpDir>", CITATION_MMSEQS2,
+                {{"sequenceDB", DbType::ACCESS_MODE_INPUT, DbType::NEED_DATA, &DbValidator::flatfileAndStdin },
+                 {"mappingFile", DbType::ACCESS_MODE_INPUT, DbType::NEED_DATA, &DbValidator::flatfileAndStdin },
                  {"result", DbType::ACCESS_MODE_OUTPUT, DbType::NEED_DATA, &DbValidator::flatfile },
                  {"tmpDir", DbType::ACCESS_MODE_OUTPUT, DbType::NEED_DATA, &DbValidator::directory }}},
         {"protein",             conterminatorprotein,             &localPar.conterminatorprotein,             COMMAND_MAIN,
@@ -36,9 +36,18 @@ std::vector<struct Command> commands = {
                 "Predict contaminated taxon",
                 "Predict contaminated taxon",
                 "Martin Steinegger <martin.steinegger@mpibpc.mpg.de>",
-                "<i:resultDB> <o:resultDB>", CITATION_MMSEQS2,
-                {{"resultDB",   DbType::ACCESS_MODE_INPUT, DbType::NEED_DATA, &DbValidator::alignmentDb },
-                 {"resultDB",   DbType::ACCESS_MODE_OUTPUT, DbType::NEED_DATA, &DbValidator::alignmentDb }}},
+                "<i:sequenceDB> <i:allDB> <o:resultDB>", CITATION_MMSEQS2,
+                {{"sequenceDB", DbType::ACCESS_MODE_INPUT, DbType::NEED_DATA|DbType::NEED_HEADER|DbType::NEED_TAXONOMY, &DbValidator::taxSequenceDb },
+                 {"allDB",   DbType::ACCESS_MODE_INPUT, DbType::NEED_DATA, &DbValidator::genericDb },
+                 {"resultDB",   DbType::ACCESS_MODE_OUTPUT, DbType::NEED_DATA, &DbValidator::genericDb }}},
+        {"convertallreport",          convertallreport,          &localPar.createstats,         COMMAND_HIDDEN,
+                "Convert binary createallreport result to TSV",
+                "Convert binary createallreport result to TSV",
+                "Martin Steinegger <martin.steinegger@mpibpc.mpg.de>",
+                "<i:sequenceDB> <i:allDB> <o:tsvFile>", CITATION_MMSEQS2,
+                {{"sequenceDB", DbType::ACCESS_MODE_INPUT, DbType::NEED_DATA|DbType::NEED_HEADER|DbType::NEED_TAXONOMY, &DbValidator::taxSequenceDb },
+                 {"allDB",   DbType::ACCESS_MODE_INPUT, DbType::NEED_DATA, &DbValidator::genericDb },
+                 {"tsvFile",   DbType::ACCESS_MODE_OUTPUT, DbType::NEED_DATA, &DbValidator::flatfile }}},
         {"createstats",          createstats,          &localPar.createstats,         COMMAND_HIDDEN,
                 "Create taxon statistic",
                 "Create taxon statistic",
@@ -64,6 +73,23 @@ std::vector<struct Command> commands = {
                  {"orfHeader", DbType::ACCESS_MODE_INPUT, DbType::NEED_DATA, &DbValidator::genericDb },
                  {"resultDB",   DbType::ACCESS_MODE_OUTPUT, DbType::NEED_DATA, &DbValidator::resultDb },
                  {"resultDB",   DbType::ACCESS_MODE_OUTPUT, DbType::NEED_DATA, &DbValidator::resultDb }}},
+        {"crosstaxonkmermatcher",          crosstaxonkmermatcher,          &localPar.crosstaxonkmermatcher,         COMMAND_HIDDEN,
+                "Find k-mer matches between sequences of different kingdoms",
+                "Find k-mer matches between sequences of different kingdoms",
+                "Martin Steinegger <martin.steinegger@mpibpc.mpg.de>",
+                "<i:sequenceDB> <i:splitSequenceDB> <o:prefDB>", CITATION_MMSEQS2,
+                {{"sequenceDB", DbType::ACCESS_MODE_INPUT, DbType::NEED_DATA|DbType::NEED_TAXONOMY, &DbValidator::taxSequenceDb },
+                 {"splitSequenceDB", DbType::ACCESS_MODE_INPUT, DbType::NEED_DATA, &DbValidator::nuclDb },
+                 {"prefDB",   DbType::ACCESS_MODE_OUTPUT, DbType::NEED_DATA, &DbValidator::prefilterDb }}},
+        {"windowrescorediagonal",          windowrescorediagonal,          &localPar.windowrescorediagonal,         COMMAND_HIDDEN,
+                "Ungapped alignment of split sequences with results in contig coordinates",
+                "Ungapped alignment of split sequences with results in contig coordinates",
+                "Martin Steinegger <martin.steinegger@mpibpc.mpg.de>",
+                "<i:sequenceDB> <i:splitSequenceDB> <i:prefDB> <o:alnDB>", CITATION_MMSEQS2,
+                {{"sequenceDB", DbType::ACCESS_MODE_INPUT, DbType::NEED_DATA, &DbValidator::nuclDb },
+                 {"splitSequenceDB", DbType::ACCESS_MODE_INPUT, DbType::NEED_DATA, &DbValidator::nuclDb },
+                 {"prefDB",   DbType::ACCESS_MODE_INPUT, DbType::NEED_DATA, &DbValidator::resultDb },
+                 {"alnDB",   DbType::ACCESS_MODE_OUTPUT, DbType::NEED_DATA, &DbValidator::alignmentDb }}},
         {"crosstaxonfilter",          crosstaxonfilter,          &localPar.extractalignments,         COMMAND_HIDDEN,
                 "Extract cluster with n taxas",
                 "Extract cluster with n taxas",
@@ -72,6 +98,18 @@ std::vector<struct Command> commands = {
                 {{"sequenceDB", DbType::ACCESS_MODE_INPUT, DbType::NEED_DATA|DbType::NEED_TAXONOMY, &DbValidator::taxSequenceDb },
                   {"clusterDB",   DbType::ACCESS_MODE_OUTPUT, DbType::NEED_DATA, &DbValidator::clusterDb },
                   {"clusterDB",   DbType::ACCESS_MODE_OUTPUT, DbType::NEED_DATA, &DbValidator::clusterDb }}},
+        {"createdensetaxmapping",          createdensetaxmapping,          &localPar.onlyverbosity,         COMMAND_HIDDEN,
+                "Create dense dbKey to taxon mapping",
+                "Create dense dbKey to taxon mapping",
+                "Martin Steinegger <martin.steinegger@mpibpc.mpg.de>",
+                "<i:sequenceDB>", CITATION_MMSEQS2,
+                {{"sequenceDB", DbType::ACCESS_MODE_INPUT, DbType::NEED_DATA, &DbValidator::sequenceDb }}},
+        {"createnrunindex",          createnrunindex,          &localPar.onlythreads,         COMMAND_HIDDEN,
+                "Create index of N runs",
+                "Create index of N runs",
+                "Martin Steinegger <martin.steinegger@mpibpc.mpg.de>",
+                "<i:sequenceDB>", CITATION_MMSEQS2,
+                {{"sequenceDB", DbType::ACCESS_MODE_INPUT, DbType::NEED_DATA, &DbValidator::sequenceDb }}},
         {"extractalignments",          extractalignments,          &localPar.extractalignments,         COMMAND_HIDDEN,
                 "Extract alignments containing n taxas",
                 "Extract alignments containing n taxas",
@@ -79,7 +117,79 @@ std::vector<struct Command> commands = {
                 "<i:sequenceDB> <i:alnDB> <o:alnDB>",CITATION_MMSEQS2,
                 {{"sequenceDB", DbType::ACCESS_MODE_INPUT, DbType::NEED_DATA|DbType::NEED_TAXONOMY, &DbValidator::taxSequenceDb },
                  {"alnDB",   DbType::ACCESS_MODE_OUTPUT, DbType::NEED_DATA, &DbValidator::alignmentDb },
-                 {"resultDB",   DbType::ACCESS_MODE_OUTPUT, DbType::NEED_DATA, &DbValidator::alignmentDb }}}
+                 {"resultDB",   DbType::ACCESS_MODE_OUTPUT, DbType::NEED_DATA, &DbValidator::alignmentDb }}},
+        {"intervalbenchmark",          intervalbenchmark,          &localPar.extractalignments,         COMMAND_HIDDEN,
+                "Compare bitmap and interval union of the extractalignments hits",
+                "Compare bitmap and interval union of the extractalignments hits",
+                "Martin Steinegger <martin.steinegger@mpibpc.mpg.de>",
+                "<i:sequenceDB> <i:alnDB>",CITATION_MMSEQS2,
+                {{"sequenceDB", DbType::ACCESS_MODE_INPUT, DbType::NEED_DATA|DbType::NEED_TAXONOMY, &DbValidator::taxSequenceDb },
+                 {"alnDB",   DbType::ACCESS_MODE_INPUT, DbType::NEED_DATA, &DbValidator::alignmentDb }}},
+        {"createsyntheticbenchmark",          createsyntheticbenchmark,          &localPar.createsyntheticbenchmark,         COMMAND_HIDDEN,
+                "Generate synthetic genomes, proteins and taxonomy with planted contaminants",
+                "Generate synthetic genomes, proteins and taxonomy with planted contaminants",
+                "Martin Steinegger <martin.steinegger@mpibpc.mpg.de>",
+                "<o:outDir>",CITATION_MMSEQS2,
+                {{"outDir", DbType::ACCESS_MODE_OUTPUT, DbType::NEED_DATA, &DbValidator::directory }}},
+        {"benchmarkstage",          benchmarkstage,          NULL,         COMMAND_HIDDEN,
+                "Run a program and append its time and peak memory to a report",
+                "Run a program and append its time and peak memory to a report",
+                "Martin Steinegger <martin.steinegger@mpibpc.mpg.de>",
+                "<o:reportFile> <program> [<args>]",CITATION_MMSEQS2,
+                {{"reportFile", DbType::ACCESS_MODE_OUTPUT, DbType::NEED_DATA, &DbValidator::flatfile }}},
+        {"benchmark",          benchmark,          &localPar.benchmark,         COMMAND_HIDDEN,
+                "Benchmark the dna and protein workflows on synthetic data",
+                "Benchmark the dna and protein workflows on synthetic data",
+                "Martin Steinegger <martin.steinegger@mpibpc.mpg.de>",
+                "<o:outDir> <tmpDir>",CITATION_MMSEQS2,
+                {{"outDir", DbType::ACCESS_MODE_OUTPUT, DbType::NEED_DATA, &DbValidator::directory },
+                 {"tmpDir", DbType::ACCESS_MODE_OUTPUT, DbType::NEED_DATA, &DbValidator::directory }}},
+        {"telemetryreport",          telemetryreport,          &localPar.onlyverbosity,         COMMAND_HIDDEN,
+                "Aggregate the stage telemetry of a workflow run into a JSON report",
+                "Aggregate the stage telemetry of a workflow run into a JSON report",
+                "Martin Steinegger <martin.steinegger@mpibpc.mpg.de>",
+                "<i:telemetryFile> <o:reportFile>",CITATION_MMSEQS2,
+                {{"telemetryFile", DbType::ACCESS_MODE_INPUT, DbType::NEED_DATA, &DbValidator::flatfile },
+                 {"reportFile", DbType::ACCESS_MODE_OUTPUT, DbType::NEED_DATA, &DbValidator::flatfile }}},
+        {"createupdatemapping",          createupdatemapping,          &localPar.onlythreads,         COMMAND_HIDDEN,
+                "Map the unchanged sequences of a previous sequenceDB to the keys of a new sequenceDB",
+                "Map the unchanged sequences of a previous sequenceDB to the keys of a new sequenceDB",
+                "Martin Steinegger <martin.steinegger@mpibpc.mpg.de>",
+                "<i:oldSequenceDB> <i:newSequenceDB> <o:mappingFile>",CITATION_MMSEQS2,
+                {{"oldSequenceDB", DbType::ACCESS_MODE_INPUT, DbType::NEED_DATA|DbType::NEED_HEADER, &DbValidator::sequenceDb },
+                 {"newSequenceDB", DbType::ACCESS_MODE_INPUT, DbType::NEED_DATA|DbType::NEED_HEADER, &DbValidator::sequenceDb },
+                 {"mappingFile", DbType::ACCESS_MODE_OUTPUT, DbType::NEED_DATA, &DbValidator::flatfile }}},
+        {"createtaxmapping",          createtaxmapping,          &localPar.createtaxmapping,         COMMAND_HIDDEN,
+                "Join an accession to taxon mapping file against the lookup of a sequenceDB into its binary _mapping",
+                "Join an accession to taxon mapping file against the lookup of a sequenceDB into its binary _mapping",
+                "Martin Steinegger <martin.steinegger@mpibpc.mpg.de>",
+                "<i:sequenceDB> <i:mappingFile>|<i:stdin>",CITATION_MMSEQS2,
+                {{"sequenceDB", DbType::ACCESS_MODE_INPUT, DbType::NEED_DATA, &DbValidator::sequenceDb },
+                 {"mappingFile", DbType::ACCESS_MODE_INPUT, DbType::NEED_DATA, &DbValidator::flatfileAndStdin }}},
+        {"mergeupdatealignments",          mergeupdatealignments,          &localPar.threadsandcompression,         COMMAND_HIDDEN,
+                "Merge the alignments of a previous run with the alignments of the new sequences of an update",
+                "Merge the alignments of a previous run with the alignments of the new sequences of an update",
+                "Martin Steinegger <martin.steinegger@mpibpc.mpg.de>",
+                "<i:oldAlnDB> <i:newAlnDB> <i:mappingFile> <o:alnDB>",CITATION_MMSEQS2,
+                {{"oldAlnDB", DbType::ACCESS_MODE_INPUT, DbType::NEED_DATA, &DbValidator::alignmentDb },
+                 {"newAlnDB", DbType::ACCESS_MODE_INPUT, DbType::NEED_DATA, &DbValidator::alignmentDb },
+                 {"mappingFile", DbType::ACCESS_MODE_INPUT, DbType::NEED_DATA, &DbValidator::flatfile },
+                 {"alnDB", DbType::ACCESS_MODE_OUTPUT, DbType::NEED_DATA, &DbValidator::alignmentDb }}},
+        {"packnucleotidedb",          packnucleotidedb,          &localPar.onlythreads,         COMMAND_HIDDEN,
+                "Store the sequences of a nucleotide sequenceDB with 2 bits per base",
+                "Store the sequences of a nucleotide sequenceDB with 2 bits per base",
+                "Martin Steinegger <martin.steinegger@mpibpc.mpg.de>",
+                "<i:sequenceDB> <o:sequenceDB>",CITATION_MMSEQS2,
+                {{"sequenceDB", DbType::ACCESS_MODE_INPUT, DbType::NEED_DATA, &DbValidator::nuclDb },
+                 {"sequenceDB", DbType::ACCESS_MODE_OUTPUT, DbType::NEED_DATA, &DbValidator::nuclDb }}},
+        {"cachedindexdb",          cachedindexdb,          &localPar.indexdb,         COMMAND_HIDDEN,
+                "Link the prefilter index of a nucleotide sequenceDB from a cache directory, the index is created if it is missing",
+                "Link the prefilter index of a nucleotide sequenceDB from a cache directory, the index is created if it is missing",
+                "Martin Steinegger <martin.steinegger@mpibpc.mpg.de>",
+                "<i:sequenceDB> <o:cacheDir> <o:indexDB>",CITATION_MMSEQS2,
+                {{"sequenceDB", DbType::ACCESS_MODE_INPUT, DbType::NEED_DATA|DbType::NEED_HEADER, &DbValidator::nuclDb },
+                 {"cacheDir", DbType::ACCESS_MODE_OUTPUT, DbType::NEED_DATA, &DbValidator::directory },
+                 {"indexDB", DbType::ACCESS_MODE_OUTPUT, DbType::NEED_DATA, &DbValidator::sequenceDb }}}
 
 };
 
@@ -13,7 +13,8 @@
 #include "Util.h"
 #include "DBWriter.h"
 #include "NcbiTaxonomy.h"
-#include "KingdomExpression.h"
+#include "KingdomLookup.h"
+#include "TaxonMapping.h"
 
 class TaxonUtils{
 public:
@@ -95,47 +96,31 @@ public:
         }
     };
 
-    static bool compareToFirstInt(const std::pair<unsigned int, unsigned int>& lhs, const std::pair<unsigned int, unsigned int>& rhs){
-        return (lhs.first <= rhs.first);
-    }
-
-    static unsigned int getTaxon(unsigned int id, std::vector<std::pair<unsigned int, unsigned int>> &mapping) {
-        std::pair<unsigned int, unsigned int> val;
-        val.first = id;
-        std::vector<std::pair<unsigned int, unsigned int>>::iterator mappingIt = std::upper_bound(
-                mapping.begin(), mapping.end(), val, compareToFirstInt);
-        if (mappingIt->first != val.first) {
-            return UINT_MAX;
-        }
-        return  mappingIt->second;
-    }
-
     static std::vector<TaxonInformation> assignTaxonomy(std::vector<TaxonInformation>  &elements,
-                                                        char *data, std::vector<std::pair<unsigned int, unsigned int>> & mapping,
-                                                        NcbiTaxonomy & t, KingdomExpression & kingdomExpression,
-                                                        std::vector<int> &blacklist,
+                                                        char *data, const TaxonMapping & mapping,
+                                                        const KingdomLookup & kingdomLookup,
                                                         size_t * taxaCounter, bool parseDbKey = false) {
         elements.clear();
         const char * entry[255];
         while (*data != '\0') {
             int termIndex;
+            unsigned char kingdomValue;
             const size_t columns = Util::getWordsOfLine(data, entry, 255);
             if (columns == 0) {
                 data = Util::skipLine(data);
                 continue;
             }
             unsigned int id = Util::fast_atoi<unsigned int>(entry[0]);
-            unsigned int taxon = getTaxon(id, mapping);;
+            unsigned int taxon = mapping.lookup(id);
             if (taxon == 0 || taxon == UINT_MAX) {
                 goto next;
             }
+            kingdomValue = kingdomLookup.getValue(taxon);
             // remove blacklisted taxa
-            for (size_t j = 0; j < blacklist.size(); ++j) {
-                if (t.IsAncestor(blacklist[j], taxon)) {
-                    goto next;
-                }
+            if (KingdomLookup::isBlacklistedValue(kingdomValue)) {
+                goto next;
             }
-            termIndex = kingdomExpression.isAncestorOf(taxon);
+            termIndex = KingdomLookup::toTermId(kingdomValue);
             if(termIndex != -1) {
                 taxaCounter[termIndex]++;
                 int startPos = Util::fast_atoi<int>(entry[4]);
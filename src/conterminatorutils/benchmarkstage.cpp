@@ -0,0 +1,74 @@
+#include "Parameters.h"
+#include "Debug.h"
+#include "Util.h"
+#include "FileUtil.h"
+
+#include <string>
+#include <sys/types.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+
+// Runs <program> [<args>] as a child process and appends one line with its resources to <reportFile>:
+// stage wallTime userTime systemTime maxRssKb exitStatus
+// The benchmark workflow passes it as --mpi-runner, so every $RUNNER stage of the workflow scripts is measured.
+// The arguments are passed through unparsed, they belong to the measured program.
+int benchmarkstage(int argc, const char **argv, const Command&) {
+    if (argc < 2) {
+        Debug(Debug::ERROR) << "Usage: benchmarkstage <reportFile> <program> [<args>]\n";
+        return EXIT_FAILURE;
+    }
+    const char *reportFile = argv[0];
+    // mmseqs style binaries are named by their first argument
+    std::string stage = (argc > 2 && argv[2][0] != '-') ? argv[2] : FileUtil::baseName(argv[1]);
+
+    struct timeval start;
+    gettimeofday(&start, NULL);
+    pid_t pid = fork();
+    if (pid == -1) {
+        Debug(Debug::ERROR) << "Could not fork " << argv[1] << ": " << strerror(errno) << "\n";
+        return EXIT_FAILURE;
+    }
+    if (pid == 0) {
+        execvp(argv[1], const_cast<char *const *>(argv + 1));
+        Debug(Debug::ERROR) << "Could not execute " << argv[1] << ": " << strerror(errno) << "\n";
+        _exit(127);
+    }
+
+    int status = 0;
+    struct rusage usage;
+    memset(&usage, 0, sizeof(usage));
+    while (wait4(pid, &status, 0, &usage) == -1) {
+        if (errno != EINTR) {
+            Debug(Debug::ERROR) << "Could not wait for " << argv[1] << ": " << strerror(errno) << "\n";
+            return EXIT_FAILURE;
+        }
+    }
+    struct timeval end;
+    gettimeofday(&end, NULL);
+    const double wallTime = (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) / 1e6;
+    const double userTime = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6;
+    const double systemTime = usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+    const int exitStatus = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+
+    FILE *report = fopen(reportFile, "a");
+    if (report == NULL) {
+        Debug(Debug::ERROR) << "Could not open " << reportFile << " for writing\n";
+        return EXIT_FAILURE;
+    }
+    // ru_maxrss is in kilobytes on Linux and in bytes on macOS
+#ifdef __APPLE__
+    const long maxRss = usage.ru_maxrss / 1024;
+#else
+    const long maxRss = usage.ru_maxrss;
+#endif
+    fprintf(report, "%s\t%.3f\t%.3f\t%.3f\t%ld\t%d\n", stage.c_str(), wallTime, userTime, systemTime, maxRss, exitStatus);
+    if (fclose(report) != 0) {
+        Debug(Debug::ERROR) << "Could not write to " << reportFile << "\n";
+        return EXIT_FAILURE;
+    }
+    return exitStatus;
+}
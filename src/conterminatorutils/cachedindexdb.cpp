@@ -0,0 +1,106 @@
+// include xxhash early to avoid incompatibilites with SIMDe
+#define XXH_INLINE_ALL
+#include "xxhash.h"
+
+#include "Parameters.h"
+#include "DBReader.h"
+#include "Debug.h"
+#include "Util.h"
+#include "FileUtil.h"
+#include "Prefiltering.h"
+#include "PrefilteringIndexReader.h"
+#include "LocalParameters.h"
+
+#include <cstdio>
+#include <iomanip>
+#include <sstream>
+#include <unistd.h>
+
+static void hashFile(XXH64_state_t *state, const std::string &file, std::vector<char> &buffer) {
+    FILE *handle = FileUtil::openFileOrDie(file.c_str(), "r", true);
+    size_t read;
+    while ((read = fread(buffer.data(), sizeof(char), buffer.size(), handle)) > 0) {
+        XXH64_update(state, buffer.data(), read);
+    }
+    if (ferror(handle)) {
+        Debug(Debug::ERROR) << "Could not read " << file << "\n";
+        EXIT(EXIT_FAILURE);
+    }
+    fclose(handle);
+}
+
+// checksum of the index, data and dbtype files of a database, all data files of a multi-file database are included
+static void hashDb(XXH64_state_t *state, const std::string &db, std::vector<char> &buffer) {
+    hashFile(state, db + ".dbtype", buffer);
+    hashFile(state, db + ".index", buffer);
+    std::vector<std::string> dataFiles = FileUtil::findDatafiles(db.c_str());
+    for (size_t i = 0; i < dataFiles.size(); ++i) {
+        hashFile(state, dataFiles[i], buffer);
+    }
+}
+
+// Prefilter index (indexdb) of a nucleotide sequenceDB that is kept in a cache directory across runs.
+// The index is stored as <cacheDir>/<key>.idx, the key is a checksum of the sequences, headers and the
+// parameters of the index, so a changed database or k-mer setting never reuses a stale index.
+// indexDB is a soft link to the cached index, the prefilter maps it instead of building a k-mer table.
+int cachedindexdb(int argc, const char **argv, const Command &command) {
+    LocalParameters &par = LocalParameters::getLocalInstance();
+    par.parseParameters(argc, argv, command, true, 0, 0);
+
+    // threads, verbosity and the compatibility check do not change the index
+    std::vector<MMseqsParameter*> indexParameters = par.removeParameter(par.indexdb, par.PARAM_THREADS);
+    indexParameters = par.removeParameter(indexParameters, par.PARAM_V);
+    indexParameters = par.removeParameter(indexParameters, par.PARAM_CHECK_COMPATIBLE);
+    const std::string indexParameterString = par.createParameterString(indexParameters);
+
+    XXH64_state_t *state = XXH64_createState();
+    XXH64_reset(state, 0);
+    std::vector<char> buffer(1024 * 1024);
+    hashDb(state, par.db1, buffer);
+    hashDb(state, par.hdr1, buffer);
+    XXH64_update(state, indexParameterString.c_str(), indexParameterString.size());
+    const XXH64_hash_t key = XXH64_digest(state);
+    XXH64_freeState(state);
+
+    std::ostringstream keyName;
+    keyName << std::hex << std::setw(16) << std::setfill('0') << key;
+    const std::string cachedIndex = par.db2 + "/" + keyName.str() + ".idx";
+    if (FileUtil::fileExists((cachedIndex + ".dbtype").c_str())) {
+        Debug(Debug::INFO) << "Use cached index " << cachedIndex << "\n";
+    } else {
+        Debug(Debug::INFO) << "Create index " << cachedIndex << "\n";
+        DBReader<unsigned int> dbr(par.db1.c_str(), par.db1Index.c_str(), par.threads, DBReader<unsigned int>::USE_INDEX|DBReader<unsigned int>::USE_DATA);
+        dbr.open(DBReader<unsigned int>::NOSORT);
+        DBReader<unsigned int> hdbr(par.hdr1.c_str(), par.hdr1Index.c_str(), par.threads, DBReader<unsigned int>::USE_INDEX|DBReader<unsigned int>::USE_DATA);
+        hdbr.open(DBReader<unsigned int>::NOSORT);
+
+        // same setup as indexdb for a nucleotide sequenceDB that is query and target
+        BaseMatrix *seedSubMat = Prefiltering::getSubstitutionMatrix(par.seedScoringMatrixFile, par.alphabetSize, 8.0f, false, true);
+        size_t memoryLimit = Util::computeMemory(par.splitMemoryLimit);
+        int splitMode = Parameters::TARGET_DB_SPLIT;
+        par.maxResListLen = std::min(dbr.getSize(), par.maxResListLen);
+        Prefiltering::setupSplit(dbr, seedSubMat->alphabetSize - 1, dbr.getDbtype(), par.threads, false, memoryLimit, 1,
+                                 par.maxResListLen, par.kmerSize, par.split, splitMode);
+        // nucleotide k-mers are matched exactly, the prefilter uses no k-mer score threshold either
+        const int kmerScore = 0;
+
+        // concurrent runs build their own copy, the dbtype file is moved last and marks a complete index
+        const std::string tmpIndex = cachedIndex + "_tmp_" + SSTR(getpid());
+        PrefilteringIndexReader::createIndexFile(tmpIndex, &dbr, NULL, &hdbr, NULL, NULL, seedSubMat, par.maxSeqLen,
+                                                 par.spacedKmer, par.spacedKmerPattern, par.compBiasCorrection,
+                                                 seedSubMat->alphabetSize, par.kmerSize, par.maskMode, par.maskLowerCaseMode,
+                                                 par.maskProb, kmerScore, par.split);
+        DBReader<unsigned int>::moveDb(tmpIndex, cachedIndex);
+        delete seedSubMat;
+        hdbr.close();
+        dbr.close();
+    }
+
+    // unlink instead of removeDb, the link of a previous run dangles if the cache was cleaned up
+    const char *suffixes[] = {"", ".index", ".dbtype"};
+    for (size_t i = 0; i < sizeof(suffixes) / sizeof(suffixes[0]); ++i) {
+        unlink((par.db3 + suffixes[i]).c_str());
+    }
+    DBReader<unsigned int>::softlinkDb(cachedIndex, par.db3, (DBFiles::Files)(DBFiles::DATA | DBFiles::DATA_INDEX | DBFiles::DATA_DBTYPE));
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,81 @@
+#include "ContaminationRecord.h"
+#include "NcbiTaxonomy.h"
+#include "Parameters.h"
+#include "DBReader.h"
+#include "DBWriter.h"
+#include "FileUtil.h"
+#include "Debug.h"
+#include "itoa.h"
+#include "LocalParameters.h"
+
+#include <algorithm>
+
+#ifdef OPENMP
+#include <omp.h>
+#endif
+
+int convertallreport(int argc, const char **argv, const Command& command) {
+    LocalParameters &par = LocalParameters::getLocalInstance();
+    par.parseParameters(argc, argv, command, true, 0, 0);
+
+    NcbiTaxonomy * t = NcbiTaxonomy::openTaxonomy(par.db1);
+
+    DBReader<unsigned int> header(par.hdr1.c_str(), par.hdr1Index.c_str(), par.threads,
+                                  DBReader<unsigned int>::USE_DATA | DBReader<unsigned int>::USE_INDEX);
+    header.open(DBReader<unsigned int>::NOSORT);
+    header.readMmapedDataInMemory();
+
+    DBReader<unsigned int> reader(par.db2.c_str(), par.db2Index.c_str(), par.threads,
+                                  DBReader<unsigned int>::USE_DATA | DBReader<unsigned int>::USE_INDEX);
+    reader.open(DBReader<unsigned int>::LINEAR_ACCCESS);
+
+    // the records are rendered once into the final TSV, every line is prefixed with the query key like prefixid --tsv
+    DBWriter writer(par.db3.c_str(), par.db3Index.c_str(), par.threads, false, Parameters::DBTYPE_OMIT_FILE);
+    writer.open();
+
+    // every thread writes a contiguous range of entries, the thread files are concatenated in thread order
+    const size_t entries = reader.getSize();
+    std::vector<size_t> entryOffsets(entries + 1, 0);
+    for (size_t i = 0; i < entries; ++i) {
+        entryOffsets[i + 1] = entryOffsets[i] + reader.getEntryLen(i);
+    }
+    const size_t totalSize = entryOffsets[entries];
+
+    Debug::Progress progress(entries);
+#pragma omp parallel
+    {
+        unsigned int thread_idx = 0;
+        unsigned int threadCount = 1;
+#ifdef OPENMP
+        thread_idx = (unsigned int) omp_get_thread_num();
+        threadCount = (unsigned int) omp_get_num_threads();
+#endif
+        const size_t from = std::lower_bound(entryOffsets.begin(), entryOffsets.end() - 1, (totalSize * thread_idx) / threadCount) - entryOffsets.begin();
+        const size_t to = std::lower_bound(entryOffsets.begin(), entryOffsets.end() - 1, (totalSize * (thread_idx + 1)) / threadCount) - entryOffsets.begin();
+
+        char keyBuffer[32];
+        std::string resultData;
+        resultData.reserve(1024 * 1024);
+        for (size_t i = from; i < to; ++i) {
+            progress.updateProgress();
+            const unsigned int queryKey = reader.getDbKey(i);
+            char *keyEnd = Itoa::u32toa_sse2(queryKey, keyBuffer);
+            const ContaminationRecord *records = reinterpret_cast<const ContaminationRecord *>(reader.getData(i, thread_idx));
+            const size_t recordCount = ContaminationRecord::getRecordCount(reader.getEntryLen(i));
+            for (size_t j = 0; j < recordCount; j++) {
+                resultData.append(keyBuffer, keyEnd - keyBuffer - 1);
+                resultData.push_back('\t');
+                records[j].appendTsv(resultData, header, *t, thread_idx);
+            }
+            writer.writeData(resultData.c_str(), resultData.size(), queryKey, thread_idx, false);
+            resultData.clear();
+        }
+    }
+    writer.close(true);
+    FileUtil::remove(writer.getIndexFileName());
+
+    delete t;
+    reader.close();
+    header.close();
+    return EXIT_SUCCESS;
+}
@@ -1,13 +1,14 @@
 #include "TaxonUtils.h"
+#include "NRunIndex.h"
+#include "ContaminationRecord.h"
 #include "NcbiTaxonomy.h"
 #include "Parameters.h"
 #include "DBWriter.h"
 #include "FileUtil.h"
 #include "Debug.h"
 #include "Util.h"
-#include <omptl/omptl_algorithm>
-#include <set>
 #include <limits>
+#include "MpiDbSplit.h"
 #include <LocalParameters.h>
 
 #ifdef OPENMP
@@ -15,117 +16,49 @@
 #endif
 
 
-void findLeftAndRightPos(int startPos, int endPos, std::pair<size_t, size_t> startEnd, std::vector<int> &vectorN, int &leftNPos, int &rightNPos) {
-    size_t elmCnt = startEnd.second - startEnd.first;
-    if(elmCnt == 0){
-        return;
-    }
-    std::vector<int>::iterator arrayStartPos = vectorN.begin() + startEnd.first;
-    std::vector<int>::iterator arrayEndPos = vectorN.begin() + (startEnd.first + elmCnt);
-
-    std::vector<int>::iterator startPosIt = std::lower_bound(arrayStartPos, arrayEndPos, startPos) ;
-    if(startPosIt != arrayEndPos){
-        if(*startPosIt > startPos){
-            if((startPosIt - 1) >= arrayStartPos){
-                --startPosIt;
-                leftNPos = *startPosIt;
-            }
-        }else {
-            leftNPos = *startPosIt;
-        }
-    }
-
-    std::vector<int>::iterator endPosIt = std::lower_bound(arrayStartPos, arrayEndPos, endPos);
-    if(endPosIt != arrayEndPos){
-        rightNPos = *endPosIt;
-    }
-}
-
-
 int createallreport(int argc, const char **argv, const Command& command) {
+    MMseqsMPI::init(argc, argv);
+
     LocalParameters &par = LocalParameters::getLocalInstance();
     // bacteria, archaea, eukaryotic, virus
     par.parseParameters(argc, argv, command, true, 0, 0);
 
     NcbiTaxonomy * t = NcbiTaxonomy::openTaxonomy(par.db1);
 
-    std::vector<std::pair<unsigned int, unsigned int>> mapping;
-    if (FileUtil::fileExists(std::string(par.db1 + "_mapping").c_str()) == false) {
-        Debug(Debug::ERROR) << par.db1 + "_mapping" << " does not exist. Please create the taxonomy mapping!\n";
-        EXIT(EXIT_FAILURE);
-    }
-    bool isSorted = Util::readMapping(par.db1 + "_mapping", mapping);
-    if (isSorted == false) {
-        std::stable_sort(mapping.begin(), mapping.end(), TaxonUtils::compareToFirstInt);
-    }
+    TaxonMapping mapping(par.db1);
     std::vector<std::string> ranks = Util::split(par.lcaRanks, ":");
 
-    DBReader<unsigned int> header(par.hdr1.c_str(), par.hdr1Index.c_str(), par.threads,
-                                  DBReader<unsigned int>::USE_DATA | DBReader<unsigned int>::USE_INDEX);
-    header.open(DBReader<unsigned int>::NOSORT);
-    header.readMmapedDataInMemory();
-
-    DBReader<unsigned int> sequences(par.db1.c_str(), par.db1Index.c_str(), par.threads, DBReader<unsigned int>::USE_INDEX|DBReader<unsigned int>::USE_DATA);
+    DBReader<unsigned int> sequences(par.db1.c_str(), par.db1Index.c_str(), par.threads, DBReader<unsigned int>::USE_INDEX);
     sequences.open(DBReader<unsigned int>::LINEAR_ACCCESS);
-    // build index of Ns
-    std::vector<int> vectorN;
-    vectorN.reserve(sequences.getSize()*2);
-    std::unordered_map<unsigned int, std::pair<size_t, size_t> > mapNOffset;
-    Debug::Progress progressIndex(sequences.getSize());
-    Debug(Debug::INFO) <<"Build N index!\n";
-    for(size_t i = 0; i < sequences.getSize(); i++){
-        progressIndex.updateProgress();
-
-        char * seq = sequences.getData(i, 0);
-        size_t start = vectorN.size();
-        bool isNState = false;
-        size_t seqLen = sequences.getSeqLen(i);
-        for(size_t j = 0; j < seqLen; j++){
-            if((seq[j] == 'N' || seq[j] == 'n') && isNState == false){
-                isNState = true;
-                vectorN.push_back(j);
-            }else{
-                isNState = false;
-            }
-        }
-        size_t end = vectorN.size();
-        mapNOffset[sequences.getDbKey(i)] = std::make_pair(start, end);
-    }
+    NRunIndex nRunIndex(par.db1, par.threads);
     DBReader<unsigned int> reader(par.db2.c_str(), par.db2Index.c_str(), par.threads,
                                   DBReader<unsigned int>::USE_DATA | DBReader<unsigned int>::USE_INDEX);
     reader.open(DBReader<unsigned int>::LINEAR_ACCCESS);
 
-    DBWriter writer(par.db3.c_str(), par.db3Index.c_str(), par.threads, par.compressed, reader.getDbtype());
+    // binary ContaminationRecord entries, convertallreport renders them into the final TSV
+    MpiDbSplit split(reader, par.db3, par.db3Index);
+    DBWriter writer(split.dataFile.c_str(), split.indexFile.c_str(), par.threads, false, Parameters::DBTYPE_GENERIC_DB);
     writer.open();
 
-    std::vector<std::string> blacklistStr = Util::split(par.blacklist, ",");
-    std::vector<int> blackList;
-    for (size_t i = 0; i < blacklistStr.size(); ++i) {
-        int currTaxa = Util::fast_atoi<int>(blacklistStr[i].c_str());
-        blackList.push_back(currTaxa);
-    }
+    KingdomLookup kingdomLookup(par.kingdoms, par.blacklist, *t);
+    const size_t taxTermCount = kingdomLookup.getTermCount();
 
-    Debug::Progress progress(reader.getSize());
+    Debug::Progress progress(split.size);
 #pragma omp parallel
     {
-        KingdomExpression kingdomExpression(par.kingdoms, *t);
-        size_t taxTermCount = kingdomExpression.getTaxTerms().size();
-        std::string resultData;
-        resultData.reserve(4096);
+        std::vector<ContaminationRecord> records;
         size_t *taxaCounter = new size_t[taxTermCount];
         unsigned int thread_idx = 0;
         std::vector<TaxonUtils::TaxonInformation> elements;
-        std::set<unsigned int> idDetected;
 #ifdef OPENMP
         thread_idx = (unsigned int) omp_get_thread_num();
 #endif
 
 #pragma omp for schedule(dynamic, 10)
-        for (size_t i = 0; i < reader.getSize(); ++i) {
+        for (size_t i = split.from; i < split.from + split.size; ++i) {
             progress.updateProgress();
-            resultData.clear();
+            records.clear();
             elements.clear();
-            idDetected.clear();
             unsigned int queryKey = reader.getDbKey(i);
 
             char *data = reader.getData(i, thread_idx);
@@ -135,7 +68,7 @@ int createallreport(int argc, const char **argv, const Command& command) {
                 continue;
             }
             // find taxonomical information
-            TaxonUtils::assignTaxonomy(elements, data, mapping, *t, kingdomExpression, blackList, taxaCounter, true);
+            TaxonUtils::assignTaxonomy(elements, data, mapping, kingdomLookup, taxaCounter, true);
             std::sort(elements.begin(), elements.end(), TaxonUtils::TaxonInformation::compareByDbKeyAndStart);
 
             size_t writePos = -1;
@@ -146,11 +79,9 @@ int createallreport(int argc, const char **argv, const Command& command) {
                     writePos++;
                     elements[writePos] = elements[i];
                 } else {
+                    // only the first interval of every target is reported
                     if (elements[i].start <= (elements[writePos].end + 1)) {
                         elements[writePos].end = std::max(elements[i].end, elements[writePos].end);
-                    } else {
-                        writePos++;
-                        elements[writePos] = elements[i];
                     }
                 }
                 prevKey = elements[i].dbKey;
@@ -162,38 +93,16 @@ int createallreport(int argc, const char **argv, const Command& command) {
             // recount
             for (size_t j = 0; j < writePos; j++) {
                 const unsigned int dbkey = elements[j].dbKey;
-
-                const bool existsAlready = idDetected.find(dbkey) != idDetected.end();
-                if (existsAlready == false) {
-                    idDetected.insert(dbkey);
-                    resultData.append(Util::parseFastaHeader(header.getDataByDBKey(dbkey, thread_idx)));
-                    resultData.push_back('\t');
-                    resultData.append(SSTR(elements[j].start));
-                    resultData.push_back('\t');
-                    resultData.append(SSTR(elements[j].end));
-                    resultData.push_back('\t');
-                    size_t dbSeqLen = sequences.getSeqLen(sequences.getId(dbkey));
-                    int leftNPos = -1;
-                    int rightNPos = -1;
-                    findLeftAndRightPos(std::min(elements[j].start, elements[j].end), std::max(elements[j].start, elements[j].end),
-                                        mapNOffset[dbkey], vectorN, leftNPos, rightNPos);
-                    int length = (rightNPos == -1 ? dbSeqLen : rightNPos) - (leftNPos == -1 ? 0 : leftNPos );
-                    resultData.append(SSTR(length));
-                    resultData.push_back('\t');
-                    resultData.append(SSTR(dbSeqLen));
-                    resultData.push_back('\t');
-                    resultData.append(SSTR(elements[j].termId));
-                    resultData.push_back('\t');
-                    const TaxonNode *node = t->taxonNode(elements[j].currTaxa, false);
-                    if (node == NULL) {
-                        resultData.append("Undef");
-                    } else {
-                        resultData.append(t->getString(node->nameIdx));
-                    }
-                    resultData.push_back('\n');
-                }
+                size_t dbSeqLen = sequences.getSeqLen(sequences.getId(dbkey));
+                int leftNPos = -1;
+                int rightNPos = -1;
+                nRunIndex.findLeftAndRightPos(dbkey, std::min(elements[j].start, elements[j].end),
+                                              std::max(elements[j].start, elements[j].end), leftNPos, rightNPos);
+                int length = (rightNPos == -1 ? dbSeqLen : rightNPos) - (leftNPos == -1 ? 0 : leftNPos );
+                records.emplace_back(dbkey, elements[j].start, elements[j].end, length, dbSeqLen,
+                                     elements[j].termId, elements[j].currTaxa);
             }
-            writer.writeData(resultData.c_str(), resultData.size(), queryKey, thread_idx);
+            writer.writeData(reinterpret_cast<const char *>(records.data()), records.size() * sizeof(ContaminationRecord), queryKey, thread_idx);
 
         }
         delete [] taxaCounter;
@@ -201,9 +110,8 @@ int createallreport(int argc, const char **argv, const Command& command) {
     Debug(Debug::INFO) << "\nDetected potentail conterminetaion in the following Taxons: \n" ;
 
     delete t;
-    writer.close();
+    split.close(writer);
     reader.close();
-    header.close();
     sequences.close();
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,17 @@
+#include "TaxonMapping.h"
+#include "Parameters.h"
+#include "Debug.h"
+#include "LocalParameters.h"
+
+int createdensetaxmapping(int argc, const char **argv, const Command& command) {
+    LocalParameters &par = LocalParameters::getLocalInstance();
+    par.parseParameters(argc, argv, command, true, 0, 0);
+
+    Debug(Debug::INFO) << "Build dense taxonomy mapping ...\n";
+    std::vector<unsigned int> dense;
+    TaxonMapping::buildDense(par.db1, dense);
+    if (TaxonMapping::writeDense(par.db1, dense) == false) {
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
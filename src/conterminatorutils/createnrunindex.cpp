@@ -0,0 +1,25 @@
+#include "NRunIndex.h"
+#include "Parameters.h"
+#include "DBReader.h"
+#include "Debug.h"
+#include "LocalParameters.h"
+
+int createnrunindex(int argc, const char **argv, const Command& command) {
+    LocalParameters &par = LocalParameters::getLocalInstance();
+    par.parseParameters(argc, argv, command, true, 0, 0);
+
+    DBReader<unsigned int> sequences(par.db1.c_str(), par.db1Index.c_str(), par.threads,
+                                     DBReader<unsigned int>::USE_INDEX | DBReader<unsigned int>::USE_DATA);
+    sequences.open(DBReader<unsigned int>::NOSORT);
+
+    Debug(Debug::INFO) << "Build N index ...\n";
+    std::vector<uint64_t> offsets;
+    std::vector<NRunIndex::Run> runs;
+    NRunIndex::build(sequences, offsets, runs);
+    sequences.close();
+    Debug(Debug::INFO) << "Found " << runs.size() << " N runs\n";
+    if (NRunIndex::write(par.db1, offsets, runs) == false) {
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
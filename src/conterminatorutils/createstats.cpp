@@ -22,15 +22,7 @@ int createstats(int argc, const char **argv, const Command& command) {
 
     NcbiTaxonomy * t = NcbiTaxonomy::openTaxonomy(par.db1);
 
-    std::vector<std::pair<unsigned int, unsigned int>> mapping;
-    if (FileUtil::fileExists(std::string(par.db1 + "_mapping").c_str()) == false) {
-        Debug(Debug::ERROR) << par.db1 + "_mapping" << " does not exist. Please create the taxonomy mapping!\n";
-        EXIT(EXIT_FAILURE);
-    }
-    bool isSorted = Util::readMapping(par.db1 + "_mapping", mapping);
-    if (isSorted == false) {
-        std::stable_sort(mapping.begin(), mapping.end(), TaxonUtils::compareToFirstInt);
-    }
+    TaxonMapping mapping(par.db1);
     std::vector<std::string> ranks = Util::split(par.lcaRanks, ":");
 
 //    DBReader<unsigned int> seqdb(par.db1.c_str(), par.db1Index.c_str(), par.threads, DBReader<unsigned int>::USE_INDEX);
@@ -53,18 +45,12 @@ int createstats(int argc, const char **argv, const Command& command) {
     DBWriter writer(par.db3.c_str(), par.db3Index.c_str(), par.threads, par.compressed, reader.getDbtype());
     writer.open();
 
-    std::vector<std::string> blacklistStr = Util::split(par.blacklist, ",");
-    std::vector<int> blackList;
-    for (size_t i = 0; i < blacklistStr.size(); ++i) {
-        int currTaxa = Util::fast_atoi<int>(blacklistStr[i].c_str());
-        blackList.push_back(currTaxa);
-    }
+    KingdomLookup kingdomLookup(par.kingdoms, par.blacklist, *t);
+    const size_t taxTermCount = kingdomLookup.getTermCount();
 
     Debug::Progress progress(reader.getSize());
 #pragma omp parallel
     {
-        KingdomExpression kingdomExpression(par.kingdoms, *t);
-        size_t taxTermCount = kingdomExpression.getTaxTerms().size();
         std::string resultData;
         resultData.reserve(4096);
         size_t *taxaCounter = new size_t[taxTermCount];
@@ -90,7 +76,7 @@ int createstats(int argc, const char **argv, const Command& command) {
             }
             // find taxonomical information
             memset(taxaCounter, 0, taxTermCount * sizeof(size_t));
-            TaxonUtils::assignTaxonomy(elements, data, mapping, *t, kingdomExpression, blackList, taxaCounter, true);
+            TaxonUtils::assignTaxonomy(elements, data, mapping, kingdomLookup, taxaCounter, true);
             // recount
             memset(taxaCounter, 0, taxTermCount * sizeof(size_t));
             for(size_t i = 0; i < elements.size(); i++){
@@ -0,0 +1,207 @@
+#include "Parameters.h"
+#include "FileUtil.h"
+#include "Debug.h"
+#include "Util.h"
+#include "LocalParameters.h"
+
+#include <random>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace {
+struct Clade {
+    int taxId;
+    const char *name;
+    const char *rank;
+    int parentTaxId;
+    // clades with the same term are not contaminants of each other, see the default --kingdoms
+    int termId;
+};
+
+// (Bacteria, Archaea), Fungi, Animalia, Plantae, Rest of Eukaryota
+const Clade clades[] = {
+        {2, "Bacteria", "superkingdom", 131567, 0},
+        {2157, "Archaea", "superkingdom", 131567, 0},
+        {4751, "Fungi", "kingdom", 33154, 1},
+        {33208, "Metazoa", "kingdom", 33154, 2},
+        {33090, "Viridiplantae", "kingdom", 2759, 3},
+        {2763, "Rhodophyta", "phylum", 2759, 4}
+};
+const size_t cladeCount = sizeof(clades) / sizeof(clades[0]);
+const int speciesTaxIdOffset = 1000000;
+const size_t lineWidth = 80;
+// a run of N every nRunDistance bases, so the N handling of createallreport is exercised
+const size_t nRunDistance = 25000;
+const size_t nRunLength = 100;
+
+// std::*_distribution is implementation defined, the modulo of the raw engine output is reproducible everywhere
+size_t uniform(std::mt19937_64 &rng, size_t n) {
+    return static_cast<size_t>(rng() % n);
+}
+
+void generateGenome(int seed, size_t speciesIdx, size_t length, std::string &genome) {
+    const char nucleotides[] = "ACGT";
+    std::mt19937_64 rng(static_cast<uint64_t>(seed) * 1000003ULL + speciesIdx);
+    genome.resize(length);
+    for (size_t pos = 0; pos < length; pos++) {
+        genome[pos] = (pos % nRunDistance >= nRunDistance / 2 && pos % nRunDistance < nRunDistance / 2 + nRunLength)
+                      ? 'N' : nucleotides[uniform(rng, 4)];
+    }
+}
+
+void generateProtein(int seed, size_t speciesIdx, size_t proteinIdx, std::string &protein) {
+    const char aminoAcids[] = "ACDEFGHIKLMNPQRSTVWY";
+    std::mt19937_64 rng((static_cast<uint64_t>(seed) * 1000003ULL + speciesIdx) * 1000003ULL + proteinIdx);
+    protein.resize(100 + uniform(rng, 300));
+    for (size_t pos = 0; pos < protein.size(); pos++) {
+        protein[pos] = aminoAcids[uniform(rng, 20)];
+    }
+}
+
+void writeFasta(FILE *handle, const std::string &id, const char *sequence, size_t length) {
+    fprintf(handle, ">%s\n", id.c_str());
+    for (size_t pos = 0; pos < length; pos += lineWidth) {
+        fwrite(sequence + pos, sizeof(char), std::min(lineWidth, length - pos), handle);
+        fputc('\n', handle);
+    }
+}
+
+FILE *openFile(const std::string &path) {
+    FILE *handle = fopen(path.c_str(), "w");
+    if (handle == NULL) {
+        Debug(Debug::ERROR) << "Could not open " << path << " for writing\n";
+        EXIT(EXIT_FAILURE);
+    }
+    return handle;
+}
+
+void closeFile(FILE *handle, const std::string &path) {
+    if (fclose(handle) != 0) {
+        Debug(Debug::ERROR) << "Could not write to " << path << "\n";
+        EXIT(EXIT_FAILURE);
+    }
+}
+}
+
+// Writes reproducible synthetic genomes and proteins of every default kingdom together with a taxonomy dump,
+// the taxon mapping files and the planted cross-kingdom contaminants. Nothing has to be downloaded.
+// Output: dna.fas dna.mapping dna_contaminants.tsv prots.fas prots.mapping prots_contaminants.tsv
+//         taxdump/{nodes,names,merged,delnodes}.dmp
+int createsyntheticbenchmark(int argc, const char **argv, const Command& command) {
+    LocalParameters &par = LocalParameters::getLocalInstance();
+    par.parseParameters(argc, argv, command, true, 0, 0);
+
+    const std::string outDir = par.db1;
+    const std::string taxDumpDir = outDir + "/taxdump";
+    if (FileUtil::directoryExists(outDir.c_str()) == false && FileUtil::makeDir(outDir.c_str()) == false) {
+        Debug(Debug::ERROR) << "Could not create directory " << outDir << "\n";
+        return EXIT_FAILURE;
+    }
+    if (FileUtil::directoryExists(taxDumpDir.c_str()) == false && FileUtil::makeDir(taxDumpDir.c_str()) == false) {
+        Debug(Debug::ERROR) << "Could not create directory " << taxDumpDir << "\n";
+        return EXIT_FAILURE;
+    }
+
+    const size_t speciesCount = cladeCount * par.genomesPerKingdom;
+    const size_t genomeLength = par.genomeLength;
+    const size_t contaminantLength = std::min(static_cast<size_t>(par.contaminantLength), genomeLength);
+    const size_t proteinsPerGenome = std::max(static_cast<size_t>(1), genomeLength / 1000);
+
+    // taxonomy
+    {
+        std::string nodesFile = taxDumpDir + "/nodes.dmp";
+        std::string namesFile = taxDumpDir + "/names.dmp";
+        FILE *nodes = openFile(nodesFile);
+        FILE *names = openFile(namesFile);
+        const Clade inner[] = {
+                {1, "root", "no rank", 1, -1},
+                {131567, "cellular organisms", "no rank", 1, -1},
+                {2759, "Eukaryota", "superkingdom", 131567, -1},
+                {33154, "Opisthokonta", "clade", 2759, -1}
+        };
+        for (size_t i = 0; i < sizeof(inner) / sizeof(inner[0]); i++) {
+            fprintf(nodes, "%d\t|\t%d\t|\t%s\t|\n", inner[i].taxId, inner[i].parentTaxId, inner[i].rank);
+            fprintf(names, "%d\t|\t%s\t|\t\t|\tscientific name\t|\n", inner[i].taxId, inner[i].name);
+        }
+        for (size_t i = 0; i < cladeCount; i++) {
+            fprintf(nodes, "%d\t|\t%d\t|\t%s\t|\n", clades[i].taxId, clades[i].parentTaxId, clades[i].rank);
+            fprintf(names, "%d\t|\t%s\t|\t\t|\tscientific name\t|\n", clades[i].taxId, clades[i].name);
+        }
+        for (size_t i = 0; i < speciesCount; i++) {
+            const Clade &clade = clades[i % cladeCount];
+            fprintf(nodes, "%d\t|\t%d\t|\tspecies\t|\n", static_cast<int>(speciesTaxIdOffset + i), clade.taxId);
+            fprintf(names, "%d\t|\tSynthetic %s %zu\t|\t\t|\tscientific name\t|\n", static_cast<int>(speciesTaxIdOffset + i), clade.name, i / cladeCount);
+        }
+        closeFile(nodes, nodesFile);
+        closeFile(names, namesFile);
+        closeFile(openFile(taxDumpDir + "/merged.dmp"), taxDumpDir + "/merged.dmp");
+        closeFile(openFile(taxDumpDir + "/delnodes.dmp"), taxDumpDir + "/delnodes.dmp");
+    }
+
+    // genomes and proteins
+    std::string dnaFastaFile = outDir + "/dna.fas";
+    std::string dnaMappingFile = outDir + "/dna.mapping";
+    std::string protFastaFile = outDir + "/prots.fas";
+    std::string protMappingFile = outDir + "/prots.mapping";
+    FILE *dnaFasta = openFile(dnaFastaFile);
+    FILE *dnaMapping = openFile(dnaMappingFile);
+    FILE *protFasta = openFile(protFastaFile);
+    FILE *protMapping = openFile(protMappingFile);
+    std::string sequence;
+    Debug::Progress progress(speciesCount);
+    for (size_t i = 0; i < speciesCount; i++) {
+        progress.updateProgress();
+        const int taxId = speciesTaxIdOffset + i;
+        std::string id = "syn" + SSTR(taxId) + "_1";
+        generateGenome(par.seed, i, genomeLength, sequence);
+        writeFasta(dnaFasta, id, sequence.c_str(), sequence.size());
+        fprintf(dnaMapping, "%s\t%d\n", id.c_str(), taxId);
+        for (size_t j = 0; j < proteinsPerGenome; j++) {
+            id = "syn" + SSTR(taxId) + "_p" + SSTR(j);
+            generateProtein(par.seed, i, j, sequence);
+            writeFasta(protFasta, id, sequence.c_str(), sequence.size());
+            fprintf(protMapping, "%s\t%d\n", id.c_str(), taxId);
+        }
+    }
+
+    // contaminants, a fragment of a genome (or a protein) of one kingdom becomes an entry of a species of another
+    std::string dnaTruthFile = outDir + "/dna_contaminants.tsv";
+    std::string protTruthFile = outDir + "/prots_contaminants.tsv";
+    FILE *dnaTruth = openFile(dnaTruthFile);
+    FILE *protTruth = openFile(protTruthFile);
+    std::mt19937_64 rng(par.seed);
+    for (int c = 0; c < par.contaminantCount && cladeCount > 1; c++) {
+        const size_t target = uniform(rng, speciesCount);
+        size_t source = uniform(rng, speciesCount);
+        while (clades[source % cladeCount].termId == clades[target % cladeCount].termId) {
+            source = uniform(rng, speciesCount);
+        }
+        const int targetTaxId = speciesTaxIdOffset + target;
+        const int sourceTaxId = speciesTaxIdOffset + source;
+
+        generateGenome(par.seed, source, genomeLength, sequence);
+        const size_t start = uniform(rng, genomeLength - contaminantLength + 1);
+        std::string id = "syn" + SSTR(targetTaxId) + "_contam" + SSTR(c);
+        writeFasta(dnaFasta, id, sequence.c_str() + start, contaminantLength);
+        fprintf(dnaMapping, "%s\t%d\n", id.c_str(), targetTaxId);
+        fprintf(dnaTruth, "%s\t%d\tsyn%d_1\t%d\t%zu\t%zu\n", id.c_str(), targetTaxId, sourceTaxId, sourceTaxId, start + 1, start + contaminantLength);
+
+        const size_t proteinIdx = uniform(rng, proteinsPerGenome);
+        generateProtein(par.seed, source, proteinIdx, sequence);
+        id = "syn" + SSTR(targetTaxId) + "_pcontam" + SSTR(c);
+        writeFasta(protFasta, id, sequence.c_str(), sequence.size());
+        fprintf(protMapping, "%s\t%d\n", id.c_str(), targetTaxId);
+        fprintf(protTruth, "%s\t%d\tsyn%d_p%zu\t%d\n", id.c_str(), targetTaxId, sourceTaxId, proteinIdx, sourceTaxId);
+    }
+    closeFile(dnaFasta, dnaFastaFile);
+    closeFile(dnaMapping, dnaMappingFile);
+    closeFile(protFasta, protFastaFile);
+    closeFile(protMapping, protMappingFile);
+    closeFile(dnaTruth, dnaTruthFile);
+    closeFile(protTruth, protTruthFile);
+
+    Debug(Debug::INFO) << "Wrote " << speciesCount << " genomes of length " << genomeLength << " and "
+                       << par.contaminantCount << " contaminants to " << outDir << "\n";
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,375 @@
+// include xxhash early to avoid incompatibilites with SIMDe
+#define XXH_INLINE_ALL
+#include "xxhash.h"
+
+#include "Parameters.h"
+#include "DBReader.h"
+#include "Debug.h"
+#include "Util.h"
+#include "FileUtil.h"
+#include "MemoryMapped.h"
+#include "LocalParameters.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <string.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+#ifdef OPENMP
+#include <omp.h>
+#endif
+
+namespace {
+const size_t EMPTY_SLOT = SIZE_MAX;
+const unsigned int NO_TAXON = UINT_MAX;
+const size_t MAX_MISSING_EXAMPLES = 10;
+const size_t MAPPING_BLOCK_SIZE = 64 * 1024 * 1024;
+
+// fields are split like awk does by default, at runs of blanks
+inline bool isBlank(char c) {
+    return c == ' ' || c == '\t';
+}
+
+// start of the next field of the line [pos, end), NULL if the line has no more fields
+const char *nextField(const char *pos, const char *end, size_t &length) {
+    while (pos < end && isBlank(*pos)) {
+        pos++;
+    }
+    if (pos == end) {
+        return NULL;
+    }
+    const char *fieldEnd = pos;
+    while (fieldEnd < end && isBlank(*fieldEnd) == false) {
+        fieldEnd++;
+    }
+    length = fieldEnd - pos;
+    return pos;
+}
+
+// second field of the line [pos, end), NULL if the line has less than two fields
+const char *secondField(const char *pos, const char *end, size_t &length) {
+    const char *first = nextField(pos, end, length);
+    return (first == NULL) ? NULL : nextField(first + length, end, length);
+}
+
+const char *lineEnd(const char *pos, const char *end) {
+    const char *newline = static_cast<const char *>(memchr(pos, '\n', end - pos));
+    return (newline == NULL) ? end : newline;
+}
+
+bool isNumber(const char *field, size_t length) {
+    for (size_t i = 0; i < length; ++i) {
+        if (field[i] < '0' || field[i] > '9') {
+            return false;
+        }
+    }
+    return length > 0;
+}
+
+// the field is not null terminated, the last line of a mapped file can end at the end of the mapping
+unsigned int parseUnsigned(const char *field, size_t length) {
+    unsigned int value = 0;
+    for (size_t i = 0; i < length && field[i] >= '0' && field[i] <= '9'; ++i) {
+        value = value * 10 + (field[i] - '0');
+    }
+    return value;
+}
+
+// offsets of chunks of about chunkSize bytes that start at a line start, the last offset is the size
+std::vector<size_t> lineChunks(const char *data, size_t size, size_t chunkSize) {
+    std::vector<size_t> offsets(1, 0);
+    while (offsets.back() + chunkSize < size) {
+        const size_t end = lineEnd(data + offsets.back() + chunkSize - 1, data + size) - data + 1;
+        if (end >= size) {
+            break;
+        }
+        offsets.push_back(end);
+    }
+    offsets.push_back(size);
+    return offsets;
+}
+
+size_t countLines(const char *pos, const char *end) {
+    size_t count = 0;
+    while (pos < end) {
+        pos = lineEnd(pos, end) + 1;
+        count++;
+    }
+    return count;
+}
+}
+
+// Joins a mapping file of "accession taxid" lines against the lookup of a sequenceDB, the same mapping as the awk
+// join of createtaxdb (--tax-mapping-mode 0) followed by createbintaxmapping. The last mapping line of an accession
+// wins, equal accessions in the lookup all get its taxon. The lookup accessions are kept in an open addressing table
+// of (hash fingerprint, line index) slots, the mapping file is streamed through it in parallel chunks.
+static bool joinMappingFile(const LocalParameters &par, std::vector<std::pair<unsigned int, unsigned int>> &pairs,
+                            size_t &missing, std::string &missingExamples) {
+    const std::string lookupFile = par.db1 + ".lookup";
+    MemoryMapped lookup(lookupFile, MemoryMapped::WholeFile, MemoryMapped::SequentialScan);
+    if (lookup.isValid() == false || lookup.size() == 0) {
+        Debug(Debug::ERROR) << "Could not open " << lookupFile << ", createdb has to write a lookup (--write-lookup 1)\n";
+        return false;
+    }
+    const char *lookupData = reinterpret_cast<const char *>(lookup.getData());
+    const char *lookupEnd = lookupData + lookup.size();
+
+    // line start of each lookup entry, the key and accession are parsed again from the line when needed
+    const std::vector<size_t> lookupChunks = lineChunks(lookupData, lookup.size(), 16 * 1024 * 1024);
+    const size_t lookupChunkCount = lookupChunks.size() - 1;
+    std::vector<size_t> chunkFirstLine(lookupChunkCount + 1, 0);
+#pragma omp parallel for schedule(dynamic, 1)
+    for (size_t i = 0; i < lookupChunkCount; ++i) {
+        chunkFirstLine[i + 1] = countLines(lookupData + lookupChunks[i], lookupData + lookupChunks[i + 1]);
+    }
+    for (size_t i = 0; i < lookupChunkCount; ++i) {
+        chunkFirstLine[i + 1] += chunkFirstLine[i];
+    }
+    const size_t entryCount = chunkFirstLine.back();
+    if (entryCount >= UINT_MAX) {
+        Debug(Debug::ERROR) << lookupFile << " has too many entries\n";
+        return false;
+    }
+
+    size_t capacity = 1;
+    while (capacity < 2 * entryCount) {
+        capacity *= 2;
+    }
+    const size_t mask = capacity - 1;
+    std::vector<size_t> lines(entryCount);
+    std::vector<size_t> slots(capacity, EMPTY_SLOT);
+#pragma omp parallel for schedule(dynamic, 1)
+    for (size_t i = 0; i < lookupChunkCount; ++i) {
+        const char *pos = lookupData + lookupChunks[i];
+        const char *end = lookupData + lookupChunks[i + 1];
+        for (size_t idx = chunkFirstLine[i]; pos < end; ++idx) {
+            const char *next = lineEnd(pos, end);
+            lines[idx] = pos - lookupData;
+            size_t length = 0;
+            const char *accession = secondField(pos, next, length);
+            if (accession != NULL) {
+                const size_t hash = XXH64(accession, length, 0);
+                const size_t value = ((hash >> 32) << 32) | idx;
+                size_t slot = hash & mask;
+                while (__sync_bool_compare_and_swap(&slots[slot], EMPTY_SLOT, value) == false) {
+                    slot = (slot + 1) & mask;
+                }
+            }
+            pos = next + 1;
+        }
+    }
+
+    // the mapping file is read in blocks, it can also be stdin, a pipe or a FIFO
+    const bool isStdin = (par.db2 == "stdin");
+    FILE *handle = isStdin ? stdin : FileUtil::openFileOrDie(par.db2.c_str(), "r", true);
+    std::vector<char> block(MAPPING_BLOCK_SIZE);
+    std::vector<unsigned int> taxa(entryCount, NO_TAXON);
+    size_t carry = 0;
+    bool eof = false;
+    while (eof == false) {
+        const size_t requested = block.size() - carry;
+        const size_t read = fread(block.data() + carry, sizeof(char), requested, handle);
+        eof = (read < requested);
+        const size_t size = carry + read;
+        // the last incomplete line is kept for the next block
+        size_t blockEnd = size;
+        if (eof == false) {
+            while (blockEnd > 0 && block[blockEnd - 1] != '\n') {
+                blockEnd--;
+            }
+            if (blockEnd == 0) {
+                block.resize(2 * block.size());
+                carry = size;
+                continue;
+            }
+        }
+        const char *blockData = block.data();
+
+        // (lookup line, taxon) matches per chunk, applied in file order so the last line wins
+        const std::vector<size_t> chunks = lineChunks(blockData, blockEnd, 1024 * 1024);
+        const size_t chunkCount = chunks.size() - 1;
+        std::vector<std::vector<std::pair<unsigned int, unsigned int>>> matches(chunkCount);
+#pragma omp parallel for schedule(dynamic, 1)
+        for (size_t i = 0; i < chunkCount; ++i) {
+            const char *pos = blockData + chunks[i];
+            const char *end = blockData + chunks[i + 1];
+            while (pos < end) {
+                const char *next = lineEnd(pos, end);
+                size_t length = 0;
+                const char *accession = nextField(pos, next, length);
+                if (accession != NULL) {
+                    size_t taxonLength = 0;
+                    const char *taxonField = nextField(accession + length, next, taxonLength);
+                    const unsigned int taxon = (taxonField == NULL) ? 0 : parseUnsigned(taxonField, taxonLength);
+                    const size_t hash = XXH64(accession, length, 0);
+                    const size_t fingerprint = (hash >> 32) << 32;
+                    for (size_t slot = hash & mask; slots[slot] != EMPTY_SLOT; slot = (slot + 1) & mask) {
+                        if ((slots[slot] & 0xFFFFFFFF00000000ULL) != fingerprint) {
+                            continue;
+                        }
+                        const unsigned int idx = static_cast<unsigned int>(slots[slot]);
+                        const char *line = lookupData + lines[idx];
+                        size_t lookupLength = 0;
+                        const char *lookupAccession = secondField(line, lineEnd(line, lookupEnd), lookupLength);
+                        if (lookupLength == length && memcmp(lookupAccession, accession, length) == 0) {
+                            matches[i].push_back(std::make_pair(idx, taxon));
+                        }
+                    }
+                }
+                pos = next + 1;
+            }
+        }
+        for (size_t i = 0; i < chunkCount; ++i) {
+            for (size_t j = 0; j < matches[i].size(); ++j) {
+                taxa[matches[i][j].first] = matches[i][j].second;
+            }
+        }
+
+        carry = size - blockEnd;
+        memmove(block.data(), block.data() + blockEnd, carry);
+    }
+    const bool readError = ferror(handle) != 0;
+    if (isStdin == false) {
+        fclose(handle);
+    }
+    if (readError) {
+        Debug(Debug::ERROR) << "Could not read " << par.db2 << "\n";
+        return false;
+    }
+
+    // (key, taxon) in lookup order like the awk join, the mapping is sorted by key as createbintaxmapping does
+    size_t missingExampleCount = 0;
+    bool isSorted = true;
+    for (size_t idx = 0; idx < entryCount; ++idx) {
+        const char *line = lookupData + lines[idx];
+        const char *end = lineEnd(line, lookupEnd);
+        size_t length = 0;
+        const char *accession = secondField(line, end, length);
+        if (accession == NULL) {
+            continue;
+        }
+        if (taxa[idx] == NO_TAXON) {
+            if (missingExampleCount < MAX_MISSING_EXAMPLES) {
+                missingExamples.append(" ").append(accession, length);
+                missingExampleCount++;
+            }
+            missing++;
+            continue;
+        }
+        size_t keyLength = 0;
+        const char *keyField = nextField(line, end, keyLength);
+        const unsigned int key = parseUnsigned(keyField, keyLength);
+        isSorted &= (pairs.empty() || key >= pairs.back().first);
+        pairs.push_back(std::make_pair(key, taxa[idx]));
+    }
+    lookup.close();
+    if (isSorted == false) {
+        std::stable_sort(pairs.begin(), pairs.end(),
+                         [](const std::pair<unsigned int, unsigned int> &lhs, const std::pair<unsigned int, unsigned int> &rhs) {
+                             return lhs.first < rhs.first;
+                         });
+    }
+    return true;
+}
+
+// The taxon of each entry is the word after the identifier in its header (e.g. "NC_000913.3 511145 Escherichia coli"),
+// a FASTA stream can carry its taxa this way instead of in a separate mapping file.
+static void headerMapping(const LocalParameters &par, std::vector<std::pair<unsigned int, unsigned int>> &pairs,
+                          size_t &missing, std::string &missingExamples) {
+    DBReader<unsigned int> headers(par.hdr1.c_str(), par.hdr1Index.c_str(), par.threads,
+                                   DBReader<unsigned int>::USE_INDEX | DBReader<unsigned int>::USE_DATA);
+    headers.open(DBReader<unsigned int>::NOSORT);
+    std::vector<unsigned int> taxa(headers.getSize(), NO_TAXON);
+#pragma omp parallel
+    {
+        unsigned int thread_idx = 0;
+#ifdef OPENMP
+        thread_idx = (unsigned int) omp_get_thread_num();
+#endif
+#pragma omp for schedule(dynamic, 100)
+        for (size_t i = 0; i < headers.getSize(); ++i) {
+            const char *header = headers.getData(i, thread_idx);
+            size_t length = 0;
+            const char *taxon = secondField(header, lineEnd(header, header + strlen(header)), length);
+            if (taxon != NULL && isNumber(taxon, length)) {
+                taxa[i] = parseUnsigned(taxon, length);
+            }
+        }
+    }
+
+    size_t missingExampleCount = 0;
+    bool isSorted = true;
+    for (size_t i = 0; i < headers.getSize(); ++i) {
+        if (taxa[i] == NO_TAXON) {
+            if (missingExampleCount < MAX_MISSING_EXAMPLES) {
+                missingExamples.append(" ").append(Util::parseFastaHeader(headers.getData(i, 0)));
+                missingExampleCount++;
+            }
+            missing++;
+            continue;
+        }
+        const unsigned int key = headers.getDbKey(i);
+        isSorted &= (pairs.empty() || key >= pairs.back().first);
+        pairs.push_back(std::make_pair(key, taxa[i]));
+    }
+    headers.close();
+    if (isSorted == false) {
+        std::sort(pairs.begin(), pairs.end());
+    }
+}
+
+// Writes the binary <sequenceDB>_mapping of a sequenceDB from a mapping file or, with --tax-from-header,
+// from taxa in the headers of the sequences, and reports the accessions without a taxon.
+int createtaxmapping(int argc, const char **argv, const Command &command) {
+    LocalParameters &par = LocalParameters::getLocalInstance();
+    par.parseParameters(argc, argv, command, true, 0, 0);
+
+    std::vector<std::pair<unsigned int, unsigned int>> pairs;
+    size_t missing = 0;
+    std::string missingExamples;
+    if (par.taxFromHeader) {
+        if (par.db2 != "stdin") {
+            Debug(Debug::WARNING) << "The taxa are taken from the headers, " << par.db2 << " is not read\n";
+        }
+        headerMapping(par, pairs, missing, missingExamples);
+    } else if (joinMappingFile(par, pairs, missing, missingExamples) == false) {
+        return EXIT_FAILURE;
+    }
+
+    const std::string source = par.taxFromHeader ? "the headers" : par.db2;
+    if (missing > 0) {
+        Debug(Debug::WARNING) << missing << " accessions of " << par.db1 << " have no taxon in " << source
+                              << ", e.g." << missingExamples << "\n";
+    }
+    Debug(Debug::INFO) << "Mapped " << pairs.size() << " of " << (pairs.size() + missing) << " accessions\n";
+    if (pairs.empty()) {
+        Debug(Debug::ERROR) << "None of the accessions of " << par.db1 << " has a taxon in " << source << "\n";
+        return EXIT_FAILURE;
+    }
+
+    //                               T  A   X   M  Version
+    const char magic[5] = {19, 0, 23, 12, 0};
+    const std::string mappingFile = par.db1 + "_mapping";
+    const std::string tmpFile = mappingFile + "_tmp_" + SSTR(getpid());
+    FILE *handle = fopen(tmpFile.c_str(), "w");
+    if (handle == NULL) {
+        Debug(Debug::ERROR) << "Could not open " << tmpFile << " for writing\n";
+        return EXIT_FAILURE;
+    }
+    bool success = fwrite(magic, sizeof(magic), 1, handle) == 1;
+    for (size_t i = 0; success && i < pairs.size(); ++i) {
+        const unsigned int pair[2] = { pairs[i].first, pairs[i].second };
+        success = fwrite(pair, sizeof(pair), 1, handle) == 1;
+    }
+    if (fclose(handle) != 0 || success == false) {
+        Debug(Debug::ERROR) << "Could not write to " << tmpFile << "\n";
+        return EXIT_FAILURE;
+    }
+    // a complete mapping only appears under its final name, an interrupted run is redone
+    FileUtil::move(tmpFile.c_str(), mappingFile.c_str());
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,111 @@
+#include "Parameters.h"
+#include "DBReader.h"
+#include "FastSort.h"
+#include "Debug.h"
+#include "Util.h"
+#include "LocalParameters.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+#include <climits>
+#include <string.h>
+
+#ifdef OPENMP
+#include <omp.h>
+#endif
+
+// Finds the unchanged entries between the sequenceDB of a previous run and a new sequenceDB, like diffseqdbs
+// with --use-seq-id. An entry is unchanged if an old entry has the same fasta id and an identical sequence,
+// changed sequences count as new. Writes one "oldKey\tnewKey" line per unchanged entry (see UpdateMapping.h).
+int createupdatemapping(int argc, const char **argv, const Command& command) {
+    LocalParameters &par = LocalParameters::getLocalInstance();
+    par.parseParameters(argc, argv, command, true, 0, 0);
+
+    DBReader<unsigned int> oldHeader(par.hdr1.c_str(), par.hdr1Index.c_str(), par.threads,
+                                     DBReader<unsigned int>::USE_INDEX | DBReader<unsigned int>::USE_DATA);
+    oldHeader.open(DBReader<unsigned int>::NOSORT);
+    DBReader<unsigned int> oldSeq(par.db1.c_str(), par.db1Index.c_str(), par.threads,
+                                  DBReader<unsigned int>::USE_INDEX | DBReader<unsigned int>::USE_DATA);
+    oldSeq.open(DBReader<unsigned int>::NOSORT);
+    DBReader<unsigned int> newHeader(par.hdr2.c_str(), par.hdr2Index.c_str(), par.threads,
+                                     DBReader<unsigned int>::USE_INDEX | DBReader<unsigned int>::USE_DATA);
+    newHeader.open(DBReader<unsigned int>::NOSORT);
+    DBReader<unsigned int> newSeq(par.db2.c_str(), par.db2Index.c_str(), par.threads,
+                                  DBReader<unsigned int>::USE_INDEX | DBReader<unsigned int>::USE_DATA);
+    newSeq.open(DBReader<unsigned int>::NOSORT);
+
+    // (hash of the fasta id, key) of the old entries, equal ids are verified on the strings
+    std::vector<std::pair<size_t, unsigned int>> oldIds(oldHeader.getSize());
+#pragma omp parallel
+    {
+        unsigned int thread_idx = 0;
+#ifdef OPENMP
+        thread_idx = (unsigned int) omp_get_thread_num();
+#endif
+#pragma omp for schedule(dynamic, 100)
+        for (size_t i = 0; i < oldHeader.getSize(); ++i) {
+            std::string id = Util::parseFastaHeader(oldHeader.getData(i, thread_idx));
+            oldIds[i] = std::make_pair(Util::hash(id.c_str(), id.size()), oldHeader.getDbKey(i));
+        }
+    }
+    SORT_PARALLEL(oldIds.begin(), oldIds.end());
+
+    std::vector<std::pair<unsigned int, unsigned int>> unchanged;
+    Debug::Progress progress(newHeader.getSize());
+#pragma omp parallel
+    {
+        unsigned int thread_idx = 0;
+#ifdef OPENMP
+        thread_idx = (unsigned int) omp_get_thread_num();
+#endif
+        std::vector<std::pair<unsigned int, unsigned int>> threadUnchanged;
+#pragma omp for schedule(dynamic, 100)
+        for (size_t i = 0; i < newHeader.getSize(); ++i) {
+            progress.updateProgress();
+            const unsigned int newKey = newHeader.getDbKey(i);
+            std::string id = Util::parseFastaHeader(newHeader.getData(i, thread_idx));
+            std::pair<size_t, unsigned int> value(Util::hash(id.c_str(), id.size()), 0);
+            std::vector<std::pair<size_t, unsigned int>>::const_iterator it = std::lower_bound(oldIds.begin(), oldIds.end(), value);
+            for (; it != oldIds.end() && it->first == value.first; ++it) {
+                const unsigned int oldKey = it->second;
+                if (Util::parseFastaHeader(oldHeader.getDataByDBKey(oldKey, thread_idx)) != id) {
+                    continue;
+                }
+                const size_t oldId = oldSeq.getId(oldKey);
+                const size_t newId = newSeq.getId(newKey);
+                if (oldId == UINT_MAX || newId == UINT_MAX || oldSeq.getSeqLen(oldId) != newSeq.getSeqLen(newId)) {
+                    break;
+                }
+                if (memcmp(oldSeq.getData(oldId, thread_idx), newSeq.getData(newId, thread_idx), newSeq.getSeqLen(newId)) == 0) {
+                    threadUnchanged.push_back(std::make_pair(newKey, oldKey));
+                }
+                break;
+            }
+        }
+#pragma omp critical
+        unchanged.insert(unchanged.end(), threadUnchanged.begin(), threadUnchanged.end());
+    }
+    SORT_PARALLEL(unchanged.begin(), unchanged.end());
+
+    FILE *out = fopen(par.db3.c_str(), "w");
+    if (out == NULL) {
+        Debug(Debug::ERROR) << "Could not open " << par.db3 << " for writing\n";
+        return EXIT_FAILURE;
+    }
+    for (size_t i = 0; i < unchanged.size(); i++) {
+        fprintf(out, "%u\t%u\n", unchanged[i].second, unchanged[i].first);
+    }
+    if (fclose(out) != 0) {
+        Debug(Debug::ERROR) << "Could not write to " << par.db3 << "\n";
+        return EXIT_FAILURE;
+    }
+    Debug(Debug::INFO) << "Unchanged: " << unchanged.size() << " new or changed: " << (newHeader.getSize() - unchanged.size())
+                       << " removed or changed: " << (oldHeader.getSize() - unchanged.size()) << "\n";
+
+    newSeq.close();
+    newHeader.close();
+    oldSeq.close();
+    oldHeader.close();
+    return EXIT_SUCCESS;
+}
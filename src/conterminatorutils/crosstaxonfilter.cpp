@@ -23,15 +23,7 @@ int crosstaxonfilter(int argc, const char **argv, const Command &command) {
     par.parseParameters(argc, argv, command, true, 0, 0);
 
 
-    std::vector<std::pair<unsigned int, unsigned int>> mapping;
-    if (FileUtil::fileExists(std::string(par.db1 + "_mapping").c_str()) == false) {
-        Debug(Debug::ERROR) << par.db1 + "_mapping" << " does not exist. Please create the taxonomy mapping!\n";
-        EXIT(EXIT_FAILURE);
-    }
-    bool isSorted = Util::readMapping(par.db1 + "_mapping", mapping);
-    if (isSorted == false) {
-        std::stable_sort(mapping.begin(), mapping.end(), TaxonUtils::compareToFirstInt);
-    }
+    TaxonMapping mapping(par.db1);
     std::vector<std::string> ranks = Util::split(par.lcaRanks, ":");
 
     DBReader<unsigned int> reader(par.db2.c_str(), par.db2Index.c_str(), par.threads,
@@ -45,17 +37,16 @@ int crosstaxonfilter(int argc, const char **argv, const Command &command) {
 
     Debug(Debug::INFO) << "Add taxonomy information ...\n";
 
-    std::vector<std::string> blacklistStr = Util::split(par.blacklist, ",");
-    std::vector<int> blackList;
-    for (size_t i = 0; i < blacklistStr.size(); ++i) {
-        int currTaxa = Util::fast_atoi<int>(blacklistStr[i].c_str());
-        blackList.push_back(currTaxa);
-    }
+    // a clustering result is filtered before the alignment, only clusters whose members span more than one
+    // kingdom term are kept and written unchanged. The alignment of a cluster reports a subset of its members,
+    // so this keeps every cluster that passes the filter of the alignment result.
+    const bool isClustering = Parameters::isEqualDbtype(reader.getDbtype(), Parameters::DBTYPE_CLUSTER_RES);
+
+    KingdomLookup kingdomLookup(par.kingdoms, par.blacklist, *t);
+    const size_t taxTermCount = kingdomLookup.getTermCount();
     Debug::Progress progress(reader.getSize());
 #pragma omp parallel
     {
-        KingdomExpression kingdomExpression(par.kingdoms, *t);
-        size_t taxTermCount = kingdomExpression.getTaxTerms().size();
         size_t *taxaCounter = new size_t[taxTermCount];
         std::vector<TaxonUtils::TaxonInformation> elements;
         char buffer[4096];
@@ -71,21 +62,12 @@ int crosstaxonfilter(int argc, const char **argv, const Command &command) {
             memset(taxaCounter, 0, taxTermCount * sizeof(size_t));
             unsigned int queryKey = reader.getDbKey(i);
 
-            unsigned int queryTaxon = TaxonUtils::getTaxon(queryKey, mapping);
+            unsigned int queryTaxon = mapping.lookup(queryKey);
             if(queryTaxon == 0 || queryTaxon == UINT_MAX ){
                 continue;
             }
-            unsigned int queryAncestorTermId = UINT_MAX;
-
-            for (size_t j = 0; j < taxTermCount; ++j) {
-                int taxIndex = kingdomExpression.isAncestorOf(queryTaxon);
-                if (taxIndex != -1) {
-                    queryAncestorTermId = taxIndex;
-                    break;
-                }
-            }
-
-            if (queryAncestorTermId == UINT_MAX) {
+            int taxIndex = kingdomLookup.getTermId(queryTaxon);
+            if (taxIndex == -1) {
                 continue;
             }
             char *data = reader.getData(i, thread_idx);
@@ -94,8 +76,27 @@ int crosstaxonfilter(int argc, const char **argv, const Command &command) {
             if (length == 1) {
                 continue;
             }
+            if (isClustering) {
+                int distinctTaxaCnt = 0;
+                while (*data != '\0' && distinctTaxaCnt < 2) {
+                    unsigned int memberTaxon = mapping.lookup(Util::fast_atoi<unsigned int>(data));
+                    if (memberTaxon != 0 && memberTaxon != UINT_MAX) {
+                        unsigned char kingdomValue = kingdomLookup.getValue(memberTaxon);
+                        int termId = KingdomLookup::isBlacklistedValue(kingdomValue) ? -1 : KingdomLookup::toTermId(kingdomValue);
+                        if (termId != -1 && taxaCounter[termId] == 0) {
+                            taxaCounter[termId] = 1;
+                            distinctTaxaCnt++;
+                        }
+                    }
+                    data = Util::skipLine(data);
+                }
+                if (distinctTaxaCnt > 1) {
+                    writer.writeData(reader.getData(i, thread_idx), length - 1, queryKey, thread_idx);
+                }
+                continue;
+            }
             // find taxonomical information
-            TaxonUtils::assignTaxonomy(elements, data, mapping, *t, kingdomExpression, blackList, taxaCounter);
+            TaxonUtils::assignTaxonomy(elements, data, mapping, kingdomLookup, taxaCounter);
             std::sort(elements.begin(), elements.end(), TaxonUtils::TaxonInformation::compareByTaxAndStart);
             int distinctTaxaCnt = 0;
 
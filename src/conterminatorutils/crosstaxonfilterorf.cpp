@@ -11,6 +11,7 @@
 #include <set>
 #include <omptl/omptl_algorithm>
 #include <mmseqs/src/commons/Orf.h>
+#include "MpiDbSplit.h"
 #include "LocalParameters.h"
 
 
@@ -20,17 +21,11 @@
 
 
 int crosstaxonfilterorf(int argc, const char **argv, const Command &command) {
+    MMseqsMPI::init(argc, argv);
+
     LocalParameters &par = LocalParameters::getLocalInstance();
     par.parseParameters(argc, argv, command, true, 0, 0);
-    std::vector<std::pair<unsigned int, unsigned int>> mapping;
-    if (FileUtil::fileExists(std::string(par.db1 + "_mapping").c_str()) == false) {
-        Debug(Debug::ERROR) << par.db1 + "_mapping" << " does not exist. Please create the taxonomy mapping!\n";
-        EXIT(EXIT_FAILURE);
-    }
-    bool isSorted = Util::readMapping(par.db1 + "_mapping", mapping);
-    if (isSorted == false) {
-        std::stable_sort(mapping.begin(), mapping.end(), TaxonUtils::compareToFirstInt);
-    }
+    TaxonMapping mapping(par.db1);
     std::vector<std::string> ranks = Util::split(par.lcaRanks, ":");
     DBReader<unsigned int> orfHeader(par.db2.c_str(), par.db2Index.c_str(), par.threads,
                                   DBReader<unsigned int>::USE_DATA | DBReader<unsigned int>::USE_INDEX);
@@ -39,22 +34,17 @@ int crosstaxonfilterorf(int argc, const char **argv, const Command &command) {
     DBReader<unsigned int> reader(par.db3.c_str(), par.db3Index.c_str(), par.threads,
                                   DBReader<unsigned int>::USE_DATA | DBReader<unsigned int>::USE_INDEX);
     reader.open(DBReader<unsigned int>::LINEAR_ACCCESS);
-    DBWriter writer(par.db4.c_str(), par.db4Index.c_str(), par.threads, par.compressed, reader.getDbtype());
+    MpiDbSplit split(reader, par.db4, par.db4Index);
+    DBWriter writer(split.dataFile.c_str(), split.indexFile.c_str(), par.threads, par.compressed, reader.getDbtype());
     writer.open();
 
     NcbiTaxonomy * t = NcbiTaxonomy::openTaxonomy(par.db1);
 
-    std::vector<std::string> blacklistStr = Util::split(par.blacklist, ",");
-    std::vector<int> blackList;
-    for (size_t i = 0; i < blacklistStr.size(); ++i) {
-        int currTaxa = Util::fast_atoi<int>(blacklistStr[i].c_str());
-        blackList.push_back(currTaxa);
-    }
-    Debug::Progress progress(reader.getSize());
+    KingdomLookup kingdomLookup(par.kingdoms, par.blacklist, *t);
+    const size_t taxTermCount = kingdomLookup.getTermCount();
+    Debug::Progress progress(split.size);
 #pragma omp parallel
     {
-        KingdomExpression kingdomExpression(par.kingdoms, *t);
-        size_t taxTermCount = kingdomExpression.getTaxTerms().size();
         size_t *taxaCounter = new size_t[taxTermCount];
         char buffer[4096];
         unsigned int thread_idx = 0;
@@ -63,18 +53,18 @@ int crosstaxonfilterorf(int argc, const char **argv, const Command &command) {
 #endif
 
 #pragma omp for schedule(dynamic, 10)
-        for (size_t i = 0; i < reader.getSize(); ++i) {
+        for (size_t i = split.from; i < split.from + split.size; ++i) {
             progress.updateProgress();
             memset(taxaCounter, 0, taxTermCount * sizeof(size_t));
             unsigned int queryKey = reader.getDbKey(i);
             char *queryHeader = orfHeader.getDataByDBKey(queryKey, thread_idx);
             Orf::SequenceLocation qloc = Orf::parseOrfHeader(queryHeader);
-            unsigned int queryTaxon = TaxonUtils::getTaxon(qloc.id, mapping);
+            unsigned int queryTaxon = mapping.lookup(qloc.id);
             if(queryTaxon == 0 || queryTaxon == UINT_MAX ){
                 continue;
             }
 
-            int queryAncestorTermId = kingdomExpression.isAncestorOf(queryTaxon);
+            int queryAncestorTermId = kingdomLookup.getTermId(queryTaxon);
 
             if (queryAncestorTermId == -1) {
                 continue;
@@ -93,9 +83,9 @@ int crosstaxonfilterorf(int argc, const char **argv, const Command &command) {
                 unsigned int targetKey = Util::fast_atoi<unsigned int>(buffer);
                 char *targetHeader = orfHeader.getDataByDBKey(targetKey, thread_idx);
                 Orf::SequenceLocation tlog = Orf::parseOrfHeader(targetHeader);
-                unsigned int targetTaxon = TaxonUtils::getTaxon(tlog.id, mapping);
+                unsigned int targetTaxon = mapping.lookup(tlog.id);
 
-                int targetAncestorTermId = kingdomExpression.isAncestorOf(targetTaxon);
+                int targetAncestorTermId = kingdomLookup.getTermId(targetTaxon);
 
                 if(targetAncestorTermId == -1){
                     dataToRead = Util::skipLine(dataToRead);
@@ -112,7 +102,7 @@ int crosstaxonfilterorf(int argc, const char **argv, const Command &command) {
     }
 
     delete t;
-    writer.close();
+    split.close(writer);
     reader.close();
     orfHeader.close();
     return EXIT_SUCCESS;
@@ -0,0 +1,94 @@
+#include "NcbiTaxonomy.h"
+#include "Parameters.h"
+#include "DBReader.h"
+#include "Debug.h"
+#include "Util.h"
+#include "SequenceWindows.h"
+#include "MMseqsMPI.h"
+#include "kmermatcher.h"
+#include "KingdomLookup.h"
+#include "TaxonMapping.h"
+#include "UpdateMapping.h"
+#include "LocalParameters.h"
+
+#ifdef OPENMP
+#include <omp.h>
+#endif
+
+// kmermatcher that only emits k-mer groups with members of different kingdom terms,
+// this replaces the kmermatcher + crosstaxonfilterorf steps of the DNA workflow
+int crosstaxonkmermatcher(int argc, const char **argv, const Command &command) {
+    MMseqsMPI::init(argc, argv);
+
+    LocalParameters &par = LocalParameters::getLocalInstance();
+    setLinearFilterDefault(&par);
+    par.parseParameters(argc, argv, command, true, 0, MMseqsParameter::COMMAND_CLUSTLINEAR);
+
+    DBReader<unsigned int> seqDbr(par.db2.c_str(), par.db2Index.c_str(), par.threads,
+                                  DBReader<unsigned int>::USE_INDEX | DBReader<unsigned int>::USE_DATA);
+    seqDbr.open(DBReader<unsigned int>::NOSORT);
+
+    // the term of each split sequence is the term of its contig
+    std::vector<unsigned char> termLabels(seqDbr.getLastKey() + 1, KMER_NO_LABEL);
+    // with --update-mapping a split sequence is new if its contig is new
+    std::vector<unsigned char> seqIsNew;
+    {
+        UpdateMapping *updateMapping = NULL;
+        if (par.updateMapping.empty() == false) {
+            updateMapping = new UpdateMapping(par.updateMapping);
+            seqIsNew.resize(termLabels.size(), 0);
+        }
+        TaxonMapping mapping(par.db1);
+        NcbiTaxonomy *t = NcbiTaxonomy::openTaxonomy(par.db1);
+        KingdomLookup kingdomLookup(par.kingdoms, par.blacklist, *t);
+        DBReader<unsigned int> contigReader(par.db1.c_str(), par.db1Index.c_str(), 1, DBReader<unsigned int>::USE_INDEX);
+        contigReader.open(DBReader<unsigned int>::NOSORT);
+        SequenceWindows windows(contigReader, par.maxSeqLen, par.sequenceOverlap);
+        if (windows.matches(seqDbr) == false) {
+            Debug(Debug::ERROR) << par.db2 << " does not contain the windows of " << par.db1
+                                << " for --max-seq-len " << par.maxSeqLen << " --sequence-overlap " << par.sequenceOverlap << "\n";
+            EXIT(EXIT_FAILURE);
+        }
+#pragma omp parallel for schedule(static)
+        for (size_t i = 0; i < windows.getContigCount(); ++i) {
+            const unsigned int contigKey = windows.getContigKey(i);
+            const bool isNew = (updateMapping != NULL) && updateMapping->isNew(contigKey);
+            int termId = -1;
+            unsigned int taxon = mapping.lookup(contigKey);
+            if (taxon != 0 && taxon != TaxonMapping::NO_TAXON) {
+                termId = kingdomLookup.getTermId(taxon);
+            }
+            const unsigned int firstWindow = windows.getFirstWindow(i);
+            for (unsigned int window = firstWindow; window < firstWindow + windows.getWindowCount(i); ++window) {
+                if (updateMapping != NULL) {
+                    seqIsNew[window] = isNew;
+                }
+                if (termId != -1) {
+                    termLabels[window] = static_cast<unsigned char>(termId);
+                }
+            }
+        }
+        contigReader.close();
+        delete t;
+        if (updateMapping != NULL) {
+            delete updateMapping;
+        }
+    }
+
+    setKmerLengthAndAlphabet(par, seqDbr.getAminoAcidDBSize(), seqDbr.getDbtype());
+    par.printParameters(command.cmd, argc, argv, *command.params);
+    Debug(Debug::INFO) << "Database size: " << seqDbr.getSize() << " type: " << seqDbr.getDbTypeName() << "\n";
+
+    // kmermatcherInner writes its result to db2
+    par.db2 = par.db3;
+    par.db2Index = par.db3Index;
+    const unsigned char *newLabels = seqIsNew.empty() ? NULL : seqIsNew.data();
+    if (seqDbr.getMaxSeqLen() < SHRT_MAX) {
+        kmermatcherInner<short>(par, seqDbr, termLabels.data(), newLabels);
+    } else {
+        kmermatcherInner<int>(par, seqDbr, termLabels.data(), newLabels);
+    }
+    seqDbr.close();
+
+    return EXIT_SUCCESS;
+}
@@ -9,7 +9,7 @@
 #include "Matcher.h"
 #include "IntervalArray.h"
 #include <set>
-#include <omptl/omptl_algorithm>
+#include "MpiDbSplit.h"
 #include "LocalParameters.h"
 
 
@@ -19,26 +19,21 @@
 
 
 int extractalignments(int argc, const char **argv, const Command& command) {
+    MMseqsMPI::init(argc, argv);
+
     LocalParameters &par = LocalParameters::getLocalInstance();
     par.parseParameters(argc, argv, command, true, 0, 0);
 
 
-    std::vector<std::pair<unsigned int, unsigned int>> mapping;
-    if (FileUtil::fileExists(std::string(par.db1 + "_mapping").c_str()) == false) {
-        Debug(Debug::ERROR) << par.db1 + "_mapping" << " does not exist. Please create the taxonomy mapping!\n";
-        EXIT(EXIT_FAILURE);
-    }
-    bool isSorted = Util::readMapping(par.db1 + "_mapping", mapping);
-    if (isSorted == false) {
-        std::stable_sort(mapping.begin(), mapping.end(), TaxonUtils::compareToFirstInt);
-    }
+    TaxonMapping mapping(par.db1);
     std::vector<std::string> ranks = Util::split(par.lcaRanks, ":");
 
     DBReader<unsigned int> reader(par.db2.c_str(), par.db2Index.c_str(), par.threads,
                                   DBReader<unsigned int>::USE_DATA | DBReader<unsigned int>::USE_INDEX);
     reader.open(DBReader<unsigned int>::LINEAR_ACCCESS);
 
-    DBWriter writer(par.db3.c_str(), par.db3Index.c_str(), 1, par.compressed, reader.getDbtype());
+    MpiDbSplit split(reader, par.db3, par.db3Index);
+    DBWriter writer(split.dataFile.c_str(), split.indexFile.c_str(), par.threads, par.compressed, reader.getDbtype());
     writer.open();
 
     NcbiTaxonomy * t = NcbiTaxonomy::openTaxonomy(par.db1);
@@ -46,12 +41,8 @@ int extractalignments(int argc, const char **argv, const Command& command) {
     Debug(Debug::INFO) << "Add taxonomy information ...\n";
 
 
-    std::vector<std::string> blacklistStr = Util::split(par.blacklist, ",");
-    std::vector<int> blackList;
-    for (size_t i = 0; i < blacklistStr.size(); ++i) {
-        int currTaxa = Util::fast_atoi<int>(blacklistStr[i].c_str());
-        blackList.push_back(currTaxa);
-    }
+    KingdomLookup kingdomLookup(par.kingdoms, par.blacklist, *t);
+    const size_t taxTermCount = kingdomLookup.getTermCount();
 
     struct Contamination{
         Contamination(unsigned int key, int start, int end, unsigned int len)
@@ -81,13 +72,31 @@ int extractalignments(int argc, const char **argv, const Command& command) {
         }
     };
 
-    std::vector<Contamination> allContaminations;
-    Debug::Progress progress(reader.getSize());
+    // at most --split-memory-limit of the mapped alignments are resident at a time,
+    // the entries are processed in batches and the mapping is released after each batch.
+    // The regions are written per query and never collected, an alignment line (~70 bytes) gives at most
+    // one 16 byte region, so the mapped input dominates the peak RSS and there are no sorted runs to spill
+    const size_t memoryLimit = Util::computeMemory(par.splitMemoryLimit);
+    std::vector<size_t> batchStarts(1, split.from);
+    size_t batchSize = 0;
+    for (size_t i = split.from; i < split.from + split.size; ++i) {
+        const size_t entryLen = reader.getEntryLen(i);
+        if (batchSize > 0 && batchSize + entryLen > memoryLimit) {
+            batchStarts.push_back(i);
+            batchSize = 0;
+        }
+        batchSize += entryLen;
+    }
+    batchStarts.push_back(split.from + split.size);
+    if (batchStarts.size() > 2) {
+        Debug(Debug::INFO) << "Process alignments in " << (batchStarts.size() - 1) << " batches\n";
+    }
+
+    Debug::Progress progress(split.size);
 #pragma omp parallel
     {
-        KingdomExpression kingdomExpression(par.kingdoms, *t);
-        size_t taxTermCount = kingdomExpression.getTaxTerms().size();
-        std::vector<Contamination> privateContaminations;
+        std::vector<Contamination> queryContaminations;
+        char buffer[4096];
         size_t *taxaCounter = new size_t[taxTermCount];
         IntervalArray ** speciesRanges = new IntervalArray*[taxTermCount];
         for(size_t i = 0; i < taxTermCount; i++){
@@ -100,76 +109,101 @@ int extractalignments(int argc, const char **argv, const Command& command) {
         thread_idx = (unsigned int) omp_get_thread_num();
 #endif
 
+        for (size_t batch = 0; batch + 1 < batchStarts.size(); ++batch) {
 #pragma omp for schedule(dynamic, 10)
-        for (size_t i = 0; i < reader.getSize(); ++i) {
-            progress.updateProgress();
-            elements.clear();
-            memset(taxaCounter, 0, taxTermCount * sizeof(size_t));
-            unsigned int queryKey = reader.getDbKey(i);
-            unsigned int queryLen = reader.getSeqLen(i);
-
-            unsigned int queryTaxon = TaxonUtils::getTaxon(queryKey, mapping);
-            if(queryTaxon == 0 || queryTaxon == UINT_MAX ){
-                continue;
-            }
-            unsigned int queryAncestorTermId = UINT_MAX;
-
-            for (size_t j = 0; j < taxTermCount; ++j) {
-                int taxIndex = kingdomExpression.isAncestorOf(queryTaxon);
-                if (taxIndex != -1) {
-                    queryAncestorTermId = taxIndex;
-                    break;
+            for (size_t i = batchStarts[batch]; i < batchStarts[batch + 1]; ++i) {
+                progress.updateProgress();
+                elements.clear();
+                memset(taxaCounter, 0, taxTermCount * sizeof(size_t));
+                unsigned int queryKey = reader.getDbKey(i);
+                unsigned int queryLen = reader.getSeqLen(i);
+
+                unsigned int queryTaxon = mapping.lookup(queryKey);
+                if(queryTaxon == 0 || queryTaxon == UINT_MAX ){
+                    continue;
                 }
-            }
-
-            if (queryAncestorTermId == UINT_MAX) {
-                continue;
-            }
-            char *data = reader.getData(i, thread_idx);
-            size_t length = reader.getSeqLen(i);
-
-            if (length == 1) {
-                continue;
-            }
-            // find taxonomical information
-            TaxonUtils::assignTaxonomy(elements, data, mapping, *t, kingdomExpression, blackList, taxaCounter);
-            std::sort(elements.begin(), elements.end(), TaxonUtils::TaxonInformation::compareByTaxAndStart);
-            int distinctTaxaCnt = 0;
-
-            // find max. taxa
-            for (size_t taxTermId = 0; taxTermId < taxTermCount; taxTermId++) {
-                bool hasTaxa = (taxaCounter[taxTermId] > 0);
-                distinctTaxaCnt += hasTaxa;
-            }
-            if (distinctTaxaCnt > 1) {
-                for (size_t i = 0; i < taxTermCount; i++) {
-                    speciesRanges[i]->reset();
+                int taxIndex = kingdomLookup.getTermId(queryTaxon);
+                if (taxIndex == -1) {
+                    continue;
                 }
+                unsigned int queryAncestorTermId = taxIndex;
+                char *data = reader.getData(i, thread_idx);
+                size_t length = reader.getSeqLen(i);
 
-                // fill up interval tree with elements
-                for (size_t elementIdx = 0; elementIdx < elements.size(); elementIdx++) {
-                    if (static_cast<unsigned int>(elements[elementIdx].termId) != queryAncestorTermId) {
-                        Matcher::result_t res = Matcher::parseAlignmentRecord(elements[elementIdx].data, true);
-                        speciesRanges[elements[elementIdx].termId]->insert(res.qStartPos, res.qEndPos);
-                    }
+                if (length == 1) {
+                    continue;
                 }
-                for (size_t i = 0; i < taxTermCount; i++) {
-                    speciesRanges[i]->buildRanges();
+                // find taxonomical information
+                TaxonUtils::assignTaxonomy(elements, data, mapping, kingdomLookup, taxaCounter);
+                std::sort(elements.begin(), elements.end(), TaxonUtils::TaxonInformation::compareByTaxAndStart);
+                int distinctTaxaCnt = 0;
+
+                // find max. taxa
+                for (size_t taxTermId = 0; taxTermId < taxTermCount; taxTermId++) {
+                    bool hasTaxa = (taxaCounter[taxTermId] > 0);
+                    distinctTaxaCnt += hasTaxa;
                 }
+                if (distinctTaxaCnt > 1) {
+                    for (size_t i = 0; i < taxTermCount; i++) {
+                        speciesRanges[i]->reset();
+                    }
 
-                for (size_t i = 0; i < taxTermCount; i++) {
-                    for (size_t j = 0; j < speciesRanges[i]->getRangesSize(); j++) {
-                        IntervalArray::Range range = speciesRanges[i]->getRange(j);
-                        privateContaminations.push_back(Contamination(queryKey, range.start, range.end, queryLen));
+                    // fill up interval tree with elements
+                    for (size_t elementIdx = 0; elementIdx < elements.size(); elementIdx++) {
+                        if (static_cast<unsigned int>(elements[elementIdx].termId) != queryAncestorTermId) {
+                            Matcher::result_t res = Matcher::parseAlignmentRecord(elements[elementIdx].data, true);
+                            speciesRanges[elements[elementIdx].termId]->insert(res.qStartPos, res.qEndPos);
+                        }
+                    }
+                    for (size_t i = 0; i < taxTermCount; i++) {
+                        speciesRanges[i]->buildRanges();
+                    }
+
+                    queryContaminations.clear();
+                    for (size_t i = 0; i < taxTermCount; i++) {
+                        for (size_t j = 0; j < speciesRanges[i]->getRangesSize(); j++) {
+                            IntervalArray::Range range = speciesRanges[i]->getRange(j);
+                            queryContaminations.push_back(Contamination(queryKey, range.start, range.end, queryLen));
+                        }
+                    }
+                    // merge the regions of all terms, a query is only processed by one thread
+                    // so its regions can be written directly
+                    std::sort(queryContaminations.begin(), queryContaminations.end(), Contamination::compareContaminationByKeyStartEnd);
+                    size_t writePos = 0;
+                    for (size_t j = 1; j < queryContaminations.size(); j++) {
+                        if (queryContaminations[j].start <= (queryContaminations[writePos].end + 1)) {
+                            queryContaminations[writePos].end = std::max(queryContaminations[j].end, queryContaminations[writePos].end);
+                        } else {
+                            writePos++;
+                            queryContaminations[writePos] = queryContaminations[j];
+                        }
+                    }
+                    if (queryContaminations.empty() == false) {
+                        queryContaminations.resize(writePos + 1);
+                    }
+                    for (size_t j = 0; j < queryContaminations.size(); j++) {
+                        const Contamination &contamination = queryContaminations[j];
+                        Matcher::result_t res(contamination.key, 255,
+                                              0.0, 0.0,
+                                              1.0, 0.0,
+                                              0,
+                                              contamination.start,
+                                              contamination.end,
+                                              contamination.len,
+                                              contamination.start,
+                                              contamination.end,
+                                              contamination.len, "");
+                        size_t len = Matcher::resultToBuffer(buffer, res, false, false);
+                        writer.writeData(buffer, len, contamination.key, thread_idx);
                     }
                 }
             }
+            // unmap the alignments of this batch before the next one is read
+#pragma omp single
+            if (batchStarts.size() > 2) {
+                reader.remapData();
+            }
         }
-
-#pragma omp critical
-        {
-            allContaminations.insert(allContaminations.end(), privateContaminations.begin(), privateContaminations.end());
-        };
         delete[] taxaCounter;
 
         for(size_t i = 0; i < taxTermCount; i++){
@@ -177,49 +211,8 @@ int extractalignments(int argc, const char **argv, const Command& command) {
         }
         delete [] speciesRanges;
     }
-
-    omptl::sort(allContaminations.begin(), allContaminations.end(), Contamination::compareContaminationByKeyStartEnd);
-    size_t writePos = -1;
-    unsigned int prevKey = UINT_MAX;
-
-    for(size_t i = 0; i < allContaminations.size(); i++){
-        if(prevKey != allContaminations[i].key){
-            writePos++;
-            allContaminations[writePos]=allContaminations[i];
-        }else{
-            if(allContaminations[i].start <= (allContaminations[writePos].end+1)){
-                allContaminations[writePos].end = std::max(allContaminations[i].end, allContaminations[writePos].end);
-            }else{
-                writePos++;
-                allContaminations[writePos]=allContaminations[i];
-            }
-        }
-        prevKey = allContaminations[i].key;
-    }
-    writePos++;
-    allContaminations.resize (writePos);
-
-    {
-        char buffer[4096];
-
-        for(size_t i = 0; i < allContaminations.size(); i++) {
-            Matcher::result_t res(allContaminations[i].key, 255,
-                                  0.0, 0.0,
-                                  1.0, 0.0,
-                                  0,
-                                  allContaminations[i].start,
-                                  allContaminations[i].end,
-                                  allContaminations[i].len,
-                                  allContaminations[i].start,
-                                  allContaminations[i].end,
-                                  allContaminations[i].len, "");
-            size_t len = Matcher::resultToBuffer(buffer, res, false, false);
-            //res.dbKey=overlappingAlnRes.
-            writer.writeData(buffer, len, allContaminations[i].key, 0);
-        }
-    }
     delete t;
-    writer.close();
+    split.close(writer);
     reader.close();
     return EXIT_SUCCESS;
 }
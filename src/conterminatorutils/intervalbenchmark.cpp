@@ -0,0 +1,205 @@
+#include "TaxonUtils.h"
+#include "NcbiTaxonomy.h"
+#include "Parameters.h"
+#include "Debug.h"
+#include "Util.h"
+#include "Matcher.h"
+#include "MathUtil.h"
+#include "IntervalArray.h"
+#include "LocalParameters.h"
+
+#include <chrono>
+#include <string.h>
+
+namespace {
+// previous IntervalArray: one bit per base, only kept to compare against
+class BitmapIntervalArray {
+public:
+    BitmapIntervalArray() {
+        array = (unsigned char *) calloc(1, sizeof(unsigned char));
+        arraySizeInBytes = 1;
+        maxSizeInByte = 8;
+    }
+
+    ~BitmapIntervalArray() {
+        free(array);
+    }
+
+    void reset() {
+        int ceilMax = MathUtil::ceilIntDivision(std::max(1, maxSizeInByte), 8);
+        memset(array, 0, ceilMax * sizeof(unsigned char));
+        ranges.clear();
+        maxSizeInByte = 0;
+    }
+
+    void insert(int low, int high) {
+        if (low > high) {
+            std::swap(low, high);
+        }
+        maxSizeInByte = std::max(high + 1, maxSizeInByte + 1);
+        int ceilMax = MathUtil::ceilIntDivision(maxSizeInByte, 8);
+        if (ceilMax >= arraySizeInBytes) {
+            int prevSize = arraySizeInBytes;
+            arraySizeInBytes = std::max(arraySizeInBytes * 2, ceilMax + 1);
+            array = (unsigned char *) realloc(array, arraySizeInBytes);
+            memset(array + prevSize, 0, arraySizeInBytes - prevSize);
+        }
+        if (isSet(low) && isSet(high)) {
+            return;
+        }
+        const unsigned char lowMask[8] = {0xFF, 0xFE, 0xFC, 0xF8, 0xF0, 0xE0, 0xC0, 0x80};
+        const unsigned char highMask[8] = {0x01, 0x03, 0x07, 0x0F, 0x1F, 0x3F, 0x7F, 0xFF};
+        unsigned int startPos = low / 8;
+        unsigned int endPos = high / 8;
+        for (size_t pos = startPos + 1; pos < endPos; pos++) {
+            array[pos] = 0xFF;
+        }
+        if (startPos == endPos) {
+            array[startPos] |= lowMask[low % 8] & highMask[high % 8];
+        } else {
+            array[startPos] |= lowMask[low % 8];
+            array[endPos] |= highMask[high % 8];
+        }
+    }
+
+    void buildRanges() {
+        bool started = false;
+        unsigned int startPos = 0;
+        unsigned int index = 0;
+        for (int pos = 0; pos <= maxSizeInByte; pos++) {
+            if (isSet(pos) && started == false) {
+                started = true;
+                startPos = pos;
+            }
+            if (isSet(pos) == false && started == true) {
+                started = false;
+                ranges.push_back(IntervalArray::Range(index, startPos, pos - 1));
+                index++;
+            }
+        }
+        if (started == true) {
+            ranges.push_back(IntervalArray::Range(index, startPos, maxSizeInByte - 1));
+        }
+    }
+
+    bool isSet(int pos) {
+        return array[pos / 8] & (1U << (pos % 8));
+    }
+
+    std::vector<IntervalArray::Range> ranges;
+
+private:
+    unsigned char *array;
+    int arraySizeInBytes;
+    int maxSizeInByte;
+};
+
+struct Hit {
+    Hit(int termId, int start, int end) : termId(termId), start(start), end(end) {}
+    int termId;
+    int start;
+    int end;
+};
+
+template<typename Intervals>
+double buildUnion(std::vector<Intervals *> &intervals, const std::vector<Hit> &hits) {
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < intervals.size(); i++) {
+        intervals[i]->reset();
+    }
+    for (size_t i = 0; i < hits.size(); i++) {
+        intervals[hits[i].termId]->insert(hits[i].start, hits[i].end);
+    }
+    for (size_t i = 0; i < intervals.size(); i++) {
+        intervals[i]->buildRanges();
+    }
+    std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+}
+
+// builds the per term hit unions of extractalignments with the bitmap and the interval
+// implementation for the real hits of an alignment result and reports the time of each
+int intervalbenchmark(int argc, const char **argv, const Command& command) {
+    LocalParameters &par = LocalParameters::getLocalInstance();
+    par.parseParameters(argc, argv, command, true, 0, 0);
+
+    TaxonMapping mapping(par.db1);
+    DBReader<unsigned int> reader(par.db2.c_str(), par.db2Index.c_str(), 1,
+                                  DBReader<unsigned int>::USE_DATA | DBReader<unsigned int>::USE_INDEX);
+    reader.open(DBReader<unsigned int>::LINEAR_ACCCESS);
+
+    NcbiTaxonomy * t = NcbiTaxonomy::openTaxonomy(par.db1);
+    KingdomLookup kingdomLookup(par.kingdoms, par.blacklist, *t);
+    const size_t taxTermCount = kingdomLookup.getTermCount();
+
+    std::vector<BitmapIntervalArray *> bitmaps;
+    std::vector<IntervalArray *> intervals;
+    for (size_t i = 0; i < taxTermCount; i++) {
+        bitmaps.push_back(new BitmapIntervalArray());
+        intervals.push_back(new IntervalArray());
+    }
+
+    size_t *taxaCounter = new size_t[taxTermCount];
+    std::vector<TaxonUtils::TaxonInformation> elements;
+    std::vector<Hit> hits;
+    double bitmapTime = 0.0;
+    double intervalTime = 0.0;
+    size_t queries = 0;
+    size_t totalHits = 0;
+    size_t bitmapRanges = 0;
+    size_t intervalRanges = 0;
+    size_t differentQueries = 0;
+    for (size_t i = 0; i < reader.getSize(); ++i) {
+        unsigned int queryTaxon = mapping.lookup(reader.getDbKey(i));
+        if (queryTaxon == 0 || queryTaxon == TaxonMapping::NO_TAXON) {
+            continue;
+        }
+        int queryTermId = kingdomLookup.getTermId(queryTaxon);
+        if (queryTermId == -1) {
+            continue;
+        }
+        memset(taxaCounter, 0, taxTermCount * sizeof(size_t));
+        TaxonUtils::assignTaxonomy(elements, reader.getData(i, 0), mapping, kingdomLookup, taxaCounter);
+        hits.clear();
+        for (size_t elementIdx = 0; elementIdx < elements.size(); elementIdx++) {
+            if (elements[elementIdx].termId != queryTermId) {
+                Matcher::result_t res = Matcher::parseAlignmentRecord(elements[elementIdx].data, true);
+                hits.push_back(Hit(elements[elementIdx].termId, res.qStartPos, res.qEndPos));
+            }
+        }
+        if (hits.empty()) {
+            continue;
+        }
+        queries++;
+        totalHits += hits.size();
+        bitmapTime += buildUnion(bitmaps, hits);
+        intervalTime += buildUnion(intervals, hits);
+
+        bool same = true;
+        for (size_t termId = 0; termId < taxTermCount; termId++) {
+            bitmapRanges += bitmaps[termId]->ranges.size();
+            intervalRanges += intervals[termId]->getRangesSize();
+            same = same && bitmaps[termId]->ranges.size() == intervals[termId]->getRangesSize();
+            for (size_t j = 0; same && j < intervals[termId]->getRangesSize(); j++) {
+                IntervalArray::Range range = intervals[termId]->getRange(j);
+                same = bitmaps[termId]->ranges[j].start == range.start && bitmaps[termId]->ranges[j].end == range.end;
+            }
+        }
+        differentQueries += (same == false);
+    }
+
+    Debug(Debug::INFO) << "Queries: " << queries << " hits: " << totalHits << "\n";
+    Debug(Debug::INFO) << "Bitmap:   " << bitmapTime << " s " << bitmapRanges << " ranges\n";
+    Debug(Debug::INFO) << "Interval: " << intervalTime << " s " << intervalRanges << " ranges\n";
+    Debug(Debug::INFO) << "Queries with different ranges: " << differentQueries << "\n";
+
+    for (size_t i = 0; i < taxTermCount; i++) {
+        delete bitmaps[i];
+        delete intervals[i];
+    }
+    delete[] taxaCounter;
+    delete t;
+    reader.close();
+    return EXIT_SUCCESS;
+}
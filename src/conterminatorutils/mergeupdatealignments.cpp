@@ -0,0 +1,103 @@
+#include "Parameters.h"
+#include "DBReader.h"
+#include "DBWriter.h"
+#include "Debug.h"
+#include "Util.h"
+#include "itoa.h"
+#include "UpdateMapping.h"
+#include "LocalParameters.h"
+
+#include <algorithm>
+#include <climits>
+#include <string.h>
+#include <vector>
+
+#ifdef OPENMP
+#include <omp.h>
+#endif
+
+// Merges the alignments of a previous run with the alignments of the new and changed sequences of an update.
+// The previous alignments are renumbered to the keys of the new sequenceDB, alignments from or to removed
+// and changed sequences are dropped. The update only aligns pairs with a new sequence, the few pairs of two unchanged
+// sequences it finds again (e.g. self hits) are taken from the previous run.
+int mergeupdatealignments(int argc, const char **argv, const Command& command) {
+    LocalParameters &par = LocalParameters::getLocalInstance();
+    par.parseParameters(argc, argv, command, true, 0, 0);
+
+    DBReader<unsigned int> oldReader(par.db1.c_str(), par.db1Index.c_str(), par.threads,
+                                     DBReader<unsigned int>::USE_INDEX | DBReader<unsigned int>::USE_DATA);
+    oldReader.open(DBReader<unsigned int>::NOSORT);
+    DBReader<unsigned int> newReader(par.db2.c_str(), par.db2Index.c_str(), par.threads,
+                                     DBReader<unsigned int>::USE_INDEX | DBReader<unsigned int>::USE_DATA);
+    newReader.open(DBReader<unsigned int>::NOSORT);
+    UpdateMapping mapping(par.db3);
+
+    DBWriter writer(par.db4.c_str(), par.db4Index.c_str(), par.threads, par.compressed, newReader.getDbtype());
+    writer.open();
+
+    const size_t keyCount = std::max(static_cast<size_t>(mapping.getLastNewKey()),
+                                     static_cast<size_t>(newReader.getSize() > 0 ? newReader.getLastKey() : 0)) + 1;
+    size_t keptAlignments = 0;
+    size_t droppedAlignments = 0;
+    Debug::Progress progress(keyCount);
+#pragma omp parallel reduction(+:keptAlignments, droppedAlignments)
+    {
+        unsigned int thread_idx = 0;
+#ifdef OPENMP
+        thread_idx = (unsigned int) omp_get_thread_num();
+#endif
+        std::string result;
+        std::vector<unsigned int> oldTargets;
+        char keyBuffer[16];
+#pragma omp for schedule(dynamic, 100)
+        for (size_t newKey = 0; newKey < keyCount; ++newKey) {
+            progress.updateProgress();
+            result.clear();
+            oldTargets.clear();
+            const unsigned int oldKey = mapping.newToOld(newKey);
+            const size_t oldId = (oldKey != UpdateMapping::NO_KEY) ? oldReader.getId(oldKey) : UINT_MAX;
+            if (oldId != UINT_MAX) {
+                const char *data = oldReader.getData(oldId, thread_idx);
+                while (*data != '\0') {
+                    const char *nextLine = Util::skipLine(const_cast<char *>(data));
+                    char *rest;
+                    const unsigned int target = static_cast<unsigned int>(strtoul(data, &rest, 10));
+                    const unsigned int newTarget = mapping.oldToNew(target);
+                    if (newTarget != UpdateMapping::NO_KEY) {
+                        char *end = Itoa::u32toa_sse2(newTarget, keyBuffer);
+                        result.append(keyBuffer, end - keyBuffer - 1);
+                        result.append(rest, nextLine - rest);
+                        oldTargets.push_back(newTarget);
+                        keptAlignments++;
+                    } else {
+                        droppedAlignments++;
+                    }
+                    data = nextLine;
+                }
+            }
+            const size_t newId = newReader.getId(newKey);
+            if (newId != UINT_MAX) {
+                std::sort(oldTargets.begin(), oldTargets.end());
+                const char *data = newReader.getData(newId, thread_idx);
+                while (*data != '\0') {
+                    const char *nextLine = Util::skipLine(const_cast<char *>(data));
+                    const unsigned int target = static_cast<unsigned int>(strtoul(data, NULL, 10));
+                    if (std::binary_search(oldTargets.begin(), oldTargets.end(), target) == false) {
+                        result.append(data, nextLine - data);
+                    }
+                    data = nextLine;
+                }
+            }
+            // like offsetalignment every sequence gets an entry, also without alignments
+            if (result.empty() == false || newId != UINT_MAX) {
+                writer.writeData(result.c_str(), result.size(), newKey, thread_idx);
+            }
+        }
+    }
+    writer.close();
+    Debug(Debug::INFO) << "Kept " << keptAlignments << " and dropped " << droppedAlignments << " previous alignments\n";
+
+    newReader.close();
+    oldReader.close();
+    return EXIT_SUCCESS;
+}
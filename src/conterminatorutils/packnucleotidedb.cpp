@@ -0,0 +1,62 @@
+#include "Parameters.h"
+#include "DBReader.h"
+#include "DBWriter.h"
+#include "Debug.h"
+#include "Util.h"
+#include "PackedNucleotides.h"
+#include "LocalParameters.h"
+
+#ifdef OPENMP
+#include <omp.h>
+#endif
+
+// Rewrites the sequences of a nucleotide sequenceDB with 2 bits per base (see PackedNucleotides.h),
+// DBReader decodes the entries on demand. Only data, index and dbtype are written, the workflow moves them over the input.
+int packnucleotidedb(int argc, const char **argv, const Command& command) {
+    LocalParameters &par = LocalParameters::getLocalInstance();
+    par.parseParameters(argc, argv, command, true, 0, 0);
+
+    DBReader<unsigned int> reader(par.db1.c_str(), par.db1Index.c_str(), par.threads,
+                                  DBReader<unsigned int>::USE_INDEX | DBReader<unsigned int>::USE_DATA);
+    reader.open(DBReader<unsigned int>::LINEAR_ACCCESS);
+    // zstd compressed entries (e.g. dna --compressed 1) are decompressed by getData and packed like plain entries
+    if (DBReader<unsigned int>::getExtendedDbtype(reader.getDbtype()) & Parameters::DBTYPE_EXTENDED_NUCL_PACKED) {
+        Debug(Debug::ERROR) << par.db1 << " is already packed\n";
+        return EXIT_FAILURE;
+    }
+
+    DBWriter writer(par.db2.c_str(), par.db2Index.c_str(), par.threads, 0, Parameters::DBTYPE_OMIT_FILE);
+    writer.open();
+    size_t plainSize = 0;
+    size_t packedSize = 0;
+    Debug::Progress progress(reader.getSize());
+#pragma omp parallel reduction(+:plainSize, packedSize)
+    {
+        unsigned int thread_idx = 0;
+#ifdef OPENMP
+        thread_idx = (unsigned int) omp_get_thread_num();
+#endif
+        std::string entry;
+#pragma omp for schedule(dynamic, 10)
+        for (size_t i = 0; i < reader.getSize(); ++i) {
+            progress.updateProgress();
+            const unsigned int key = reader.getDbKey(i);
+            entry.assign(sizeof(unsigned int), '\0');
+            PackedNucleotides::encode(reader.getData(i, thread_idx), reader.getSeqLen(i), entry);
+            // framed like a compressed entry, the index keeps the length of the plain entry
+            const unsigned int payloadSize = static_cast<unsigned int>(entry.size() - sizeof(unsigned int));
+            memcpy(&entry[0], &payloadSize, sizeof(unsigned int));
+            writer.writeData(entry.c_str(), entry.size(), key, thread_idx, true, false);
+            writer.writeIndexEntry(key, writer.getStart(thread_idx), reader.getEntryLen(i), thread_idx);
+            plainSize += reader.getEntryLen(i);
+            packedSize += entry.size() + 1;
+        }
+    }
+    writer.close(true);
+    const int dbtype = DBReader<unsigned int>::setExtendedDbtype(reader.getDbtype(), Parameters::DBTYPE_EXTENDED_NUCL_PACKED);
+    DBWriter::writeDbtypeFile(par.db2.c_str(), dbtype, true);
+    Debug(Debug::INFO) << "Packed " << plainSize << " bytes into " << packedSize << " bytes\n";
+
+    reader.close();
+    return EXIT_SUCCESS;
+}
@@ -1,13 +1,12 @@
 #include "TaxonUtils.h"
+#include "ContaminationRecord.h"
 #include "NcbiTaxonomy.h"
 #include "Parameters.h"
 #include "DBWriter.h"
 #include "FileUtil.h"
 #include "Debug.h"
 #include "Util.h"
-#include <omptl/omptl_algorithm>
-#include <set>
-#include <limits>
+#include "MpiDbSplit.h"
 
 #ifdef OPENMP
 #include <omp.h>
@@ -15,78 +14,63 @@
 
 
 int predictcontamination(int argc, const char **argv, const Command& command) {
+    MMseqsMPI::init(argc, argv);
+
     Parameters &par = Parameters::getInstance();
     // bacteria, archaea, eukaryotic, virus
     par.parseParameters(argc, argv, command, true, 0, 0);
 
-    DBReader<unsigned int> reader(par.db1.c_str(), par.db1Index.c_str(), par.threads,
+    NcbiTaxonomy * t = NcbiTaxonomy::openTaxonomy(par.db1);
+
+    DBReader<unsigned int> header(par.hdr1.c_str(), par.hdr1Index.c_str(), par.threads,
+                                  DBReader<unsigned int>::USE_DATA | DBReader<unsigned int>::USE_INDEX);
+    header.open(DBReader<unsigned int>::NOSORT);
+
+    // binary ContaminationRecord entries of createallreport
+    DBReader<unsigned int> reader(par.db2.c_str(), par.db2Index.c_str(), par.threads,
                                   DBReader<unsigned int>::USE_DATA | DBReader<unsigned int>::USE_INDEX);
     reader.open(DBReader<unsigned int>::LINEAR_ACCCESS);
 
-    DBWriter writer(par.db2.c_str(), par.db2Index.c_str(), par.threads, par.compressed, reader.getDbtype());
+    MpiDbSplit split(reader, par.db3, par.db3Index);
+    DBWriter writer(split.dataFile.c_str(), split.indexFile.c_str(), par.threads, par.compressed, Parameters::DBTYPE_GENERIC_DB);
     writer.open();
 
     int lenThreshold = 20000;
 
-    Debug::Progress progress(reader.getSize());
+    Debug::Progress progress(split.size);
 #pragma omp parallel
     {
         unsigned int thread_idx = 0;
 #ifdef OPENMP
         thread_idx = (unsigned int) omp_get_thread_num();
 #endif
-        const char * entry[255];
         std::string resultData;
         int * termLen = new int[256];
         int * termCount = new int[256];
-        std::map<int, std::string> longestId;
-        std::map<int, std::string> longestSpeciesName;
-        std::set<std::string> idDetected;
+        // record with the longest entry of each term
+        size_t * longestRecord = new size_t[256];
 #pragma omp for schedule(dynamic, 10)
-        for (size_t i = 0; i < reader.getSize(); ++i) {
+        for (size_t i = split.from; i < split.from + split.size; ++i) {
             progress.updateProgress();
             memset(termLen, 0, sizeof(int) * 256);
             memset(termCount, 0, sizeof(int) * 256);
-            longestId.clear();
-            longestSpeciesName.clear();
-            idDetected.clear();
             resultData.clear();
             unsigned int queryKey = reader.getDbKey(i);
-            char *data = reader.getData(i, thread_idx);
-            char *firstData = data;
+            const ContaminationRecord *records = reinterpret_cast<const ContaminationRecord *>(reader.getData(i, thread_idx));
+            const size_t recordCount = ContaminationRecord::getRecordCount(reader.getEntryLen(i));
             int maxTermId = -1;
-            while (*firstData != '\0') {
-                // NZ_BFCN01000401.1       244     392     453     453     0       Escherichia coli
-                const size_t columns = Util::getWordsOfLine(firstData, entry, 255);
-                if (columns == 0) {
-                    firstData = Util::skipLine(firstData);
-                    continue;
-                }
-                size_t len = entry[1] - entry[0];
-                const std::string fastaId(entry[0], len-1);
-                int startPos = Util::fast_atoi<int>(entry[1]);
-                int endPos = Util::fast_atoi<int>(entry[2]);
-                int nLen = Util::fast_atoi<int>(entry[3]);
-                int entryLen = Util::fast_atoi<int>(entry[4]);
-                int termId = Util::fast_atoi<int>(entry[5]);
-
-                int rightFlankingLen = ((entryLen - endPos) < lenThreshold) ? (entryLen - std::min(startPos, endPos)) : nLen;
-                int leftFlankingLen = (std::max(startPos, endPos) < lenThreshold) ? std::max(startPos, endPos) : nLen;
-                const int adjustedLen = std::min(std::min(rightFlankingLen, leftFlankingLen), nLen);
-                if (termLen[termId] == 0 || adjustedLen > termLen[termId]) {
-                    termLen[termId] = adjustedLen;
-                    longestId[termId] = fastaId;
-                    char * nextLine = Util::skipLine(firstData);
-                    std::string speciesName(entry[6], (nextLine - entry[6] - 1) );
-                    longestSpeciesName[termId] = speciesName;
-                }
-                const bool existsAlready = idDetected.find(fastaId) != idDetected.end();
-                if (existsAlready == false) {
-                    idDetected.insert(fastaId);
-                    termCount[termId]++;
+            // createallreport writes each sequence at most once per entry
+            for (size_t j = 0; j < recordCount; j++) {
+                const ContaminationRecord &record = records[j];
+                int rightFlankingLen = ((record.entryLen - record.end) < lenThreshold) ? (record.entryLen - std::min(record.start, record.end)) : record.nLen;
+                int leftFlankingLen = (std::max(record.start, record.end) < lenThreshold) ? std::max(record.start, record.end) : record.nLen;
+                const int adjustedLen = std::min(std::min(rightFlankingLen, leftFlankingLen), record.nLen);
+                if (termLen[record.termId] == 0 || adjustedLen > termLen[record.termId]) {
+                    termLen[record.termId] = adjustedLen;
+                    longestRecord[record.termId] = j;
                 }
-                maxTermId = std::max(termId, maxTermId);
-                firstData = Util::skipLine(firstData);
+                termCount[record.termId]++;
+                maxTermId = std::max(record.termId, maxTermId);
             }
 
             // predict direction of contamination based on entry length
@@ -102,53 +86,36 @@ int predictcontamination(int argc, const char **argv, const Command& command) {
                 }
             }
             if (notContermCnt == 1 && contermCnt >= 1) {
-                char *secondData = data;
-                while (*secondData != '\0') {
-                    const size_t columns = Util::getWordsOfLine(secondData, entry, 255);
-                    if (columns == 0) {
-                        secondData = Util::skipLine(secondData);
-                        continue;
-                    }
-
-                    int termId = Util::fast_atoi<int>(entry[5]);
-
+                const ContaminationRecord &notConterm = records[longestRecord[notContermId]];
+                for (size_t j = 0; j < recordCount; j++) {
+                    const ContaminationRecord &record = records[j];
                     // conterm
-                    if(termId != notContermId){
-                        size_t len = entry[1] - entry[0];
-                        std::string fastaId(entry[0], len-1);
-                        int startPos = Util::fast_atoi<int>(entry[1]);
-                        int endPos = Util::fast_atoi<int>(entry[2]);
-                        int nLen = Util::fast_atoi<int>(entry[3]);
-                        int entryLen = Util::fast_atoi<int>(entry[4]);
-                        char * nextLine = Util::skipLine(secondData);
-                        std::string speciesName(entry[6], (nextLine - entry[6] - 1) );
-
-                        int adjustedLen = ((entryLen - endPos) < lenThreshold) ? (entryLen - std::min(startPos, endPos)) : nLen;
-                        adjustedLen = ((entryLen - endPos) < lenThreshold) ? std::max(startPos, endPos) : adjustedLen;
-                        resultData.append(fastaId);
+                    if(record.termId != notContermId){
+                        int adjustedLen = ((record.entryLen - record.end) < lenThreshold) ? (record.entryLen - std::min(record.start, record.end)) : record.nLen;
+                        adjustedLen = ((record.entryLen - record.end) < lenThreshold) ? std::max(record.start, record.end) : adjustedLen;
+                        ContaminationRecord::appendFastaId(resultData, header, record.dbKey, thread_idx);
                         resultData.push_back('\t');
-                        resultData.append(SSTR(termId));
+                        ContaminationRecord::appendInt(resultData, record.termId);
                         resultData.push_back('\t');
-                        resultData.append(speciesName);
+                        resultData.append(ContaminationRecord::getSpeciesName(*t, record.taxId));
                         resultData.push_back('\t');
-                        resultData.append(SSTR(startPos));
+                        ContaminationRecord::appendInt(resultData, record.start);
                         resultData.push_back('\t');
-                        resultData.append(SSTR(endPos));
+                        ContaminationRecord::appendInt(resultData, record.end);
                         resultData.push_back('\t');
-                        resultData.append(SSTR(adjustedLen));
+                        ContaminationRecord::appendInt(resultData, adjustedLen);
                         resultData.push_back('\t');
-                        resultData.append(SSTR(longestId[notContermId]));
+                        ContaminationRecord::appendFastaId(resultData, header, notConterm.dbKey, thread_idx);
                         resultData.push_back('\t');
-                        resultData.append(SSTR(notContermId));
+                        ContaminationRecord::appendInt(resultData, notContermId);
                         resultData.push_back('\t');
-                        resultData.append(longestSpeciesName[notContermId]);
+                        resultData.append(ContaminationRecord::getSpeciesName(*t, notConterm.taxId));
                         resultData.push_back('\t');
-                        resultData.append(SSTR(termLen[notContermId]));
+                        ContaminationRecord::appendInt(resultData, termLen[notContermId]);
                         resultData.push_back('\t');
-                        resultData.append(SSTR(termCount[notContermId]));
+                        ContaminationRecord::appendInt(resultData, termCount[notContermId]);
                         resultData.push_back('\n');
                     }
-                    secondData = Util::skipLine(secondData);
                 }
                 if(resultData.size() > 0){
                     writer.writeData(resultData.c_str(), resultData.size(), queryKey, thread_idx);
@@ -157,11 +124,13 @@ int predictcontamination(int argc, const char **argv, const Command& command) {
             }
         }
         delete [] termLen;
+        delete [] termCount;
+        delete [] longestRecord;
     }
 
-    writer.close();
+    delete t;
+    split.close(writer);
     reader.close();
+    header.close();
     return EXIT_SUCCESS;
 }
-
-
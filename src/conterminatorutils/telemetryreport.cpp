@@ -0,0 +1,106 @@
+#include "Parameters.h"
+#include "Telemetry.h"
+#include "Debug.h"
+#include "Util.h"
+#include "LocalParameters.h"
+
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+void appendJson(std::string &out, const Telemetry::Record &record, size_t count) {
+    char buffer[1024];
+    snprintf(buffer, sizeof(buffer),
+             "\"wallTime\": %.3f, \"userTime\": %.3f, \"systemTime\": %.3f, \"maxRssKb\": %zu, \"trackedPeakBytes\": %zu, "
+             "\"bytesRead\": %zu, \"bytesWritten\": %zu, \"entriesIn\": %zu, \"entriesOut\": %zu",
+             record.wallTime, record.userTime, record.systemTime, record.maxRssKb, record.trackedPeakBytes,
+             record.bytesRead, record.bytesWritten, record.entriesIn, record.entriesOut);
+    out.append(buffer);
+    if (count > 0) {
+        out.append(", \"count\": ").append(SSTR(count));
+    }
+}
+
+// times, bytes and entries add up, memory is the maximum of the runs
+void add(Telemetry::Record &sum, const Telemetry::Record &record) {
+    sum.wallTime += record.wallTime;
+    sum.userTime += record.userTime;
+    sum.systemTime += record.systemTime;
+    sum.maxRssKb = std::max(sum.maxRssKb, record.maxRssKb);
+    sum.trackedPeakBytes = std::max(sum.trackedPeakBytes, record.trackedPeakBytes);
+    sum.bytesRead += record.bytesRead;
+    sum.bytesWritten += record.bytesWritten;
+    sum.entriesIn += record.entriesIn;
+    sum.entriesOut += record.entriesOut;
+}
+}
+
+// Aggregates the MMSEQS_TELEMETRY records of a workflow run into a JSON report with
+// every stage in the order it finished, the sum per command and the total of the run
+int telemetryreport(int argc, const char **argv, const Command& command) {
+    LocalParameters &par = LocalParameters::getLocalInstance();
+    par.parseParameters(argc, argv, command, true, 0, 0);
+
+    std::ifstream in(par.db1.c_str());
+    if (in.fail()) {
+        Debug(Debug::ERROR) << "Could not open " << par.db1 << "\n";
+        return EXIT_FAILURE;
+    }
+    std::vector<Telemetry::Record> records;
+    std::string line;
+    while (std::getline(in, line)) {
+        Telemetry::Record record;
+        if (Telemetry::parseRecord(line.c_str(), record)) {
+            records.push_back(record);
+        } else if (line.empty() == false) {
+            Debug(Debug::WARNING) << "Skipping invalid telemetry record: " << line << "\n";
+        }
+    }
+
+    const Telemetry::Record zero = {"", 0, 0, 0.0, 0.0, 0.0, 0, 0, 0, 0, 0, 0, 0};
+    Telemetry::Record total = zero;
+    std::vector<std::string> commandOrder;
+    std::map<std::string, std::pair<Telemetry::Record, size_t>> commands;
+    std::string json = "{\n  \"stages\": [";
+    for (size_t i = 0; i < records.size(); i++) {
+        const Telemetry::Record &record = records[i];
+        json.append(i == 0 ? "\n" : ",\n");
+        json.append("    {\"command\": \"").append(record.command).append("\", \"depth\": ").append(SSTR(record.depth));
+        json.append(", \"pid\": ").append(SSTR(record.pid)).append(", \"exitStatus\": ").append(SSTR(record.exitStatus)).append(", ");
+        appendJson(json, record, 0);
+        json.append("}");
+
+        std::map<std::string, std::pair<Telemetry::Record, size_t>>::iterator it = commands.find(record.command);
+        if (it == commands.end()) {
+            commandOrder.push_back(record.command);
+            it = commands.insert(std::make_pair(record.command, std::make_pair(zero, 0))).first;
+        }
+        add(it->second.first, record);
+        it->second.second++;
+        add(total, record);
+    }
+    json.append("\n  ],\n  \"commands\": [");
+    for (size_t i = 0; i < commandOrder.size(); i++) {
+        const std::pair<Telemetry::Record, size_t> &sum = commands[commandOrder[i]];
+        json.append(i == 0 ? "\n" : ",\n");
+        json.append("    {\"command\": \"").append(commandOrder[i]).append("\", ");
+        appendJson(json, sum.first, sum.second);
+        json.append("}");
+    }
+    json.append("\n  ],\n  \"total\": {");
+    appendJson(json, total, records.size());
+    json.append("}\n}\n");
+
+    FILE *out = fopen(par.db2.c_str(), "w");
+    if (out == NULL) {
+        Debug(Debug::ERROR) << "Could not open " << par.db2 << " for writing\n";
+        return EXIT_FAILURE;
+    }
+    if (fwrite(json.c_str(), sizeof(char), json.size(), out) != json.size() || fclose(out) != 0) {
+        Debug(Debug::ERROR) << "Could not write to " << par.db2 << "\n";
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,56 @@
+#include "Parameters.h"
+#include "DBReader.h"
+#include "DBWriter.h"
+#include "Debug.h"
+#include "Util.h"
+#include "MMseqsMPI.h"
+#include "SequenceWindows.h"
+#include "rescorediagonal.h"
+#include "MpiDbSplit.h"
+#include "LocalParameters.h"
+
+// rescorediagonal of the prefilter result of a window DB against itself (splitsequence with --max-seq-len and
+// --sequence-overlap) that writes one entry per contig with the alignments in contig coordinates.
+// The windows are mapped to their contigs with SequenceWindows, this replaces offsetalignment of the DNA workflow.
+int windowrescorediagonal(int argc, const char **argv, const Command &command) {
+    MMseqsMPI::init(argc, argv);
+    LocalParameters &par = LocalParameters::getLocalInstance();
+    par.parseParameters(argc, argv, command, true, 0, 0);
+
+    if (par.rescoreMode != Parameters::RESCORE_MODE_ALIGNMENT &&
+        par.rescoreMode != Parameters::RESCORE_MODE_END_TO_END_ALIGNMENT &&
+        par.rescoreMode != Parameters::RESCORE_MODE_WINDOW_QUALITY_ALIGNMENT) {
+        Debug(Debug::ERROR) << "windowrescorediagonal needs an alignment --rescore-mode (2, 3 or 4)\n";
+        return EXIT_FAILURE;
+    }
+
+    DBReader<unsigned int> contigReader(par.db1.c_str(), par.db1Index.c_str(), par.threads, DBReader<unsigned int>::USE_INDEX);
+    contigReader.open(DBReader<unsigned int>::NOSORT);
+    SequenceWindows windows(contigReader, par.maxSeqLen, par.sequenceOverlap);
+    {
+        DBReader<unsigned int> windowReader(par.db2.c_str(), par.db2Index.c_str(), 1, DBReader<unsigned int>::USE_INDEX);
+        windowReader.open(DBReader<unsigned int>::NOSORT);
+        if (windows.matches(windowReader) == false) {
+            Debug(Debug::ERROR) << par.db2 << " does not contain the windows of " << par.db1
+                                << " for --max-seq-len " << par.maxSeqLen << " --sequence-overlap " << par.sequenceOverlap << "\n";
+            return EXIT_FAILURE;
+        }
+        windowReader.close();
+    }
+
+    DBReader<unsigned int> resultReader(par.db3.c_str(), par.db3Index.c_str(), par.threads, DBReader<unsigned int>::USE_INDEX|DBReader<unsigned int>::USE_DATA);
+    resultReader.open(DBReader<unsigned int>::LINEAR_ACCCESS);
+
+    // the windows are query and target, the contig DB is only needed for the windows
+    par.db1 = par.db2;
+    par.db1Index = par.db2Index;
+    MpiDbSplit split(contigReader, par.db4, par.db4Index);
+    DBWriter writer(split.dataFile.c_str(), split.indexFile.c_str(), par.threads, par.compressed, Parameters::DBTYPE_ALIGNMENT_RES);
+    writer.open();
+    int status = doRescorediagonal(par, writer, resultReader, split.from, split.size, &windows);
+    split.close(writer);
+
+    resultReader.close();
+    contigReader.close();
+    return status;
+}
@@ -0,0 +1,114 @@
+#include <iostream>
+#include <string>
+#include <cstring>
+
+#include "DistanceCalculator.h"
+#include "NucleotideMatrix.h"
+#include "SubstitutionMatrix.h"
+#include "Parameters.h"
+#include "Debug.h"
+
+const char* binary_name = "test_nucleotidealignment";
+
+// the sequences must not depend on the rand() of the platform
+static unsigned int nextRandom(unsigned int &state) {
+    state = state * 1103515245u + 12345u;
+    return (state >> 16) & 0x7FFF;
+}
+
+static std::string randomSequence(unsigned int &state, size_t length, const std::string &letters) {
+    std::string seq(length, 'A');
+    for (size_t i = 0; i < length; i++) {
+        seq[i] = letters[nextRandom(state) % letters.size()];
+    }
+    return seq;
+}
+
+static std::string mutate(unsigned int &state, const std::string &seq, unsigned int mutationsPer1000, const std::string &letters) {
+    std::string mutated = seq;
+    for (size_t i = 0; i < mutated.size(); i++) {
+        if (nextRandom(state) % 1000 < mutationsPer1000) {
+            mutated[i] = letters[nextRandom(state) % letters.size()];
+        }
+    }
+    return mutated;
+}
+
+static bool isSame(const DistanceCalculator::LocalAlignment &a, const DistanceCalculator::LocalAlignment &b) {
+    return a.score == b.score && a.startPos == b.startPos && a.endPos == b.endPos;
+}
+
+int main (int, const char**) {
+    Parameters& par = Parameters::getInstance();
+    par.initMatrices();
+    NucleotideMatrix subMat(par.scoringMatrixFile.values.nucleotide().c_str(), 1.0, 0.0);
+    SubstitutionMatrix::FastMatrix fastMatrix = SubstitutionMatrix::createAsciiSubMat(subMat);
+    DistanceCalculator::NucleotideScoring scoring;
+    if (DistanceCalculator::initNucleotideScoring(scoring, subMat) == false) {
+        Debug(Debug::ERROR) << "nucleotide.out is not a match/mismatch matrix\n";
+        return EXIT_FAILURE;
+    }
+
+    // a mismatch in the middle of two match runs and a mismatch run that resets the local alignment
+    const char *fixedQuery  = "ACGTACGTTTTTGGGGCCCCAAAATTTT";
+    const char *fixedTarget = "ACGAACGTAAAAGGGGCCCCAAAATTTT";
+    DistanceCalculator::LocalAlignment fixed = DistanceCalculator::computeNucleotideStartEndDistance(
+            fixedQuery, fixedTarget, strlen(fixedQuery), scoring);
+    DistanceCalculator::LocalAlignment fixedReference = DistanceCalculator::computeSubstitutionStartEndDistance(
+            fixedQuery, fixedTarget, strlen(fixedQuery), fastMatrix.matrix);
+    std::cout << "fixed\t" << fixed.startPos << "\t" << fixed.endPos << "\t" << fixed.score << "\n";
+    if (isSame(fixed, fixedReference) == false || fixed.startPos != 12 || fixed.endPos != 27) {
+        Debug(Debug::ERROR) << "Wrong alignment of the fixed sequences\n";
+        return EXIT_FAILURE;
+    }
+
+    // upper case bases take the SIMD compare, IUPAC codes, lower case letters and N the letter classes
+    const std::string bases = "ACGT";
+    const std::string allLetters = "ACGTACGTACGTacgtNNRYKMn";
+    unsigned int state = 42;
+    size_t checked = 0;
+    for (size_t length = 1; length <= 300; length++) {
+        for (unsigned int round = 0; round < 8; round++) {
+            const std::string &letters = (round % 2 == 0) ? bases : allLetters;
+            const unsigned int mutationsPer1000 = (round < 4) ? 20 : 300;
+            const std::string query = randomSequence(state, length, letters);
+            const std::string target = mutate(state, query, mutationsPer1000, letters);
+            DistanceCalculator::LocalAlignment kernel = DistanceCalculator::computeNucleotideStartEndDistance(
+                    query.c_str(), target.c_str(), length, scoring);
+            DistanceCalculator::LocalAlignment reference = DistanceCalculator::computeSubstitutionStartEndDistance(
+                    query.c_str(), target.c_str(), length, fastMatrix.matrix);
+            if (isSame(kernel, reference) == false) {
+                Debug(Debug::ERROR) << "Mismatch kernel differs at length " << length << "\n"
+                                    << query << "\n" << target << "\n"
+                                    << kernel.startPos << " " << kernel.endPos << " " << kernel.score << " != "
+                                    << reference.startPos << " " << reference.endPos << " " << reference.score << "\n";
+                return EXIT_FAILURE;
+            }
+            checked++;
+        }
+    }
+
+    // both diagonal directions through the ungapped alignment that rescorediagonal calls
+    for (unsigned int round = 0; round < 200; round++) {
+        const std::string &letters = (round % 2 == 0) ? bases : allLetters;
+        const std::string query = randomSequence(state, 50 + nextRandom(state) % 400, letters);
+        const std::string target = randomSequence(state, 50 + nextRandom(state) % 400, letters);
+        const unsigned short diagonal = static_cast<unsigned short>(static_cast<int>(nextRandom(state) % 200) - 100);
+        DistanceCalculator::LocalAlignment kernel = DistanceCalculator::computeUngappedAlignment(
+                query.c_str(), query.size(), target.c_str(), target.size(), diagonal,
+                fastMatrix.matrix, Parameters::RESCORE_MODE_ALIGNMENT, &scoring);
+        DistanceCalculator::LocalAlignment reference = DistanceCalculator::computeUngappedAlignment(
+                query.c_str(), query.size(), target.c_str(), target.size(), diagonal,
+                fastMatrix.matrix, Parameters::RESCORE_MODE_ALIGNMENT);
+        if (isSame(kernel, reference) == false || kernel.distToDiagonal != reference.distToDiagonal) {
+            Debug(Debug::ERROR) << "Ungapped alignment differs on diagonal " << static_cast<short>(diagonal) << "\n";
+            return EXIT_FAILURE;
+        }
+        checked++;
+    }
+    std::cout << "checked\t" << checked << "\n";
+
+    delete[] fastMatrix.matrix;
+    delete[] fastMatrix.matrixData;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,80 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstring>
+
+#include "PackedNucleotides.h"
+#include "Debug.h"
+
+const char* binary_name = "test_packednucleotides";
+
+static unsigned int nextRandom(unsigned int &state) {
+    state = state * 1103515245u + 12345u;
+    return (state >> 16) & 0x7FFF;
+}
+
+static bool roundTrip(const std::string &seq) {
+    std::string payload;
+    PackedNucleotides::encode(seq.c_str(), seq.size(), payload);
+    std::vector<char> decoded(seq.size() + 2, 'X');
+    const size_t length = PackedNucleotides::decode(payload.c_str(), decoded.data());
+    if (length != seq.size() || memcmp(decoded.data(), seq.c_str(), seq.size()) != 0
+        || decoded[length] != '\n' || decoded[length + 1] != '\0') {
+        Debug(Debug::ERROR) << "Round trip failed for " << seq << "\n";
+        return false;
+    }
+    return true;
+}
+
+int main (int, const char**) {
+    // the payload layout is stored on disk and must not change
+    const std::string fixed = "ACGTNNacgtRA";
+    std::string payload;
+    PackedNucleotides::encode(fixed.c_str(), fixed.size(), payload);
+    const unsigned char expected[] = {
+            12, 0, 0, 0,  2, 0, 0, 0,  1, 0, 0, 0,       // length, exception runs, lower case runs
+            4, 0, 0, 0,  2, 0, 0, 0,  'N',                 // NN
+            10, 0, 0, 0,  1, 0, 0, 0,  'R',                // R
+            6, 0, 0, 0,  4, 0, 0, 0,                       // acgt
+            0xE4, 0x40, 0x0E                               // ACGT, AAAC, GTAA
+    };
+    if (payload.size() != sizeof(expected) || memcmp(payload.c_str(), expected, sizeof(expected)) != 0) {
+        Debug(Debug::ERROR) << "Unexpected payload of " << fixed << "\n";
+        return EXIT_FAILURE;
+    }
+    uint32_t start, length;
+    char letter;
+    PackedNucleotides::getException(payload.c_str(), 1, start, length, letter);
+    if (PackedNucleotides::getExceptionCount(payload.c_str()) != 2 || start != 10 || length != 1 || letter != 'R') {
+        Debug(Debug::ERROR) << "Wrong exception runs of " << fixed << "\n";
+        return EXIT_FAILURE;
+    }
+
+    const char *edgeCases[] = { "", "A", "N", "n", "ACG", "ACGT", "ACGTA", "NNNNNNNN", "acgtacgtacgt",
+                                "ACGTNnNnACGT", "RYKMSWBDHVN", "aNNNNa", "TTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTn" };
+    for (size_t i = 0; i < sizeof(edgeCases) / sizeof(edgeCases[0]); i++) {
+        if (roundTrip(edgeCases[i]) == false) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    // random sequences with N runs, IUPAC codes and lower case runs of every length modulo 4
+    const std::string letters = "ACGTACGTACGTACGTacgtNNNNRY";
+    unsigned int state = 7;
+    size_t checked = sizeof(edgeCases) / sizeof(edgeCases[0]);
+    for (size_t seqLen = 1; seqLen <= 1000; seqLen++) {
+        std::string seq(seqLen, 'A');
+        for (size_t pos = 0; pos < seqLen; pos++) {
+            seq[pos] = letters[nextRandom(state) % letters.size()];
+            if (pos > 0 && nextRandom(state) % 4 == 0) {
+                seq[pos] = seq[pos - 1];
+            }
+        }
+        if (roundTrip(seq) == false) {
+            return EXIT_FAILURE;
+        }
+        checked++;
+    }
+    std::cout << "checked\t" << checked << "\n";
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,117 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+
+#include "NcbiTaxonomy.h"
+#include "FileUtil.h"
+#include "Debug.h"
+
+const char* binary_name = "test_taxonomylca";
+
+static unsigned int nextRandom(unsigned int &state) {
+    state = state * 1103515245u + 12345u;
+    return (state >> 16) & 0x7FFF;
+}
+
+static TaxID naiveLca(const std::vector<TaxID> &parent, TaxID a, TaxID b) {
+    std::vector<bool> isAncestorOfA(parent.size(), false);
+    for (TaxID node = a; ; node = parent[node]) {
+        isAncestorOfA[node] = true;
+        if (node == 1) {
+            break;
+        }
+    }
+    TaxID node = b;
+    while (isAncestorOfA[node] == false) {
+        node = parent[node];
+    }
+    return node;
+}
+
+// compares LCA and IsAncestor of every pair of nodes with a walk up the parents
+static bool check(NcbiTaxonomy &taxonomy, const std::vector<TaxID> &parent, const std::vector<TaxID> &taxa) {
+    for (size_t i = 0; i < taxa.size(); i++) {
+        for (size_t j = 0; j < taxa.size(); j++) {
+            const TaxID expected = naiveLca(parent, taxa[i], taxa[j]);
+            if (taxonomy.LCA(taxa[i], taxa[j]) != expected) {
+                Debug(Debug::ERROR) << "Wrong LCA of " << taxa[i] << " and " << taxa[j] << "\n";
+                return false;
+            }
+            if (taxonomy.IsAncestor(taxa[i], taxa[j]) != (expected == taxa[i])) {
+                Debug(Debug::ERROR) << "Wrong IsAncestor of " << taxa[i] << " and " << taxa[j] << "\n";
+                return false;
+            }
+        }
+    }
+    // merged and unknown taxa
+    if (taxonomy.LCA(5, taxa.back()) != taxonomy.LCA(taxa[1], taxa.back())
+        || taxonomy.IsAncestor(taxa[1], 5) == false || taxonomy.IsAncestor(7, taxa[1])
+        || taxonomy.IsAncestor(taxa[1], 7) || taxonomy.LCA(7, taxa[1]) != taxa[1]) {
+        Debug(Debug::ERROR) << "Wrong result for a merged or unknown taxon\n";
+        return false;
+    }
+    return true;
+}
+
+int main (int, const char**) {
+    // a tree of long chains and wide nodes, the taxon IDs are sparse so D is not the identity
+    const size_t nodeCount = 300;
+    std::vector<TaxID> taxa(1, 1);
+    unsigned int state = 3;
+    for (size_t i = 1; i < nodeCount; i++) {
+        taxa.push_back(static_cast<TaxID>(10 + 3 * i));
+    }
+    std::vector<TaxID> parent(taxa.back() + 1, 0);
+    parent[1] = 1;
+    for (size_t i = 1; i < nodeCount; i++) {
+        const size_t parentIdx = (nextRandom(state) % 3 == 0) ? nextRandom(state) % i : i - 1;
+        parent[taxa[i]] = taxa[parentIdx];
+    }
+
+    const std::string prefix = "test_taxonomylca";
+    const char *suffixes[] = { "_nodes.dmp", "_names.dmp", "_merged.dmp", "_taxonomy" };
+    const size_t suffixCount = sizeof(suffixes) / sizeof(suffixes[0]);
+    // a taxonomy left by an aborted run would be opened instead of the new dump
+    for (size_t i = 0; i < suffixCount; i++) {
+        if (FileUtil::fileExists((prefix + suffixes[i]).c_str())) {
+            FileUtil::remove((prefix + suffixes[i]).c_str());
+        }
+    }
+    {
+        std::ofstream nodes((prefix + "_nodes.dmp").c_str());
+        std::ofstream names((prefix + "_names.dmp").c_str());
+        for (size_t i = 0; i < nodeCount; i++) {
+            nodes << taxa[i] << "\t|\t" << parent[taxa[i]] << "\t|\tno rank\t|\n";
+            names << taxa[i] << "\t|\ttaxon " << taxa[i] << "\t|\t\t|\tscientific name\t|\n";
+        }
+        // taxon 5 was merged into the second node, taxon 7 does not exist
+        std::ofstream merged((prefix + "_merged.dmp").c_str());
+        merged << 5 << "\t|\t" << taxa[1] << "\t|\n";
+    }
+
+    NcbiTaxonomy *taxonomy = NcbiTaxonomy::openTaxonomy(prefix);
+    const bool parsedOk = check(*taxonomy, parent, taxa);
+
+    // the serialized taxonomy is memory mapped and queried in place
+    std::pair<char *, size_t> serialized = NcbiTaxonomy::serialize(*taxonomy);
+    delete taxonomy;
+    FILE *handle = FileUtil::openFileOrDie((prefix + "_taxonomy").c_str(), "w", false);
+    fwrite(serialized.first, sizeof(char), serialized.second, handle);
+    fclose(handle);
+    free(serialized.first);
+    taxonomy = NcbiTaxonomy::openTaxonomy(prefix);
+    const bool mappedOk = check(*taxonomy, parent, taxa);
+    delete taxonomy;
+
+    for (size_t i = 0; i < suffixCount; i++) {
+        FileUtil::remove((prefix + suffixes[i]).c_str());
+    }
+    if (parsedOk == false || mappedOk == false) {
+        return EXIT_FAILURE;
+    }
+    std::cout << "checked\t" << (2 * nodeCount * nodeCount) << "\n";
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,85 @@
+#!/bin/sh -e
+# createdb reads plain FASTA files with one byte range per thread. The databases of --threads 4 have to be identical
+# to the single threaded reader, with and without --shuffle, for several input files and for inputs that fall back to
+# the single threaded reader (FASTQ, a FASTA line starting with '@').
+CONTERMINATOR="$1"
+OUT="$2/createdb"
+
+# deterministic records with single and multi line sequences, the same on every awk
+generate() {
+    awk -v count="$1" -v prefix="$2" -v format="$3" 'BEGIN {
+        split("A C G T", bases, " ")
+        x = prefix
+        for (i = 1; i <= count; i++) {
+            x = (x * 69069 + 1) % 4294967296
+            length_ = 20 + x % 300
+            seq = ""
+            for (j = 0; j < length_; j++) {
+                x = (x * 69069 + 1) % 4294967296
+                seq = seq bases[1 + int(x / 65536) % 4]
+            }
+            if (format == "fastq") {
+                quality = seq
+                gsub(/./, "I", quality)
+                printf("@%s_%d description %d\n%s\n+\n%s\n", prefix, i, i, seq, quality)
+                continue
+            }
+            printf(">%s_%d description %d\n", prefix, i, i)
+            while (i % 3 == 0 && length(seq) > 60) {
+                print substr(seq, 1, 60)
+                seq = substr(seq, 61)
+            }
+            print seq
+        }
+    }'
+}
+
+# compares every file of the databases written with 1 and 4 threads
+compareThreads() {
+    NAME="$1"
+    shift
+    for SHUFFLE in 0 1; do
+        "$CONTERMINATOR" createdb "$@" "$OUT/${NAME}_${SHUFFLE}_1" --threads 1 --shuffle "$SHUFFLE" --createdb-mode 1 -v 1
+        "$CONTERMINATOR" createdb "$@" "$OUT/${NAME}_${SHUFFLE}_4" --threads 4 --shuffle "$SHUFFLE" --createdb-mode 1 -v 2 \
+            > "$OUT/${NAME}_${SHUFFLE}_4.log" 2>&1
+        for SUFFIX in "" .index .dbtype _h _h.index _h.dbtype .lookup .source; do
+            if ! cmp "$OUT/${NAME}_${SHUFFLE}_1${SUFFIX}" "$OUT/${NAME}_${SHUFFLE}_4${SUFFIX}"; then
+                echo "createdb $NAME --shuffle $SHUFFLE: ${SUFFIX:-data} differs between 1 and 4 threads"
+                exit 1
+            fi
+        done
+    done
+}
+
+# the FASTA inputs have to be read in parallel and the fallback inputs by the single threaded reader,
+# otherwise the comparison would not cover the reader it is meant for
+expectReader() {
+    for SHUFFLE in 0 1; do
+        if grep -q "cannot be split at fasta records" "$OUT/${1}_${SHUFFLE}_4.log"; then
+            READER=serial
+        else
+            READER=parallel
+        fi
+        if [ "$READER" != "$2" ]; then
+            echo "createdb $1 --shuffle $SHUFFLE used the $READER reader instead of the $2 reader"
+            exit 1
+        fi
+    done
+}
+
+rm -rf "$OUT"
+mkdir -p "$OUT"
+generate 2000 11 fasta > "$OUT/a.fasta"
+generate 1500 12 fasta > "$OUT/b.fasta"
+generate 1000 13 fastq > "$OUT/c.fastq"
+sed 's/^>11_1200 /@11_1200 /' "$OUT/a.fasta" > "$OUT/at.fasta"
+
+compareThreads fasta "$OUT/a.fasta"
+expectReader fasta parallel
+compareThreads files "$OUT/a.fasta" "$OUT/b.fasta"
+expectReader files parallel
+compareThreads fastq "$OUT/c.fastq"
+expectReader fastq serial
+compareThreads at "$OUT/at.fasta"
+expectReader at serial
+rm -rf "$OUT"
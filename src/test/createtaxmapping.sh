@@ -0,0 +1,34 @@
+#!/bin/sh -e
+# Joins a small mapping file against a sequenceDB and compares the (key, taxon) pairs of the binary mapping with
+# data/taxmapping.expected. The mapping file, stdin and --tax-from-header have to give the same mapping: the last
+# line of an accession wins, duplicated accessions all get its taxon and missing.1 has no taxon in either source.
+CONTERMINATOR="$1"
+DATA="$2"
+OUT="$3/createtaxmapping"
+
+# skips the 5 magic bytes, the pairs are native endian unsigned ints
+dumpMapping() {
+    od -An -v -tu4 -j5 "$1" | awk '{ for (i = 1; i < NF; i += 2) { print $i"\t"$(i + 1) } }'
+}
+
+check() {
+    dumpMapping "$OUT/db_mapping" > "$OUT/$1.tsv"
+    if ! cmp -s "$OUT/$1.tsv" "$DATA/taxmapping.expected"; then
+        echo "createtaxmapping $1 differs from the expected mapping:"
+        diff "$DATA/taxmapping.expected" "$OUT/$1.tsv" || true
+        exit 1
+    fi
+    rm -f "$OUT/db_mapping"
+}
+
+rm -rf "$OUT"
+mkdir -p "$OUT"
+"$CONTERMINATOR" createdb "$DATA/taxmapping.fasta" "$OUT/db" -v 1
+
+"$CONTERMINATOR" createtaxmapping "$OUT/db" "$DATA/taxmapping.mapping" --threads 2 -v 1
+check file
+"$CONTERMINATOR" createtaxmapping "$OUT/db" stdin --threads 2 -v 1 < "$DATA/taxmapping.mapping"
+check stdin
+"$CONTERMINATOR" createtaxmapping "$OUT/db" stdin --tax-from-header 1 --threads 2 -v 1 < /dev/null
+check header
+rm -rf "$OUT"
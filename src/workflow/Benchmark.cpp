@@ -0,0 +1,42 @@
+#include "Util.h"
+#include "CommandCaller.h"
+#include "Debug.h"
+#include "FileUtil.h"
+#include "LocalParameters.h"
+#include "benchmark.sh.h"
+
+int benchmark(int argc, const char **argv, const Command &command) {
+    LocalParameters &par = LocalParameters::getLocalInstance();
+    par.parseParameters(argc, argv, command, true, 0, 0);
+
+    std::vector<std::string> scales = Util::split(par.benchmarkScales, ",");
+    std::string scaleList;
+    for (size_t i = 0; i < scales.size(); i++) {
+        if (scales[i].empty() || Util::isNumber(scales[i]) == false || Util::fast_atoi<int>(scales[i].c_str()) < 1) {
+            Debug(Debug::ERROR) << "Invalid scale " << scales[i] << " in --scales\n";
+            return EXIT_FAILURE;
+        }
+        scaleList.append(scaleList.empty() ? "" : " ").append(scales[i]);
+    }
+
+    std::string tmpDir = par.db2;
+    if (FileUtil::directoryExists(tmpDir.c_str()) == false && FileUtil::makeDir(tmpDir.c_str()) == false) {
+        Debug(Debug::ERROR) << "Could not create tmp directory " << tmpDir << "\n";
+        return EXIT_FAILURE;
+    }
+
+    CommandCaller cmd;
+    cmd.addVariable("SCALES", scaleList.c_str());
+    cmd.addVariable("GENOMES_PER_KINGDOM", SSTR(par.genomesPerKingdom).c_str());
+    // the genome count is set per scale by the script
+    std::vector<MMseqsParameter*> generate = par.removeParameter(par.createsyntheticbenchmark, par.PARAM_GENOMES_PER_KINGDOM);
+    cmd.addVariable("GENERATE_PAR", par.createParameterString(generate).c_str());
+    cmd.addVariable("THREADS_PAR", par.createParameterString(par.onlythreads).c_str());
+    cmd.addVariable("REMOVE_TMP", par.removeTmpFiles ? "TRUE" : NULL);
+
+    FileUtil::writeFile(tmpDir + "/benchmark.sh", benchmark_sh, benchmark_sh_len);
+    std::string program(tmpDir + "/benchmark.sh");
+    cmd.execProgram(program.c_str(), par.filenames);
+
+    return EXIT_SUCCESS;
+}
@@ -1,11 +1,19 @@
 #include "DBReader.h"
+#include "MemoryDatabase.h"
 #include "Util.h"
 #include "CommandCaller.h"
 #include "Debug.h"
 #include "FileUtil.h"
 #include "LocalParameters.h"
+#include "Timer.h"
+#include "Telemetry.h"
 #include "conterminatordna.sh.h"
 
+#include <fstream>
+#include <sys/stat.h>
+
+extern Command *getCommandByName(const char *s);
+
 void setConterminatorWorkflowDefaults(LocalParameters *p) {
     p->alignmentMode = Parameters::ALIGNMENT_MODE_SCORE_COV_SEQID;
     p->addBacktrace = true;
@@ -58,6 +66,295 @@ void setConterminatorWorkflowDefaults(LocalParameters *p) {
     p->blacklist = "10239,12908,28384,81077,11632,340016,61964,48479,48510";
 }
 
+// runs a module of this binary inside the current process
+// every stage parses its own parameter string, like a separate process started by the workflow script would
+static void runStage(const char *name, const std::vector<std::string> &dbs, const std::string &parameters) {
+    Command *command = getCommandByName(name);
+    if (command == NULL) {
+        Debug(Debug::ERROR) << "Module " << name << " not found\n";
+        EXIT(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < command->params->size(); ++i) {
+        command->params->at(i)->wasSet = false;
+    }
+    std::vector<std::string> args(dbs);
+    std::vector<std::string> parameterList = Util::split(parameters, " ");
+    args.insert(args.end(), parameterList.begin(), parameterList.end());
+    std::vector<const char *> argv;
+    for (size_t i = 0; i < args.size(); ++i) {
+        if (args[i].empty() == false) {
+            argv.push_back(args[i].c_str());
+        }
+    }
+    Timer timer;
+    Telemetry::begin(name);
+    int status = command->commandFunction(static_cast<int>(argv.size()), argv.data(), *command);
+    // the peak RSS of a stage includes the stages before it, they share the process
+    Telemetry::end(status);
+    if (status != EXIT_SUCCESS) {
+        Debug(Debug::ERROR) << name << " step died\n";
+        EXIT(EXIT_FAILURE);
+    }
+    Debug(Debug::INFO) << "Time for " << name << ": " << timer.lap() << "\n";
+}
+
+static bool notExists(const std::string &file) {
+    return FileUtil::fileExists(file.c_str()) == false;
+}
+
+// true if file was modified after reference, e.g. an input that a rerun rebuilt after the derived file
+static bool isNewer(const std::string &file, const std::string &reference) {
+    struct stat fileStat;
+    struct stat referenceStat;
+    if (stat(file.c_str(), &fileStat) != 0 || stat(reference.c_str(), &referenceStat) != 0) {
+        return false;
+    }
+#ifdef __APPLE__
+    const struct timespec &fileTime = fileStat.st_mtimespec;
+    const struct timespec &referenceTime = referenceStat.st_mtimespec;
+#else
+    const struct timespec &fileTime = fileStat.st_mtim;
+    const struct timespec &referenceTime = referenceStat.st_mtim;
+#endif
+    if (fileTime.tv_sec != referenceTime.tv_sec) {
+        return fileTime.tv_sec > referenceTime.tv_sec;
+    }
+    return fileTime.tv_nsec > referenceTime.tv_nsec;
+}
+
+// the second search needs consecutive keys for the contaminated regions
+static void renumberIndex(const std::string &db) {
+    MemoryDatabase::Entry *memory = MemoryDatabase::find(db.c_str());
+    if (memory != NULL) {
+        for (size_t i = 0; i < memory->index.size(); i++) {
+            memory->index[i].id = i + 1;
+        }
+        memory->isSortedById = true;
+        return;
+    }
+    const std::string index = db + ".index";
+    FileUtil::copyFile(index, index.substr(0, index.size() - 6) + ".old.index");
+    std::ifstream in(index);
+    if (in.fail()) {
+        Debug(Debug::ERROR) << "Could not open " << index << "\n";
+        EXIT(EXIT_FAILURE);
+    }
+    std::string renumbered;
+    std::string line;
+    size_t lineNumber = 1;
+    while (std::getline(in, line)) {
+        std::vector<std::string> columns = Util::split(line, "\t");
+        if (columns.size() < 3) {
+            Debug(Debug::ERROR) << "Invalid index entry in " << index << "\n";
+            EXIT(EXIT_FAILURE);
+        }
+        renumbered.append(SSTR(lineNumber));
+        renumbered.push_back('\t');
+        renumbered.append(columns[1]);
+        renumbered.push_back('\t');
+        renumbered.append(columns[2]);
+        renumbered.push_back('\n');
+        lineNumber++;
+    }
+    in.close();
+    FILE *handle = FileUtil::openFileOrDie(index.c_str(), "w", true);
+    if (fwrite(renumbered.c_str(), sizeof(char), renumbered.size(), handle) != renumbered.size()) {
+        Debug(Debug::ERROR) << "Could not write " << index << "\n";
+        EXIT(EXIT_FAILURE);
+    }
+    fclose(handle);
+}
+
+struct DnaStageParameters {
+    std::string createdb;
+    std::string createtaxmapping;
+    std::string onlyVerbosity;
+    std::string createtaxdbNcbiTaxDump;
+    std::string splitsequence;
+    std::string kmermatcher;
+    std::string rescorediagonal1;
+    std::string extractalignments;
+    std::string threads;
+    std::string extractframes;
+    std::string prefilter;
+    std::string rescorediagonal2;
+    std::string rescorediagonal2Swap;
+    std::string indexdb;
+    std::string createstats;
+    std::string threadsCompression;
+    bool packSequences;
+    // directory of the cached db_rev_split indices for --index-cache, empty otherwise
+    std::string indexCache;
+    // tmpDir of the previous run for --update, empty otherwise
+    std::string updateDir;
+};
+
+// same stages as conterminatordna.sh, but the modules are called directly instead of starting
+// one process per stage. sequencedb and its headers are opened once and shared by all stages after packing.
+// pref_cross and contam_region only live until their last reader ran, they are kept in memory (MemoryDatabase).
+// All other results are databases in the tmp directory, so an interrupted run can be resumed by either mode.
+// The file names are copies, every stage parses its arguments into the shared parameter instance.
+static int runConterminatordnaInProcess(const std::string fasta, const std::string mappingFile, const std::string result,
+                                        const std::string &tmpDir, const DnaStageParameters &p, bool removeTmpFiles) {
+    const std::string seqDb = tmpDir + "/sequencedb";
+    const std::string splitDb = tmpDir + "/db_rev_split";
+    if (notExists(seqDb)) {
+        runStage("createdb", {fasta, seqDb}, p.createdb);
+    }
+    // multi-threaded join of the mapping file against the lookup, createtaxdb skips its awk join if the _mapping exists
+    if (notExists(seqDb + "_mapping")) {
+        runStage("createtaxmapping", {seqDb, mappingFile}, p.createtaxmapping);
+    }
+    // the binary taxonomy (_taxonomy) and the dense mapping are memory mapped by all later stages
+    if (notExists(seqDb + "_mapping") || FileUtil::fileExists((seqDb + "_taxonomy").c_str()) == false) {
+        // createtaxdb hands over to its own shell script, it needs a separate process
+        std::string createtaxdb = std::string("\"") + getenv("MMSEQS") + "\" createtaxdb \"" + seqDb + "\" \""
+                                  + tmpDir + "/createtaxdb\" --tax-mapping-file \"" + mappingFile + "\" --tax-db-mode 1 "
+                                  + p.createtaxdbNcbiTaxDump + " " + p.onlyVerbosity;
+        if (std::system(createtaxdb.c_str()) != EXIT_SUCCESS) {
+            Debug(Debug::ERROR) << "createtaxdb step died\n";
+            EXIT(EXIT_FAILURE);
+        }
+    }
+    // a rerun can rebuild the _mapping, the dense mapping is rebuilt with it
+    if (notExists(seqDb + "_mapping_dense") || isNewer(seqDb + "_mapping", seqDb + "_mapping_dense")) {
+        runStage("createdensetaxmapping", {seqDb}, p.onlyVerbosity);
+    }
+    // the N-run index belongs to the sequencedb it was built from, packing rewrites sequencedb but not its headers
+    if (notExists(seqDb + "_nruns") || isNewer(seqDb + "_h.dbtype", seqDb + "_nruns")) {
+        runStage("createnrunindex", {seqDb}, p.threads);
+    }
+    if (notExists(splitDb)) {
+        runStage("splitsequence", {seqDb, splitDb}, p.splitsequence);
+    }
+    // db_rev_split is packed first since it can link to the data of sequencedb
+    if (p.packSequences && notExists(seqDb + "_packed.done")) {
+        runStage("packnucleotidedb", {splitDb, splitDb + "_packed"}, p.threads);
+        DBReader<unsigned int>::moveDb(splitDb + "_packed", splitDb);
+        runStage("packnucleotidedb", {seqDb, seqDb + "_packed"}, p.threads);
+        DBReader<unsigned int>::moveDb(seqDb + "_packed", seqDb);
+        FileUtil::writeFile(seqDb + "_packed.done", (const unsigned char *) "", 0);
+    }
+    DBReader<unsigned int> seqDbr(seqDb.c_str(), (seqDb + ".index").c_str(), 1, DBReader<unsigned int>::USE_INDEX | DBReader<unsigned int>::USE_DATA);
+    seqDbr.open(DBReader<unsigned int>::NOSORT);
+    MemoryDatabase::share(seqDbr);
+    DBReader<unsigned int> headerDbr((seqDb + "_h").c_str(), (seqDb + "_h.index").c_str(), 1, DBReader<unsigned int>::USE_INDEX | DBReader<unsigned int>::USE_DATA);
+    headerDbr.open(DBReader<unsigned int>::NOSORT);
+    MemoryDatabase::share(headerDbr);
+
+    const std::string updateMapping = tmpDir + "/update_mapping";
+    if (p.updateDir.empty() == false && notExists(updateMapping)) {
+        runStage("createupdatemapping", {p.updateDir + "/sequencedb", seqDb, updateMapping}, p.threads);
+    }
+    // the k-mer matches are only read by windowrescorediagonal
+    const std::string prefCross = tmpDir + "/pref_cross";
+    const bool needsPrefCross = p.updateDir.empty() ? notExists(tmpDir + "/aln_offset.dbtype")
+                                                    : notExists(tmpDir + "/aln_offset_update.dbtype");
+    if (needsPrefCross && notExists(prefCross + ".dbtype")) {
+        MemoryDatabase::request(prefCross);
+        runStage("crosstaxonkmermatcher", {seqDb, splitDb, prefCross}, p.kmermatcher);
+    }
+    if (p.updateDir.empty() == false) {
+        if (notExists(tmpDir + "/aln_offset_update.dbtype")) {
+            runStage("windowrescorediagonal", {seqDb, splitDb, prefCross, tmpDir + "/aln_offset_update"}, p.rescorediagonal1);
+        }
+        if (notExists(tmpDir + "/aln_offset.dbtype")) {
+            runStage("mergeupdatealignments", {p.updateDir + "/aln_offset", tmpDir + "/aln_offset_update", updateMapping, tmpDir + "/aln_offset"}, p.threadsCompression);
+        }
+    }
+    if (notExists(tmpDir + "/aln_offset.dbtype")) {
+        runStage("windowrescorediagonal", {seqDb, splitDb, prefCross, tmpDir + "/aln_offset"}, p.rescorediagonal1);
+    }
+    MemoryDatabase::release(prefCross);
+    if (notExists(tmpDir + "/contam_aln.dbtype")) {
+        runStage("extractalignments", {seqDb, tmpDir + "/aln_offset", tmpDir + "/contam_aln"}, p.extractalignments);
+    }
+    // the regions are read by extractframes and offsetalignment
+    const std::string contamRegion = tmpDir + "/contam_region";
+    const bool needsContamRegion = notExists(tmpDir + "/contam_region_rev.dbtype")
+                                   || notExists(tmpDir + "/contam_region_aln_swap_offset.dbtype");
+    if (needsContamRegion && notExists(contamRegion + ".dbtype")) {
+        MemoryDatabase::request(contamRegion);
+        runStage("extractalignedregion", {seqDb, seqDb, tmpDir + "/contam_aln", contamRegion}, p.threads);
+    }
+    if (needsContamRegion) {
+        renumberIndex(contamRegion);
+    }
+    if (notExists(tmpDir + "/contam_region_rev.dbtype")) {
+        runStage("extractframes", {contamRegion, tmpDir + "/contam_region_rev"}, p.extractframes);
+    }
+    if (p.indexCache.empty() == false) {
+        if (notExists(splitDb + ".idx.dbtype")) {
+            runStage("cachedindexdb", {splitDb, p.indexCache, splitDb + ".idx"}, p.indexdb);
+        }
+        if (notExists(tmpDir + "/contam_region_pref.dbtype")) {
+            runStage("prefilter", {tmpDir + "/contam_region_rev", splitDb + ".idx", tmpDir + "/contam_region_pref"}, p.prefilter);
+        }
+        // the alignments are already in the orientation of swapresults
+        if (notExists(tmpDir + "/contam_region_aln_swap.dbtype")) {
+            runStage("rescorediagonal", {tmpDir + "/contam_region_rev", splitDb, tmpDir + "/contam_region_pref", tmpDir + "/contam_region_aln_swap"}, p.rescorediagonal2);
+        }
+    } else {
+        if (notExists(tmpDir + "/contam_region_pref.dbtype")) {
+            runStage("prefilter", {splitDb, tmpDir + "/contam_region_rev", tmpDir + "/contam_region_pref"}, p.prefilter);
+        }
+        // rescorediagonal writes the alignments keyed by the regions, no swapresults pass
+        if (notExists(tmpDir + "/contam_region_aln_swap.dbtype")) {
+            runStage("rescorediagonal", {splitDb, tmpDir + "/contam_region_rev", tmpDir + "/contam_region_pref", tmpDir + "/contam_region_aln_swap"}, p.rescorediagonal2Swap);
+        }
+    }
+    if (notExists(tmpDir + "/contam_region_aln_swap_offset.dbtype")) {
+        runStage("offsetalignment", {contamRegion, tmpDir + "/contam_region_rev", seqDb, splitDb,
+                                     tmpDir + "/contam_region_aln_swap", tmpDir + "/contam_region_aln_swap_offset"}, p.threads);
+    }
+    MemoryDatabase::release(contamRegion);
+    if (notExists(tmpDir + "/contam_region_aln_swap_offset_all.dbtype")) {
+        runStage("createallreport", {seqDb, tmpDir + "/contam_region_aln_swap_offset", tmpDir + "/contam_region_aln_swap_offset_all"}, p.createstats);
+    }
+    if (notExists(result + "_all")) {
+        runStage("convertallreport", {seqDb, tmpDir + "/contam_region_aln_swap_offset_all", result + "_all"}, p.createstats);
+    }
+    if (notExists(tmpDir + "/contam_region_aln_swap_offset_predconterm.dbtype")) {
+        runStage("predictcontamination", {seqDb, tmpDir + "/contam_region_aln_swap_offset_all", tmpDir + "/contam_region_aln_swap_offset_predconterm"}, p.createstats);
+    }
+    if (notExists(result + "_conterm_prediction")) {
+        runStage("prefixid", {tmpDir + "/contam_region_aln_swap_offset_predconterm", result + "_conterm_prediction"}, p.threads + " --tsv");
+    }
+    const char *telemetryFile = getenv(Telemetry::ENV_NAME);
+    if (telemetryFile != NULL && FileUtil::fileExists(telemetryFile)) {
+        runStage("telemetryreport", {telemetryFile, result + "_run_report.json"}, p.onlyVerbosity);
+    }
+    MemoryDatabase::release(seqDb + "_h");
+    headerDbr.close();
+    MemoryDatabase::release(seqDb);
+    seqDbr.close();
+
+    if (removeTmpFiles) {
+        Debug(Debug::INFO) << "Remove temporary files\n";
+        const char *tmpDbs[] = {"contam_region_aln_swap_offset_predconterm", "contam_region_aln_swap_offset_all",
+                                "contam_region_aln_swap_offset", "contam_region_aln_swap", "contam_region_pref",
+                                "contam_region_rev", "contam_region", "db_rev_split", "contam_aln",
+                                "aln_offset", "sequencedb", "sequencedb_h", "pref_cross"};
+        for (size_t i = 0; i < sizeof(tmpDbs) / sizeof(tmpDbs[0]); ++i) {
+            DBReader<unsigned int>::removeDb(tmpDir + "/" + tmpDbs[i]);
+        }
+        if (p.updateDir.empty() == false) {
+            DBReader<unsigned int>::removeDb(tmpDir + "/aln_offset_update");
+            FileUtil::remove(updateMapping.c_str());
+        }
+        if (p.indexCache.empty() == false) {
+            DBReader<unsigned int>::removeDb(splitDb + ".idx");
+        }
+        if (p.packSequences) {
+            FileUtil::remove((seqDb + "_packed.done").c_str());
+        }
+        FileUtil::remove((seqDb + "_mapping").c_str());
+        FileUtil::remove((seqDb + "_mapping_dense").c_str());
+        FileUtil::remove((seqDb + "_nruns").c_str());
+    }
+    return EXIT_SUCCESS;
+}
+
 int conterminatordna(int argc, const char **argv, const Command &command) {
     LocalParameters &par = LocalParameters::getLocalInstance();
     setConterminatorWorkflowDefaults(&par);
@@ -75,6 +372,13 @@ int conterminatordna(int argc, const char **argv, const Command &command) {
 
     par.parseParameters(argc, argv, command, true, 0, MMseqsParameter::COMMAND_COMMON);
 
+    // stdin can only be read once, the taxa of a FASTA stream have to come from its headers
+    if (par.db1 == "stdin" && par.db2 == "stdin" && par.taxFromHeader == false) {
+        Debug(Debug::ERROR) << "The FASTA file and the mapping file can not both be read from stdin. "
+                               "Use --tax-from-header 1 to take the taxa from the FASTA headers\n";
+        EXIT(EXIT_FAILURE);
+    }
+
     CommandCaller cmd;
     std::string tmpDir = par.db4;
     std::string hash = SSTR(par.hashParameter(command.databases, par.filenames, par.conterminatordna));
@@ -86,6 +390,32 @@ int conterminatordna(int argc, const char **argv, const Command &command) {
     par.filenames.pop_back();
     par.filenames.push_back(tmpDir);
 
+    // every stage appends its resource usage, telemetryreport turns it into <result>_run_report.json
+    // the records of a previous run are removed, so the report only covers the stages of this run
+    if (getenv(Telemetry::ENV_NAME) == NULL) {
+        const std::string telemetryFile = tmpDir + "/telemetry.tsv";
+        if (FileUtil::fileExists(telemetryFile.c_str())) {
+            FileUtil::remove(telemetryFile.c_str());
+        }
+        cmd.addVariable(Telemetry::ENV_NAME, telemetryFile.c_str());
+    }
+
+    // an update reuses the sequenceDB and the alignments of a previous run and only searches the new sequences
+    DnaStageParameters stages;
+    if (par.updateDir.empty() == false) {
+        stages.updateDir = par.updateDir;
+        if (FileUtil::directoryExists((stages.updateDir + "/latest").c_str())) {
+            stages.updateDir = stages.updateDir + "/latest";
+        }
+        if (notExists(stages.updateDir + "/sequencedb.dbtype") || notExists(stages.updateDir + "/aln_offset.dbtype")) {
+            Debug(Debug::ERROR) << "--update " << par.updateDir << " does not contain the sequencedb and aln_offset of a previous run. "
+                                << "Run the previous search with --remove-tmp-files 0.\n";
+            EXIT(EXIT_FAILURE);
+        }
+        par.updateMapping = tmpDir + "/update_mapping";
+        cmd.addVariable("UPDATE_TMP", stages.updateDir.c_str());
+    }
+
     if( par.PARAM_NCBI_TAX_DUMP.wasSet == false){
         cmd.addVariable("DOWNLOAD_NCBITAXDUMP", "1");
     }else{
@@ -93,33 +423,70 @@ int conterminatordna(int argc, const char **argv, const Command &command) {
         cmd.addVariable("NCBITAXINFO", par.ncbiTaxDump.c_str());
     }
 
-    cmd.addVariable("CREATEDB_PAR", par.createParameterString(par.createdb).c_str());
-    cmd.addVariable("TAXMAPPINGFILE", par.db2.c_str());
-    cmd.addVariable("ONLYVERBOSITY",  par.createParameterString(par.onlyverbosity).c_str());
-    cmd.addVariable("REMOVE_TMP", par.removeTmpFiles ? "TRUE" : NULL);
-    cmd.addVariable("RUNNER", par.runner.c_str());
-    cmd.addVariable("EXTRACTALIGNMENTS_PAR", par.createParameterString(par.extractalignments).c_str());
-    cmd.addVariable("CREATESTATS_PAR", par.createParameterString(par.createstats).c_str());
+    // all parameter strings are created before the first stage runs, the in-process stages modify par
+    stages.createdb = par.createParameterString(par.createdb);
+    stages.createtaxmapping = par.createParameterString(par.createtaxmapping);
+    stages.onlyVerbosity = par.createParameterString(par.onlyverbosity);
+    if (par.PARAM_NCBI_TAX_DUMP.wasSet) {
+        stages.createtaxdbNcbiTaxDump = "--ncbi-tax-dump \"" + par.ncbiTaxDump + "\"";
+    }
+    stages.extractalignments = par.createParameterString(par.extractalignments);
+    stages.createstats = par.createParameterString(par.createstats);
     int prevCompressed = par.compressed;
     par.compressed = 1;
-    cmd.addVariable("SPLITSEQ_PAR", par.createParameterString(par.splitsequence).c_str());
+    stages.splitsequence = par.createParameterString(par.splitsequence);
     par.compressed = prevCompressed;
-    cmd.addVariable("RESCORE_DIAGONAL1_PAR", par.createParameterString(par.rescorediagonal).c_str());
-    cmd.addVariable("THREADS_PAR", par.createParameterString(par.onlythreads).c_str());
-    cmd.addVariable("EXTRACT_FRAMES_PAR", par.createParameterString(par.extractframes).c_str());
-    cmd.addVariable("CROSSTAXONFILTERORF_PAR",  par.createParameterString(par.crosstaxonfilterorf).c_str());
+    stages.rescorediagonal1 = par.createParameterString(par.windowrescorediagonal);
+    stages.threads = par.createParameterString(par.onlythreads);
+    stages.threadsCompression = par.createParameterString(par.threadsandcompression);
+    stages.packSequences = par.packSequences;
+    stages.extractframes = par.createParameterString(par.extractframes);
     par.kmerSize = 24;
-    cmd.addVariable("KMERMATCHER_PAR", par.createParameterString(par.kmermatcher).c_str());
+    stages.kmermatcher = par.createParameterString(par.crosstaxonkmermatcher);
     par.kmerSize = 15;
     par.maxSeqLen = 1000000;
     par.maskMode = 1;
     par.maxRejected = 5;
-    cmd.addVariable("PREFILTER_PAR", par.createParameterString(par.prefilter).c_str());
+    stages.prefilter = par.createParameterString(par.prefilter);
+    stages.indexdb = par.createParameterString(par.indexdb);
+    stages.indexCache = par.indexCache;
     float tmpSeqIdThr = par.seqIdThr;
     par.seqIdThr = sqrt(par.seqIdThr);
-    cmd.addVariable("RESCORE_DIAGONAL2_PAR", par.createParameterString(par.rescorediagonal).c_str());
+    stages.rescorediagonal2 = par.createParameterString(par.rescorediagonal);
+    par.swapOutput = true;
+    stages.rescorediagonal2Swap = par.createParameterString(par.rescorediagonal);
+    par.swapOutput = false;
     par.seqIdThr = tmpSeqIdThr;
 
+    if (par.inProcess) {
+#ifdef HAVE_MPI
+        Debug(Debug::WARNING) << "--in-process is not supported with MPI. Running the workflow script instead.\n";
+#else
+        return runConterminatordnaInProcess(par.db1, par.db2, par.db3, tmpDir, stages, par.removeTmpFiles);
+#endif
+    }
+
+    cmd.addVariable("CREATEDB_PAR", stages.createdb.c_str());
+    cmd.addVariable("TAXMAPPINGFILE", par.db2.c_str());
+    cmd.addVariable("CREATETAXMAPPING_PAR", stages.createtaxmapping.c_str());
+    cmd.addVariable("ONLYVERBOSITY", stages.onlyVerbosity.c_str());
+    cmd.addVariable("REMOVE_TMP", par.removeTmpFiles ? "TRUE" : NULL);
+    cmd.addVariable("RUNNER", par.runner.c_str());
+    cmd.addVariable("EXTRACTALIGNMENTS_PAR", stages.extractalignments.c_str());
+    cmd.addVariable("CREATESTATS_PAR", stages.createstats.c_str());
+    cmd.addVariable("SPLITSEQ_PAR", stages.splitsequence.c_str());
+    cmd.addVariable("RESCORE_DIAGONAL1_PAR", stages.rescorediagonal1.c_str());
+    cmd.addVariable("THREADS_PAR", stages.threads.c_str());
+    cmd.addVariable("THREADS_COMP_PAR", stages.threadsCompression.c_str());
+    cmd.addVariable("EXTRACT_FRAMES_PAR", stages.extractframes.c_str());
+    cmd.addVariable("KMERMATCHER_PAR", stages.kmermatcher.c_str());
+    cmd.addVariable("PREFILTER_PAR", stages.prefilter.c_str());
+    cmd.addVariable("RESCORE_DIAGONAL2_PAR", stages.rescorediagonal2.c_str());
+    cmd.addVariable("RESCORE_DIAGONAL2_SWAP_PAR", stages.rescorediagonal2Swap.c_str());
+    cmd.addVariable("PACK_SEQUENCES", par.packSequences ? "TRUE" : NULL);
+    cmd.addVariable("INDEX_CACHE", par.indexCache.empty() ? NULL : par.indexCache.c_str());
+    cmd.addVariable("INDEXDB_PAR", stages.indexdb.c_str());
+
     FileUtil::writeFile(tmpDir + "/conterminatordna.sh", conterminatordna_sh, conterminatordna_sh_len);
     std::string program(tmpDir + "/conterminatordna.sh");
     cmd.execProgram(program.c_str(), par.filenames);
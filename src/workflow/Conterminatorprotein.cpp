@@ -4,6 +4,7 @@
 #include "Debug.h"
 #include "FileUtil.h"
 #include "LocalParameters.h"
+#include "Telemetry.h"
 #include "conterminatorprotein.sh.h"
 
 void setConterminatorProteinDefaults(LocalParameters *p) {
@@ -53,6 +54,16 @@ int conterminatorprotein(int argc, const char **argv, const Command &command) {
     par.filenames.pop_back();
     par.filenames.push_back(tmpDir);
 
+    // every stage appends its resource usage, telemetryreport turns it into <result>_run_report.json
+    // the records of a previous run are removed, so the report only covers the stages of this run
+    if (getenv(Telemetry::ENV_NAME) == NULL) {
+        const std::string telemetryFile = tmpDir + "/telemetry.tsv";
+        if (FileUtil::fileExists(telemetryFile.c_str())) {
+            FileUtil::remove(telemetryFile.c_str());
+        }
+        cmd.addVariable(Telemetry::ENV_NAME, telemetryFile.c_str());
+    }
+
     if( par.PARAM_NCBI_TAX_DUMP.wasSet == false){
         cmd.addVariable("DOWNLOAD_NCBITAXDUMP", "1");
     }else{
@@ -62,12 +73,14 @@ int conterminatorprotein(int argc, const char **argv, const Command &command) {
 
     cmd.addVariable("CREATEDB_PAR", par.createParameterString(par.createdb).c_str());
     cmd.addVariable("TAXMAPPINGFILE", par.db2.c_str());
+    cmd.addVariable("ONLYVERBOSITY",  par.createParameterString(par.onlyverbosity).c_str());
     cmd.addVariable("REMOVE_TMP", par.removeTmpFiles ? "TRUE" : NULL);
     cmd.addVariable("RUNNER", par.runner.c_str());
     cmd.addVariable("LINCLUST_PAR", par.createParameterString(par.linclustworkflow).c_str());
     cmd.addVariable("CROSSTAXA_PAR", par.createParameterString(par.extractalignments).c_str());
     cmd.addVariable("CREATESTATS_PAR", par.createParameterString(par.createstats).c_str());
     cmd.addVariable("ALN_PAR", par.createParameterString(par.align).c_str());
+    cmd.addVariable("THREADS_PAR", par.createParameterString(par.onlythreads).c_str());
 
     FileUtil::writeFile(tmpDir + "/conterminatorprotein.sh", conterminatorprotein_sh, conterminatorprotein_sh_len);
     std::string program(tmpDir + "/conterminatorprotein.sh");